@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file accumulator_ingestion.cpp
+    Throughput (samples/second) of adding measurements to accumulators,
+    through a named `accumulator_set`, a `static_accumulator_set` and to the raw accumulator types.
+
+    Vector observables are benchmarked for sizes 1..4096, batches of scalar samples
+    (`accumulator_wrapper::add_batch()`) for batch sizes 1..4096; the reported
+    `items_per_second` is the number of samples (not elements) per second.
+*/
+
+#include <alps/accumulators.hpp>
+#include <alps/accumulators/static_accumulator_set.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+namespace aa=alps::accumulators;
+
+namespace {
+    /// Number of pre-generated samples (power of 2) cycled through by the benchmarks
+    const std::size_t POOL_SIZE=64;
+
+    /// Generate a pool of random samples, so that the RNG is not timed
+    inline std::vector<double> make_pool(double) {
+        std::mt19937 rng(43);
+        std::uniform_real_distribution<double> dist;
+        std::vector<double> pool(POOL_SIZE);
+        for (double& x: pool) x=dist(rng);
+        return pool;
+    }
+
+    /// Generate a pool of random vector samples of the given size
+    inline std::vector< std::vector<double> > make_pool(const std::vector<double>&, std::size_t size) {
+        std::mt19937 rng(43);
+        std::uniform_real_distribution<double> dist;
+        std::vector< std::vector<double> > pool(POOL_SIZE, std::vector<double>(size));
+        for (std::vector<double>& v: pool)
+            for (double& x: v) x=dist(rng);
+        return pool;
+    }
+
+    /// Report samples/second and bytes/second
+    inline void set_counters(benchmark::State& state, std::size_t value_size, std::size_t batch_size=1) {
+        state.SetItemsProcessed(state.iterations()*batch_size);
+        state.SetBytesProcessed(state.iterations()*batch_size*value_size*sizeof(double));
+    }
+}
+
+/// Scalar samples added via `accumulator_set::operator[]` (name lookup + variant dispatch)
+template <template<typename> class A>
+void set_scalar(benchmark::State& state) {
+    aa::accumulator_set measurements;
+    measurements << A<double>("obs");
+    const std::vector<double> pool=make_pool(double());
+    std::size_t i=0;
+    for (auto _: state) {
+        measurements["obs"] << pool[i++ & (POOL_SIZE-1)];
+    }
+    set_counters(state, 1);
+}
+
+/// Scalar samples added to a `static_accumulator_set` via a compile-time handle
+template <template<typename> class A>
+void static_scalar(benchmark::State& state) {
+    aa::static_accumulator_set< A<double> > measurements((A<double>("obs")));
+    const std::vector<double> pool=make_pool(double());
+    std::size_t i=0;
+    for (auto _: state) {
+        measurements.template measure<0>(pool[i++ & (POOL_SIZE-1)]);
+    }
+    benchmark::DoNotOptimize(measurements.template get<0>().count());
+    set_counters(state, 1);
+}
+
+/// Scalar samples added directly to the raw accumulator
+template <template<typename> class A>
+void raw_scalar(benchmark::State& state) {
+    typename A<double>::accumulator_type acc;
+    const std::vector<double> pool=make_pool(double());
+    std::size_t i=0;
+    for (auto _: state) {
+        acc(pool[i++ & (POOL_SIZE-1)]);
+    }
+    benchmark::DoNotOptimize(acc.count());
+    set_counters(state, 1);
+}
+
+/// Batches of `state.range(0)` scalar samples added via `accumulator_set::operator[]` and `add_batch()`
+template <template<typename> class A>
+void set_scalar_batch(benchmark::State& state) {
+    aa::accumulator_set measurements;
+    measurements << A<double>("obs");
+    const std::vector<double> pool=make_pool(double());
+    std::vector<double> batch(state.range(0));
+    for (std::size_t i=0; i<batch.size(); ++i) batch[i]=pool[i & (POOL_SIZE-1)];
+    for (auto _: state) {
+        measurements["obs"].add_batch(batch);
+    }
+    set_counters(state, 1, batch.size());
+}
+
+/// Vector samples of size `state.range(0)` added via `accumulator_set::operator[]`
+template <template<typename> class A>
+void set_vector(benchmark::State& state) {
+    typedef std::vector<double> value_type;
+    aa::accumulator_set measurements;
+    measurements << A<value_type>("obs");
+    const std::vector<value_type> pool=make_pool(value_type(), state.range(0));
+    std::size_t i=0;
+    for (auto _: state) {
+        measurements["obs"] << pool[i++ & (POOL_SIZE-1)];
+    }
+    set_counters(state, state.range(0));
+}
+
+/// Vector samples of size `state.range(0)` added directly to the raw accumulator
+template <template<typename> class A>
+void raw_vector(benchmark::State& state) {
+    typedef std::vector<double> value_type;
+    typename A<value_type>::accumulator_type acc;
+    const std::vector<value_type> pool=make_pool(value_type(), state.range(0));
+    std::size_t i=0;
+    for (auto _: state) {
+        acc(pool[i++ & (POOL_SIZE-1)]);
+    }
+    benchmark::DoNotOptimize(acc.count());
+    set_counters(state, state.range(0));
+}
+
+#define ALPS_ACCUMULATOR_BENCHMARK(A)                                           \
+    BENCHMARK_TEMPLATE(set_scalar, A);                                          \
+    BENCHMARK_TEMPLATE(static_scalar, A);                                       \
+    BENCHMARK_TEMPLATE(raw_scalar, A);                                          \
+    BENCHMARK_TEMPLATE(set_scalar_batch, A)->RangeMultiplier(8)->Range(1, 4096);\
+    BENCHMARK_TEMPLATE(set_vector, A)->RangeMultiplier(8)->Range(1, 4096);      \
+    BENCHMARK_TEMPLATE(raw_vector, A)->RangeMultiplier(8)->Range(1, 4096);
+
+ALPS_ACCUMULATOR_BENCHMARK(aa::MeanAccumulator)
+ALPS_ACCUMULATOR_BENCHMARK(aa::NoBinningAccumulator)
+ALPS_ACCUMULATOR_BENCHMARK(aa::LogBinningAccumulator)
+ALPS_ACCUMULATOR_BENCHMARK(aa::FullBinningAccumulator)
+
+#undef ALPS_ACCUMULATOR_BENCHMARK
@@ -27,6 +27,7 @@
 #include <typeinfo>
 #include <type_traits>
 #include <stdexcept>
+#include <utility>
 
 namespace alps {
     namespace accumulators {
@@ -92,11 +93,16 @@ namespace alps {
                 // copy constructor
                 result_wrapper(result_wrapper const & rhs);
 
+                // move constructor
+                result_wrapper(result_wrapper && rhs);
+
                 // constructor from hdf5
                 result_wrapper(hdf5::archive & ar);
 
                 // operator=
                 result_wrapper & operator=(std::shared_ptr<result_wrapper> const & rhs);
+                result_wrapper & operator=(result_wrapper const & rhs) = default;
+                result_wrapper & operator=(result_wrapper && rhs) = default;
 
             private:
                 // Visitors that need access to m_variant
@@ -244,12 +250,16 @@ namespace alps {
                 }
 
             public:
+                // The operators and functions are overloaded for temporaries, which are modified in place:
+                // in an expression like `1 - a / (3 * b * b)` only `a` and `b` are copied, once each.
 
                 // unary plus
-                result_wrapper operator+ () const;
+                result_wrapper operator+ () const &;
+                result_wrapper operator+ () &&;
 
                 // unary minus
-                result_wrapper operator- () const;
+                result_wrapper operator- () const &;
+                result_wrapper operator- () &&;
 
                 // operators
                 // Naming conventions:
@@ -268,9 +278,11 @@ namespace alps {
                     result_wrapper & AUGOPNAME (result_wrapper const & rhs);                                        \
                     /** @brief Do AUGOP with a constant value */                                                    \
                     result_wrapper & AUGOPNAME (long double arg);                                                   \
-                    result_wrapper OPNAME (result_wrapper const & arg) const;                                       \
+                    result_wrapper OPNAME (result_wrapper const & arg) const &;                                     \
+                    result_wrapper OPNAME (result_wrapper const & arg) &&;                                          \
                     /** @brief Visitor to do OP with RHS constant value */                                          \
-                    result_wrapper OPNAME (long double arg) const;
+                    result_wrapper OPNAME (long double arg) const &;                                                \
+                    result_wrapper OPNAME (long double arg) &&;
                 ALPS_ACCUMULATOR_OPERATOR_PROXY(operator+, operator+=, +=, add)
                 ALPS_ACCUMULATOR_OPERATOR_PROXY(operator-, operator-=, -=, sub)
                 ALPS_ACCUMULATOR_OPERATOR_PROXY(operator*, operator*=, *=, mul)
@@ -278,23 +290,28 @@ namespace alps {
                 #undef ALPS_ACCUMULATOR_OPERATOR_PROXY
 
                 // inverse
-                result_wrapper inverse() const;
-
-                result_wrapper sin () const;
-                result_wrapper cos () const;
-                result_wrapper tan () const;
-                result_wrapper sinh () const;
-                result_wrapper cosh () const;
-                result_wrapper tanh () const;
-                result_wrapper asin () const;
-                result_wrapper acos () const;
-                result_wrapper atan () const;
-                result_wrapper abs () const;
-                result_wrapper sqrt () const;
-                result_wrapper log () const;
-                result_wrapper sq () const;
-                result_wrapper cb () const;
-                result_wrapper cbrt () const;
+                result_wrapper inverse() const &;
+                result_wrapper inverse() &&;
+
+                #define ALPS_ACCUMULATOR_FUNCTION_PROXY(FUN)                            \
+                    result_wrapper FUN () const &;                                      \
+                    result_wrapper FUN () &&;
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(sin)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(cos)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(tan)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(sinh)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(cosh)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(tanh)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(asin)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(acos)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(atan)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(abs)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(sqrt)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(log)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(sq)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(cb)
+                ALPS_ACCUMULATOR_FUNCTION_PROXY(cbrt)
+                #undef ALPS_ACCUMULATOR_FUNCTION_PROXY
 
             private:
 
@@ -304,15 +321,27 @@ namespace alps {
         inline result_wrapper operator+(long double arg1, result_wrapper const & arg2) {
             return arg2 + arg1;
         }
+        inline result_wrapper operator+(long double arg1, result_wrapper && arg2) {
+            return std::move(arg2) + arg1;
+        }
         inline result_wrapper operator-(long double arg1, result_wrapper const & arg2) {
             return -arg2 + arg1;
         }
+        inline result_wrapper operator-(long double arg1, result_wrapper && arg2) {
+            return -std::move(arg2) + arg1;
+        }
         inline result_wrapper operator*(long double arg1, result_wrapper const & arg2) {
             return arg2 * arg1;
         }
+        inline result_wrapper operator*(long double arg1, result_wrapper && arg2) {
+            return std::move(arg2) * arg1;
+        }
         inline result_wrapper operator/(long double arg1, result_wrapper const & arg2) {
             return arg2.inverse() * arg1;
         }
+        inline result_wrapper operator/(long double arg1, result_wrapper && arg2) {
+            return std::move(arg2).inverse() * arg1;
+        }
 
         std::ostream & operator<<(std::ostream & os, const result_wrapper & arg);
 
@@ -374,20 +403,35 @@ namespace alps {
         }
 
         result_wrapper sin (result_wrapper const & arg);
+        result_wrapper sin (result_wrapper && arg);
         result_wrapper cos (result_wrapper const & arg);
+        result_wrapper cos (result_wrapper && arg);
         result_wrapper tan (result_wrapper const & arg);
+        result_wrapper tan (result_wrapper && arg);
         result_wrapper sinh (result_wrapper const & arg);
+        result_wrapper sinh (result_wrapper && arg);
         result_wrapper cosh (result_wrapper const & arg);
+        result_wrapper cosh (result_wrapper && arg);
         result_wrapper tanh (result_wrapper const & arg);
+        result_wrapper tanh (result_wrapper && arg);
         result_wrapper asin (result_wrapper const & arg);
+        result_wrapper asin (result_wrapper && arg);
         result_wrapper acos (result_wrapper const & arg);
+        result_wrapper acos (result_wrapper && arg);
         result_wrapper atan (result_wrapper const & arg);
+        result_wrapper atan (result_wrapper && arg);
         result_wrapper abs (result_wrapper const & arg);
+        result_wrapper abs (result_wrapper && arg);
         result_wrapper sqrt (result_wrapper const & arg);
+        result_wrapper sqrt (result_wrapper && arg);
         result_wrapper log (result_wrapper const & arg);
+        result_wrapper log (result_wrapper && arg);
         result_wrapper sq (result_wrapper const & arg);
+        result_wrapper sq (result_wrapper && arg);
         result_wrapper cb (result_wrapper const & arg);
+        result_wrapper cb (result_wrapper && arg);
         result_wrapper cbrt (result_wrapper const & arg);
+        result_wrapper cbrt (result_wrapper && arg);
 
         class accumulator_wrapper {
             private:
@@ -451,6 +495,46 @@ namespace alps {
                     return (*this);
                 }
 
+            // add_batch(T const *, std::size_t)
+            private:
+                template<typename T> struct call_batch_visitor: public boost::static_visitor<> {
+                    call_batch_visitor(T const * v, std::size_t n) : values(v), size(n) {}
+                    template<typename X> void apply(typename std::enable_if<
+                        std::is_same<T, typename value_type<X>::type>::value, X &
+                    >::type arg) const {
+                        arg.add_batch(values, size);
+                    }
+                    template<typename X> void apply(typename std::enable_if<
+                        !std::is_same<T, typename value_type<X>::type>::value
+                        && detail::is_valid_argument<T, typename value_type<X>::type>::value, X &
+                    >::type arg) const {
+                        const std::vector<typename value_type<X>::type> converted(values, values + size);
+                        arg.add_batch(converted.data(), size);
+                    }
+                    template<typename X> void apply(typename std::enable_if<!
+                        detail::is_valid_argument<T, typename value_type<X>::type>::value, X &
+                    >::type /*arg*/) const {
+                        throw std::logic_error(std::string("cannot convert: ") + typeid(T).name() + " to " + typeid(typename value_type<X>::type).name() + ALPS_STACKTRACE);
+                    }
+                    template<typename X> void operator()(X & arg) const {
+                        check_ptr(arg);
+                        apply<typename X::element_type>(*arg);
+                    }
+                    T const * values;
+                    std::size_t size;
+                };
+            public:
+                /// Add the `n` measurements `values[0..n-1]`, dispatching to the wrapped accumulator once for the whole batch
+                template<typename T> void add_batch(T const * values, std::size_t n) {
+                    for (std::size_t i = 0; i < n; ++i)
+                        check_nonempty_vector(values[i]);
+                    boost::apply_visitor(call_batch_visitor<T>(values, n), m_variant);
+                }
+                /// Add all measurements of `values`, dispatching to the wrapped accumulator once for the whole batch
+                template<typename T> void add_batch(std::vector<T> const & values) {
+                    add_batch(values.data(), values.size());
+                }
+
                 /// Merge another accumulator into this one. @param rhs_acc  accumulator to merge.
                 void merge(const accumulator_wrapper& rhs_acc);
 
@@ -546,6 +630,15 @@ namespace alps {
 
 #ifdef ALPS_HAVE_MPI
             void collective_merge(alps::mpi::communicator const & comm, int root);
+
+            /// Merge over the ranks of `comm` to `root` by a batched merge, in two levels (within and between the nodes) if `hierarchical`
+            /** Unlike the merge above, the accumulator must be measured on all ranks or on none (see `collective_merge_request`). */
+            void collective_merge(alps::mpi::communicator const & comm, int root, bool hierarchical);
+
+            /// Pack the data for a batched collective merge (see `collective_merge_request`)
+            void pack_merge(detail::merge_buffer & buffer) const;
+            /// Unpack the data merged by a batched collective merge (on the root)
+            void unpack_merge(detail::merge_buffer & buffer);
 #endif
 
             private:
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file collective_merge.hpp
+    @brief Batched, non-blocking collective merge of a set of accumulators
+*/
+
+#pragma once
+
+#include <alps/config.hpp>
+
+#ifdef ALPS_HAVE_MPI
+
+#include <alps/accumulators/accumulator.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace alps {
+    namespace accumulators {
+
+        /// Communicators of the nodes and of the node leaders, for a hierarchical merge
+        /** Splitting the communicator is a collective operation; a topology can be kept
+            and reused for any number of merges over the same communicator to the same root.
+            The communicators are freed by the destructor. */
+        class merge_topology {
+            public:
+                /// Split `comm` into nodes, such that `root` leads its node and the node leaders (collective)
+                merge_topology(alps::mpi::communicator const & comm, int root);
+
+                ~merge_topology();
+
+                alps::mpi::communicator const & comm() const { return m_comm; }
+                int root() const { return m_root; }
+
+                /// The ranks on the same node, or `MPI_COMM_NULL` if the nodes are unknown (before MPI-3)
+                MPI_Comm node() const { return m_node; }
+
+                /// The lowest rank of each node, or `MPI_COMM_NULL` on the other ranks
+                MPI_Comm leaders() const { return m_leaders; }
+
+            private:
+                merge_topology(merge_topology const &);
+                merge_topology & operator=(merge_topology const &);
+
+                alps::mpi::communicator m_comm;
+                int m_root;
+                MPI_Comm m_node, m_leaders;
+        };
+
+        /// Handle to a batched, non-blocking collective merge of accumulators (similar to a future)
+        /** Instead of a blocking reduction per feature per accumulator, the
+            contributions of all accumulators are packed into a few contiguous buffers,
+            and each buffer is reduced by one non-blocking collective operation; there are
+            at most three rounds of communication, independently of the number of accumulators.
+
+            The merge progresses in `test()` and `wait()`; the accumulators must not be
+            used by the caller until it is complete. When the merge is complete,
+            the accumulators on the root rank hold the merged data, the accumulators on the
+            other ranks are reset (as with `accumulator_wrapper::collective_merge()`).
+
+            An accumulator that has no measurements on any rank is left alone; an accumulator
+            that has measurements on some ranks only is an error.
+
+            A hierarchical merge reduces the data in two levels: first within each node (to
+            the lowest rank of the node, or the root), then between these node leaders to the
+            root. Thus the root receives data from one rank per node only, instead of from
+            every rank. The communicators of the nodes are split for each merge, unless the
+            merge is given a `merge_topology`.
+
+            @note Non-blocking collectives and the detection of nodes require MPI-3; with
+                  an older MPI, the communication is blocking and the merge has one level.
+
+            @note The merge is a collective operation: all ranks must start it with the same
+                  accumulators, in the same order, and complete it.
+        */
+        class collective_merge_request {
+            public:
+                typedef std::vector<std::pair<std::string, std::shared_ptr<accumulator_wrapper> > > accumulators_type;
+
+                /// Start merging `accs` over the ranks of `comm` to `root`, in two levels if `hierarchical`
+                collective_merge_request(accumulators_type const & accs, alps::mpi::communicator const & comm, int root,
+                                         bool hierarchical=false);
+
+                /// Start merging `accs` in two levels, over the nodes of `topology` to its root
+                collective_merge_request(accumulators_type const & accs, std::shared_ptr<merge_topology const> const & topology);
+
+                collective_merge_request(collective_merge_request &&);
+                collective_merge_request & operator=(collective_merge_request &&);
+
+                /// Waits for the outstanding communication (but does not complete the merge)
+                ~collective_merge_request();
+
+                /// Progress the merge; @returns true if the merge is complete
+                bool test();
+
+                /// Progress the merge until it is complete
+                void wait();
+
+            private:
+                struct state;
+                std::unique_ptr<state> m_state;
+        };
+
+        /// Start merging all accumulators of `measurements` over the ranks of `comm` to `root`
+        collective_merge_request collective_merge_async(accumulator_set & measurements, alps::mpi::communicator const & comm, int root,
+                                                        bool hierarchical=false);
+
+        /// Start merging the accumulators `names` of `measurements` over the ranks of `comm` to `root`
+        collective_merge_request collective_merge_async(accumulator_set & measurements, std::vector<std::string> const & names,
+                                                        alps::mpi::communicator const & comm, int root, bool hierarchical=false);
+
+        /// Merge all accumulators of `measurements` over the ranks of `comm` to `root`, in a few collective operations
+        void collective_merge(accumulator_set & measurements, alps::mpi::communicator const & comm, int root,
+                              bool hierarchical=false);
+    }
+}
+
+#endif
@@ -22,6 +22,7 @@
 #ifdef ALPS_HAVE_MPI
     #include <alps/hdf5/archive.hpp>
     #include <alps/accumulators/mpi.hpp>
+    #include <alps/accumulators/merge_buffer.hpp>
 #endif
 
 namespace alps {
@@ -98,6 +99,14 @@ namespace alps {
                 ) const {
                     throw std::logic_error("A result cannot be merged " + ALPS_STACKTRACE);
                 }
+
+                void pack_merge(detail::merge_buffer & /*buffer*/) const {
+                    throw std::logic_error("A result cannot be merged " + ALPS_STACKTRACE);
+                }
+
+                void unpack_merge(detail::merge_buffer & /*buffer*/) {
+                    throw std::logic_error("A result cannot be merged " + ALPS_STACKTRACE);
+                }
 #endif
 
                 template<typename U> void operator+=(U const &) {}
@@ -167,6 +176,12 @@ namespace alps {
                     void log() { throw std::runtime_error("The Function log is not implemented for accumulators, only for results" + ALPS_STACKTRACE); }
 
 #ifdef ALPS_HAVE_MPI
+                    /// Pack the data to be merged by a batched collective merge (see `detail::merge_buffer`)
+                    void pack_merge(detail::merge_buffer & /*buffer*/) const {}
+
+                    /// Unpack the data merged by a batched collective merge (on the root)
+                    void unpack_merge(detail::merge_buffer & /*buffer*/) {}
+
                 protected:
                     template <typename U, typename Op> void static reduce_if(
                           alps::mpi::communicator const & comm
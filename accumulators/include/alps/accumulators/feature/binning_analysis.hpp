@@ -19,6 +19,7 @@
 
 #include <alps/numeric/inf.hpp>
 #include <alps/numeric/check_size.hpp>
+#include <alps/numeric/inplace_functions.hpp>
 #include <alps/numeric/vector_functions.hpp>
 #include <alps/numeric/boost_array_functions.hpp>
 #include <alps/numeric/set_negative_0.hpp>
@@ -110,6 +111,9 @@ namespace alps {
                     using B::operator();
                     void operator()(T const & val);
 
+                    /// Add the `n` measurements `values[0..n-1]` at once
+                    void add_batch(T const * values, std::size_t n);
+
                     template<typename S> void print(S & os, bool terse=false) const {
                         if (terse) {
                             os << alps::short_print(this->mean())
@@ -165,12 +169,19 @@ namespace alps {
                           alps::mpi::communicator const & comm
                         , int root
                     ) const;
+
+                    void pack_merge(detail::merge_buffer & buffer) const;
+                    void unpack_merge(detail::merge_buffer & buffer);
 #endif
 
                 private:
 
+                    /// Update the binning levels with the measurement `val`, which is measurement number `count`
+                    void add_to_levels(T const & val, typename count_type<B>::type count);
+
                     std::vector<T> m_ac_sum;
                     std::vector<T> m_ac_sum2;
+                    /// Partial bin of each level, holding the measurements not yet carried over from lower levels
                     std::vector<T> m_ac_partial;
                     std::vector<typename count_type<B>::type> m_ac_count;
             };
@@ -83,6 +83,8 @@ namespace alps {
                         throw std::runtime_error("No values can be added to a result" + ALPS_STACKTRACE);
                     }
 
+                    void add_batch(T const *, std::size_t);
+
                     template<typename S> void print(S & os, bool /*terse*/=false) const {
                         os << " #" << alps::short_print(count());
                     }
@@ -179,6 +181,11 @@ namespace alps {
                         throw std::runtime_error("Observable has no binary call operator" + ALPS_STACKTRACE);
                     }
 
+                    /// Add the `n` measurements `values[0..n-1]` at once
+                    void add_batch(T const *, std::size_t n) {
+                        m_count += n;
+                    }
+
                     template<typename S> void print(S & os, bool /*terse*/=false) const {
                         os << " #" << alps::short_print(count());
                     }
@@ -209,6 +216,9 @@ namespace alps {
                           alps::mpi::communicator const & comm
                         , int root
                     ) const;
+
+                    void pack_merge(detail::merge_buffer & buffer) const;
+                    void unpack_merge(detail::merge_buffer & buffer);
 #endif
 
                 private:
@@ -17,6 +17,7 @@
 #include <alps/numeric/inf.hpp>
 #include <alps/numeric/boost_array_functions.hpp>
 #include <alps/numeric/check_size.hpp>
+#include <alps/numeric/inplace_functions.hpp>
 #include <alps/numeric/vector_functions.hpp>
 #include <alps/hdf5/archive.hpp>
 #include <alps/utilities/stacktrace.hpp>
@@ -175,6 +176,9 @@ namespace alps {
                 using B::operator();
                 void operator()(T const & val);
 
+                /// Add the `n` measurements `values[0..n-1]` at once
+                void add_batch(T const * values, std::size_t n);
+
                 template<typename S> void print(S & os, bool terse=false) const {
                     if (terse) {
                         os << alps::short_print(this->mean())
@@ -203,15 +207,14 @@ namespace alps {
                 void reset();
 
                 /// Merge the bins of the given accumulator of type A into this accumulator @param rhs Accumulator to merge
-                    /** @warning: FIXME: Incomplete, therefore always throws. */
+                /** The bins of both accumulators are brought to the larger of the two bin sizes and
+                    concatenated, then rebinned to at most the maximal number of bins. Bins that
+                    cannot be combined into a complete bin are added to the partial bin. */
                 template <typename A>
                 void merge(const A& rhs)
                 {
-                        throw std::logic_error("Merging of FullBinningAccumulators is not yet implemented.\n"
-                                               "Please contact ALPSCore developers and provide the code\n"
-                                               "where you are using the merge() method.");
                     B::merge(rhs);
-                    // FIXME!!! Needs a test to proceed with the coding!
+                    merge_bins(rhs.m_mn_bins, rhs.m_mn_elements_in_bin, rhs.m_mn_partial, rhs.m_mn_elements_in_partial);
                 }
 
 #ifdef ALPS_HAVE_MPI
@@ -221,19 +224,46 @@ namespace alps {
                 void collective_merge(alps::mpi::communicator const & comm,
                                       int root) const;
 
+                void pack_merge(detail::merge_buffer & buffer) const;
+                void unpack_merge(detail::merge_buffer & buffer);
+
               private:
                 void partition_bins(alps::mpi::communicator const & comm,
                                     std::vector<typename mean_type<B>::type> & local_bins,
                                     std::vector<typename mean_type<B>::type> & merged_bins,
                                     int /*root*/) const;
+
+                /// Add the (rebinned) local bins, the first being global bin number `start`, averaged over each `perbin` global bins, to the merged bins
+                static void spread_bins(std::vector<typename mean_type<B>::type> const & local_bins,
+                                        std::size_t start,
+                                        std::size_t perbin,
+                                        std::vector<typename mean_type<B>::type> & merged_bins);
 #endif
 
               private:
 
+                /// Put the measurement `val` into the bins, rebinning if needed
+                void add_to_bins(T const & val);
+
+                /// Merge the given bins and partial bin (of another accumulator) into this accumulator's
+                void merge_bins(std::vector<typename mean_type<B>::type> const & bins,
+                                typename B::count_type elements_in_bin,
+                                T const & partial,
+                                typename B::count_type elements_in_partial);
+
+                /// Combine each `factor` consecutive bins of `elements_in_bin` elements into one; the bins left over go to the partial bin
+                static void combine_bins(std::vector<typename mean_type<B>::type> & bins,
+                                         typename B::count_type elements_in_bin,
+                                         typename B::count_type factor,
+                                         T & partial,
+                                         typename B::count_type & elements_in_partial);
+
                 std::size_t m_mn_max_number;
                 typename B::count_type m_mn_elements_in_bin, m_mn_elements_in_partial;
                 T m_mn_partial;
                 std::vector<typename mean_type<B>::type> m_mn_bins;
+                /// Bins dropped by rebinning, whose storage is reused for new bins
+                std::vector<typename mean_type<B>::type> m_mn_spare_bins;
             };
 
 
@@ -323,16 +353,15 @@ namespace alps {
                 template<typename U> void operator*=(U const & arg) { augmul(arg); }
                 template<typename U> void operator/=(U const & arg) { augdiv(arg); }
 
+                /// Apply `op` to all bins and jackknife bins
+                /** The mean and the error are recomputed only when requested (see `mean()` and `error()`),
+                    so that a chain of operations costs one pass over the bins per operation. */
                 template <typename OP> void transform(OP op) {
                     generate_jackknife();
                     m_mn_data_is_analyzed = false;
                     m_mn_cannot_rebin = true;
-                    typename std::vector<typename mean_type<B>::type>::iterator it;
-                    for (it = m_mn_bins.begin(); it != m_mn_bins.end(); ++it)
-                        *it = op(*it);
-                    for (it = m_mn_jackknife_bins.begin(); it != m_mn_jackknife_bins.end(); ++it)
-                        *it = op(*it);
-                    analyze();
+                    transform_bins(m_mn_bins, op);
+                    transform_bins(m_mn_jackknife_bins, op);
                 }
 
                 template <typename OP, typename U> void transform(OP op, U const & arg) {
@@ -342,12 +371,8 @@ namespace alps {
                         throw std::runtime_error("Unable to transform: unequal number of bins" + ALPS_STACKTRACE);
                     m_mn_data_is_analyzed = false;
                     m_mn_cannot_rebin = true;
-                    typename std::vector<typename mean_type<B>::type>::iterator it;
-                    typename std::vector<typename mean_type<U>::type>::const_iterator jt;
-                    for (it = m_mn_bins.begin(), jt = arg.get_bins().begin(); it != m_mn_bins.end(); ++it, ++jt)
-                        *it = op(*it, *jt);
-                    for (it = m_mn_jackknife_bins.begin(), jt = arg.get_jackknife_bins().begin(); it != m_mn_jackknife_bins.end(); ++it, ++jt)
-                        *it = op(*it, *jt);
+                    transform_bins(m_mn_bins, arg.get_bins(), op);
+                    transform_bins(m_mn_jackknife_bins, arg.get_jackknife_bins(), op);
                 }
 
                 void sin();
@@ -397,25 +422,30 @@ namespace alps {
               private:
                 void analyze() const;
 
+                // The operation is a template parameter (not a boost::function), so that it is inlined into the loop
+                template <typename V, typename OP> static void transform_bins(std::vector<V> & bins, OP & op) {
+                    for (typename std::vector<V>::iterator it = bins.begin(); it != bins.end(); ++it)
+                        *it = op(*it);
+                }
+
+                template <typename V, typename W, typename OP> static void transform_bins(std::vector<V> & bins, std::vector<W> const & args, OP & op) {
+                    typename std::vector<W>::const_iterator jt = args.begin();
+                    for (typename std::vector<V>::iterator it = bins.begin(); it != bins.end(); ++it, ++jt)
+                        *it = op(*it, *jt);
+                }
+
 #define NUMERIC_FUNCTION_OPERATOR(OP_NAME, OPEQ_NAME, OP, OP_TOKEN, OP_STD) \
                 template<typename U> void aug ## OP_TOKEN (U const & arg, typename std::enable_if<!std::is_scalar<U>::value, int>::type = 0) { \
                     typedef typename value_type<B>::type self_value_type; \
                     typedef typename value_type<U>::type arg_value_type; \
-                    transform(boost::function<self_value_type(self_value_type, arg_value_type)>( OP_STD <self_value_type, arg_value_type, self_value_type>()), arg); \
+                    transform(OP_STD <self_value_type, arg_value_type, self_value_type>(), arg); \
                     B:: OPEQ_NAME (arg);                                \
                 }                                                       \
                 template<typename U> void aug ## OP_TOKEN (U const & arg, typename std::enable_if<std::is_scalar<U>::value, int>::type = 0) { \
                     using alps::numeric:: OP_NAME ;                     \
                     typedef typename mean_type<B>::type mean_type;      \
-                    generate_jackknife();                               \
-                    m_mn_data_is_analyzed = false;                      \
-                    m_mn_cannot_rebin = true;                           \
-                    typename std::vector<mean_type>::iterator it;       \
-                    for (it = m_mn_bins.begin(); it != m_mn_bins.end(); ++it) \
-                        *it = *it OP static_cast<typename alps::numeric::scalar<mean_type>::type>(arg); \
-                    for (it = m_mn_jackknife_bins.begin(); it != m_mn_jackknife_bins.end(); ++it) \
-                        *it = *it OP static_cast<typename alps::numeric::scalar<mean_type>::type>(arg); \
-                    analyze();                                          \
+                    const typename alps::numeric::scalar<mean_type>::type value = static_cast<typename alps::numeric::scalar<mean_type>::type>(arg); \
+                    transform([value](mean_type const & x) { return x OP value; }); \
                     B:: OPEQ_NAME (arg);                                \
                 }                                                       \
 
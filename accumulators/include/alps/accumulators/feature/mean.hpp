@@ -17,6 +17,7 @@
 #include <alps/numeric/inf.hpp>
 #include <alps/numeric/boost_array_functions.hpp>
 #include <alps/numeric/check_size.hpp>
+#include <alps/numeric/inplace_functions.hpp>
 #include <alps/numeric/vector_functions.hpp>
 #include <alps/utilities/stacktrace.hpp>
 #include <alps/utilities/short_print.hpp>
@@ -86,6 +87,9 @@ namespace alps {
                     using B::operator();
                     void operator()(T const & val);
 
+                    /// Add the `n` measurements `values[0..n-1]` at once
+                    void add_batch(T const * values, std::size_t n);
+
                     template<typename S> void print(S & os, bool terse=false) const {
                         os << alps::short_print(mean());
                         B::print(os, terse);
@@ -122,6 +126,9 @@ namespace alps {
                           alps::mpi::communicator const & comm
                         , int root
                     ) const;
+
+                    void pack_merge(detail::merge_buffer & buffer) const;
+                    void unpack_merge(detail::merge_buffer & buffer);
 #endif
                 protected:
 
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file lazy_result_set.hpp
+    @brief Set of results in an HDF5 archive, which are loaded on first access
+*/
+
+#pragma once
+
+#include <alps/config.hpp>
+#include <alps/accumulators/accumulator.hpp>
+#include <alps/hdf5/archive.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace alps {
+    namespace accumulators {
+
+        /// Set of results saved in an HDF5 archive (as a `result_set`), which are loaded on first access
+        /** Only the names of the results are read on construction. A result is read from the
+            archive when it is accessed for the first time, and kept for later accesses; the other
+            results are never read. Thus, e.g., post-processing two observables of an output file does
+            not read the (possibly long) binning data of all the others.
+
+            With `bins=false`, the results are loaded as `NoBinningAccumulator` results, i.e.,
+            only the count, mean and error are read, but none of the binning data. Such results cannot
+            be used in nonlinear expressions with a proper error propagation, but they are enough to
+            report means and errors.
+
+            The set keeps the archive open; it is not thread-safe.
+
+            Usage:
+
+                alps::hdf5::archive ar("sim.out.h5", "r");
+                aa::lazy_result_set results(ar, "/simulation/results");
+                const aa::result_wrapper& mag2=results["Magnetization^2"];   // loads Magnetization^2 only
+        */
+        class lazy_result_set {
+            public:
+                /// Read the index of the results saved at `path` in `ar`
+                lazy_result_set(hdf5::archive & ar, std::string const & path, bool bins=true);
+
+                /// Returns `true` if there is a result `name`
+                bool has(std::string const & name) const;
+
+                /// Returns `true` if the result `name` has been loaded already
+                bool loaded(std::string const & name) const;
+
+                /// Names of all results, in the order of a `result_set`
+                std::vector<std::string> const & names() const { return m_names; }
+
+                std::size_t size() const { return m_names.size(); }
+
+                /// Returns the result `name`, which is loaded on first access; throws if there is none
+                result_wrapper const & operator[](std::string const & name) const;
+
+                /// Load all results into `results`, e.g., to be used as a `result_set`
+                void load(result_set & results) const;
+
+            private:
+                mutable hdf5::archive m_archive;
+                std::string m_path;
+                bool m_bins;
+                std::vector<std::string> m_names;
+                mutable std::map<std::string, std::shared_ptr<result_wrapper> > m_loaded;
+        };
+    }
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file merge_buffer.hpp
+    @brief Contiguous buffers for merging many accumulators with a few collective operations
+*/
+
+#pragma once
+
+#include <alps/config.hpp>
+
+#include <alps/utilities/stacktrace.hpp>
+
+#include <boost/cstdint.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace alps {
+    namespace accumulators {
+        namespace detail {
+
+            /// Buffers of a batched collective merge
+            /** A batched merge packs the contributions of all accumulators into
+                a few contiguous buffers, and reduces each buffer with a single
+                collective operation. It proceeds in phases; in every phase each
+                accumulator is packed again, in the same order, so that it finds its
+                entries in the reduced buffers of the previous phases at the same
+                positions:
+
+                - `max_phase`: values to be reduced with maximum (`put_max()`),
+                  e.g. the number of binning levels;
+                - `offset_phase`: values whose prefix sum over the ranks and total are
+                  needed (`put_offset()`), e.g. the number of bins to be concatenated;
+                - `sum_phase`: the data to be summed on the root (`put_sum()`).
+
+                After the last phase the root unpacks the accumulators, in the same order,
+                reading the sums with `get_sum()`.
+
+                The reading methods (`get_*()`) advance the cursors rewound by `rewind()`;
+                they are valid only in the phases after the one in which the values were put.
+            */
+            class merge_buffer {
+                public:
+                    typedef boost::uint64_t size_type;
+
+                    enum phase_type { max_phase, offset_phase, sum_phase, unpack_phase };
+
+                    /// Global prefix sum and total of a value put in `offset_phase`
+                    struct offset_type {
+                        size_type start;
+                        size_type total;
+                    };
+
+                    merge_buffer() : m_phase(max_phase) { rewind(); }
+
+                    phase_type phase() const { return m_phase; }
+
+                    /// Switch to the next phase and rewind the cursors; the reduced buffers of the previous phases are kept
+                    void next_phase() {
+                        m_phase = static_cast<phase_type>(m_phase + 1);
+                        rewind();
+                    }
+
+                    /// Rewind the reading cursors, and drop the local values of the current phase
+                    void rewind() {
+                        m_max_pos = m_offset_pos = 0;
+                        m_sums_u.pos = m_sums_f.pos = m_sums_d.pos = m_sums_ld.pos = 0;
+                        switch (m_phase) {
+                            case max_phase: m_max_local.clear(); break;
+                            case offset_phase: m_offset_local.clear(); break;
+                            case sum_phase:
+                                m_sums_u.local.clear(); m_sums_f.local.clear();
+                                m_sums_d.local.clear(); m_sums_ld.local.clear();
+                                break;
+                            default: break;
+                        }
+                    }
+
+                    //
+                    // max_phase
+                    //
+
+                    void put_max(size_type value) {
+                        m_max_local.push_back(value);
+                    }
+
+                    /// Maximum over the ranks, in the phases after `max_phase`
+                    size_type get_max() {
+                        return next(m_max_global, m_max_pos);
+                    }
+
+                    /// Put a value that must be the same on all ranks (checked by `get_same()`)
+                    void put_same(size_type value) {
+                        put_max(value);
+                        put_max(~value);
+                    }
+
+                    /// Minimum and maximum over the ranks of a value put with `put_same()`
+                    void get_range(size_type & min, size_type & max) {
+                        max = get_max();
+                        min = ~get_max();
+                    }
+
+                    /// Value put with `put_same()`; throws if it differs between the ranks
+                    size_type get_same(std::string const & what) {
+                        size_type min, max;
+                        get_range(min, max);
+                        if (min != max)
+                            throw std::runtime_error("Cannot merge accumulators: " + what + " differs between the processes" + ALPS_STACKTRACE);
+                        return max;
+                    }
+
+                    //
+                    // offset_phase
+                    //
+
+                    void put_offset(size_type value) {
+                        m_offset_local.push_back(value);
+                    }
+
+                    /// Sum over the lower ranks and over all ranks, in the phases after `offset_phase`
+                    offset_type get_offset() {
+                        offset_type offset;
+                        offset.total = next(m_offset_total, m_offset_pos);
+                        offset.start = m_offset_start[m_offset_pos - 1];
+                        return offset;
+                    }
+
+                    //
+                    // sum_phase
+                    //
+
+                    /// Put a value to be summed on the root (a scalar, or a possibly nested vector of scalars)
+                    template<typename T> void put_sum(T const & value) {
+                        put_sum_impl(value, typename std::is_arithmetic<T>::type());
+                    }
+
+                    /// Read a value summed on the root; `value` must have the shape of the value put
+                    template<typename T> void get_sum(T & value) {
+                        get_sum_impl(value, typename std::is_arithmetic<T>::type());
+                    }
+
+                    //
+                    // Access for the collective operations
+                    //
+
+                    std::vector<size_type> & max_local() { return m_max_local; }
+                    std::vector<size_type> & max_global() { return m_max_global; }
+
+                    std::vector<size_type> & offset_local() { return m_offset_local; }
+                    std::vector<size_type> & offset_start() { return m_offset_start; }
+                    std::vector<size_type> & offset_total() { return m_offset_total; }
+
+                    /// Local and reduced sums of scalar type S
+                    template<typename S> struct sums_type {
+                        std::vector<S> local;
+                        std::vector<S> global;
+                        std::size_t pos;
+                    };
+
+                    sums_type<boost::uint64_t> & sums(boost::uint64_t) { return m_sums_u; }
+                    sums_type<float> & sums(float) { return m_sums_f; }
+                    sums_type<double> & sums(double) { return m_sums_d; }
+                    sums_type<long double> & sums(long double) { return m_sums_ld; }
+
+                private:
+
+                    static size_type next(std::vector<size_type> const & values, std::size_t & pos) {
+                        if (pos >= values.size())
+                            throw std::logic_error("Reading past the end of a merge buffer" + ALPS_STACKTRACE);
+                        return values[pos++];
+                    }
+
+                    template<typename T> void put_sum_impl(T const & value, std::true_type) {
+                        sums(T()).local.push_back(value);
+                    }
+                    template<typename T> void put_sum_impl(std::vector<T> const & value, std::false_type) {
+                        for (typename std::vector<T>::const_iterator it = value.begin(); it != value.end(); ++it)
+                            put_sum(*it);
+                    }
+
+                    template<typename T> void get_sum_impl(T & value, std::true_type) {
+                        sums_type<T> & s = sums(T());
+                        if (s.pos >= s.global.size())
+                            throw std::logic_error("Reading past the end of a merge buffer" + ALPS_STACKTRACE);
+                        value = s.global[s.pos++];
+                    }
+                    template<typename T> void get_sum_impl(std::vector<T> & value, std::false_type) {
+                        for (typename std::vector<T>::iterator it = value.begin(); it != value.end(); ++it)
+                            get_sum(*it);
+                    }
+
+                    phase_type m_phase;
+
+                    std::vector<size_type> m_max_local, m_max_global;
+                    std::size_t m_max_pos;
+
+                    std::vector<size_type> m_offset_local, m_offset_start, m_offset_total;
+                    std::size_t m_offset_pos;
+
+                    sums_type<boost::uint64_t> m_sums_u;
+                    sums_type<float> m_sums_f;
+                    sums_type<double> m_sums_d;
+                    sums_type<long double> m_sums_ld;
+            };
+
+            /// Number of scalars in a value (a scalar, or a possibly nested vector of scalars)
+            template<typename T> typename std::enable_if<std::is_arithmetic<T>::value, std::size_t>::type
+            scalar_count(T const &) {
+                return 1;
+            }
+            template<typename T> std::size_t scalar_count(std::vector<T> const & value) {
+                std::size_t n = 0;
+                for (typename std::vector<T>::const_iterator it = value.begin(); it != value.end(); ++it)
+                    n += scalar_count(*it);
+                return n;
+            }
+
+            /// Make a (zero) value hold `n` scalars; for the types of means: scalars (`n` is ignored) and vectors of scalars
+            template<typename T> void set_scalar_count(T &, std::size_t) {}
+            template<typename T> void set_scalar_count(std::vector<T> & value, std::size_t n) {
+                value.resize(n);
+            }
+        }
+    }
+}
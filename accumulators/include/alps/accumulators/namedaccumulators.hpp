@@ -41,6 +41,13 @@ namespace alps {
                     return *this;
                 }
 
+                /// Adds the `n` values `values[0..n-1]` directly to this named accumulator
+                template <typename T>
+                void add_batch(const T* values, std::size_t n) const
+                {
+                    wrapper->add_batch(values, n);
+                }
+
                 /// Returns a shared pointer to the result associated with this named accumulator
                 std::shared_ptr<result_wrapper> result() const
                 {
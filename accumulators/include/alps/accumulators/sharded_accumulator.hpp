@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file sharded_accumulator.hpp
+    @brief An accumulator split into per-thread shards, reduced on demand
+*/
+
+#pragma once
+
+#include <alps/config.hpp>
+
+#include <alps/accumulators/accumulator.hpp>
+#include <alps/accumulators/namedaccumulators.hpp>
+
+#include <alps/hdf5/archive.hpp>
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace alps {
+    namespace accumulators {
+
+        namespace detail {
+            /// Assumed size of a cache line (bytes): shards never share one
+            const std::size_t cache_line_size = 64;
+        }
+
+        /// An accumulator split into shards, each to be fed by one thread
+        /** Each thread adds its measurements to its own shard, without any locking;
+            the shards are aligned to cache lines, so that threads writing to
+            neighbouring shards do not contend for the same cache line. The shards
+            are merged (including the bins of `FullBinningAccumulator`) when the
+            results are needed.
+
+            @tparam A named accumulator type, e.g. `FullBinningAccumulator<double>`
+
+            Example:
+            @code
+                sharded_accumulator< FullBinningAccumulator<double> > energy(FullBinningAccumulator<double>("Energy"), nthreads);
+                #pragma omp parallel
+                {
+                    auto& my_energy=energy.shard(omp_get_thread_num());
+                    // ...
+                    my_energy(e);
+                }
+                measurements["Energy"].merge(accumulator_wrapper(energy.merged()));
+                // or:
+                result_wrapper res(energy.result());
+            @endcode
+
+            @note Reading the merged accumulator while threads are writing to their shards is a data race.
+        */
+        template<typename A> class sharded_accumulator {
+            public:
+                typedef typename A::accumulator_type accumulator_type;
+                typedef typename accumulator_type::result_type result_type;
+
+                /// Make `nshards` empty shards with the name and the parameters of the named accumulator `proto`
+                sharded_accumulator(A const & proto, std::size_t nshards)
+                    : m_name(proto.name)
+                    , m_shards(nshards, shard_type(proto.wrapper->template extract<accumulator_type>()))
+                {
+                    if (nshards == 0)
+                        throw std::invalid_argument("At least one shard is needed" + ALPS_STACKTRACE);
+                    reset();
+                }
+
+                std::string const & name() const {
+                    return m_name;
+                }
+
+                /// Number of shards
+                std::size_t size() const {
+                    return m_shards.size();
+                }
+
+                /// The accumulator of shard `i`; it must be written to by one thread at a time
+                accumulator_type & shard(std::size_t i) {
+                    return m_shards[i].acc;
+                }
+                accumulator_type const & shard(std::size_t i) const {
+                    return m_shards[i].acc;
+                }
+
+                /// Total number of measurements in all shards
+                boost::uint64_t count() const {
+                    boost::uint64_t cnt = 0;
+                    for (std::size_t i = 0; i < m_shards.size(); ++i)
+                        cnt += m_shards[i].acc.count();
+                    return cnt;
+                }
+
+                /// All shards merged into one accumulator
+                accumulator_type merged() const {
+                    accumulator_type acc(m_shards[0].acc);
+                    for (std::size_t i = 1; i < m_shards.size(); ++i)
+                        acc.merge(m_shards[i].acc);
+                    return acc;
+                }
+
+                /// Result of all shards merged
+                result_type result() const {
+                    return result_type(merged());
+                }
+
+                void reset() {
+                    for (std::size_t i = 0; i < m_shards.size(); ++i)
+                        m_shards[i].acc.reset();
+                }
+
+                /// Save the merged shards, in the layout of the (unsharded) accumulator
+                void save(hdf5::archive & ar) const {
+                    ar[""] = merged();
+                }
+
+                /// Load into the first shard, resetting the others
+                void load(hdf5::archive & ar) {
+                    reset();
+                    ar[""] >> m_shards[0].acc;
+                }
+
+#ifdef ALPS_HAVE_MPI
+                /// Merge the shards, then collectively across the ranks of `comm`
+                /** @returns the accumulator merged over all shards and ranks (on `root`; the local merged shards elsewhere) */
+                accumulator_type collective_merge(alps::mpi::communicator const & comm, int root) const {
+                    accumulator_type acc = merged();
+                    acc.collective_merge(comm, root);
+                    return acc;
+                }
+#endif
+
+            private:
+                struct alignas(detail::cache_line_size) shard_type {
+                    explicit shard_type(accumulator_type const & a): acc(a) {}
+                    accumulator_type acc;
+                };
+
+                std::string m_name;
+                std::vector<shard_type, boost::alignment::aligned_allocator<shard_type, detail::cache_line_size> > m_shards;
+        };
+    }
+}
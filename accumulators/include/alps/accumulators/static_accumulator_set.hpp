@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file static_accumulator_set.hpp
+    @brief A set of accumulators with types and handles known at compile time
+*/
+
+#pragma once
+
+#include <alps/config.hpp>
+
+#include <alps/accumulators/accumulator.hpp>
+#include <alps/accumulators/namedaccumulators.hpp>
+
+#include <alps/hdf5/archive.hpp>
+
+#include <array>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+
+namespace alps {
+    namespace accumulators {
+
+        /// A set of named accumulators whose types are fixed at compile time
+        /** The accumulators are stored by value in a tuple and addressed by their
+            (compile-time) position, so that a measurement is a direct, inlinable call
+            to the raw accumulator, without the name lookup and the variant dispatch of
+            `accumulator_set`.
+
+            The set is saved in, and loaded from, the same HDF5 layout as `accumulator_set`,
+            and its results are put into an ordinary `result_set`.
+
+            @tparam A named accumulator types, e.g. `FullBinningAccumulator<double>`
+
+            Example:
+            @code
+                typedef static_accumulator_set< FullBinningAccumulator<double>,
+                                                MeanAccumulator< std::vector<double> > > measurements_type;
+                measurements_type measurements(FullBinningAccumulator<double>("Energy"),
+                                               MeanAccumulator< std::vector<double> >("Correlations"));
+                enum { ENERGY, CORRELATIONS }; // handles
+                // ...
+                measurements.measure<ENERGY>(energy);
+                measurements.get<CORRELATIONS>()(correlations);
+                // ...
+                result_set results;
+                measurements.results(results);
+            @endcode
+        */
+        template<typename... A> class static_accumulator_set {
+            public:
+                typedef std::tuple<typename A::accumulator_type...> storage_type;
+
+                /// Raw accumulator type at position I
+                template<std::size_t I> struct accumulator_type {
+                    typedef typename std::tuple_element<I, storage_type>::type type;
+                };
+
+                /// Number of accumulators in the set
+                static constexpr std::size_t size() { return sizeof...(A); }
+
+                /// Construct from named accumulators, taking their names and parameters
+                explicit static_accumulator_set(A const &... accs)
+                    : m_names{{ accs.name... }}
+                    , m_storage(accs.wrapper->template extract<typename A::accumulator_type>()...)
+                {}
+
+                /// Raw accumulator at position I
+                template<std::size_t I> typename accumulator_type<I>::type & get() {
+                    return std::get<I>(m_storage);
+                }
+                template<std::size_t I> typename accumulator_type<I>::type const & get() const {
+                    return std::get<I>(m_storage);
+                }
+
+                /// Add a measurement to the accumulator at position I
+                template<std::size_t I, typename T> void measure(T const & value) {
+                    std::get<I>(m_storage)(value);
+                }
+
+                /// Name of the accumulator at position i
+                std::string const & name(std::size_t i) const {
+                    return m_names.at(i);
+                }
+
+                /// Position of the accumulator with the given name (for runtime lookup)
+                /** @note Throws if there is no such accumulator */
+                std::size_t index(std::string const & name) const {
+                    for (std::size_t i = 0; i < size(); ++i)
+                        if (m_names[i] == name) return i;
+                    throw std::out_of_range("No observable found with the name: " + name + ALPS_STACKTRACE);
+                }
+
+                /// Save in the layout of `accumulator_set::save()`: one group per non-empty accumulator
+                void save(hdf5::archive & ar) const {
+                    ar.create_group("");
+                    for_each(save_visitor(*this, ar));
+                }
+
+                /// Load from the layout of `accumulator_set::save()`; accumulators missing in the archive are reset
+                void load(hdf5::archive & ar) {
+                    for_each(load_visitor(*this, ar));
+                }
+
+                void print(std::ostream & os) const {
+                    for_each(print_visitor(*this, os));
+                }
+
+                void reset() {
+                    for_each(reset_visitor(*this));
+                }
+
+                /// Merge another set of the same type into this one. @param rhs the set to merge.
+                void merge(static_accumulator_set const & rhs) {
+                    for_each(merge_visitor(*this, rhs));
+                }
+
+#ifdef ALPS_HAVE_MPI
+                void collective_merge(alps::mpi::communicator const & comm, int root) {
+                    for_each(collective_merge_visitor(*this, comm, root));
+                }
+#endif
+
+                /// Insert the results of all non-empty accumulators into `res`, by name
+                /** @note `result_set` cannot be returned by value: its copy constructor does not copy */
+                void results(result_set & res) const {
+                    for_each(result_visitor(*this, res));
+                }
+
+            private:
+                template<std::size_t I> using index_type = std::integral_constant<std::size_t, I>;
+
+                template<typename F, std::size_t I = 0>
+                typename std::enable_if<(I < sizeof...(A))>::type for_each(F const & f, index_type<I> idx = index_type<I>()) const {
+                    f(idx);
+                    for_each(f, index_type<I + 1>());
+                }
+                template<typename F, std::size_t I>
+                typename std::enable_if<(I == sizeof...(A))>::type for_each(F const &, index_type<I> = index_type<I>()) const {}
+
+                struct save_visitor {
+                    save_visitor(static_accumulator_set const & s, hdf5::archive & a): self(s), ar(a) {}
+                    template<std::size_t I> void operator()(index_type<I>) const {
+                        if (self.template get<I>().count() != 0)
+                            ar[self.m_names[I]] = self.template get<I>();
+                    }
+                    static_accumulator_set const & self;
+                    hdf5::archive & ar;
+                };
+
+                struct load_visitor {
+                    load_visitor(static_accumulator_set & s, hdf5::archive & a): self(s), ar(a) {}
+                    template<std::size_t I> void operator()(index_type<I>) const {
+                        typedef typename accumulator_type<I>::type acc_type;
+                        std::string const & name = self.m_names[I];
+                        if (!ar.is_group(name)) {
+                            self.template get<I>().reset();
+                            return;
+                        }
+                        ar.set_context(name);
+                        const bool loadable = acc_type::can_load(ar);
+                        ar.set_context("..");
+                        if (!loadable)
+                            throw std::logic_error("The Accumulator " + name + " cannot be unserilized as " + typeid(acc_type).name() + ALPS_STACKTRACE);
+                        ar[name] >> self.template get<I>();
+                    }
+                    static_accumulator_set & self;
+                    hdf5::archive & ar;
+                };
+
+                struct print_visitor {
+                    print_visitor(static_accumulator_set const & s, std::ostream & o): self(s), os(o) {}
+                    template<std::size_t I> void operator()(index_type<I>) const {
+                        os << self.m_names[I] << ": ";
+                        self.template get<I>().print(os, false);
+                        os << std::endl;
+                    }
+                    static_accumulator_set const & self;
+                    std::ostream & os;
+                };
+
+                struct reset_visitor {
+                    reset_visitor(static_accumulator_set & s): self(s) {}
+                    template<std::size_t I> void operator()(index_type<I>) const {
+                        self.template get<I>().reset();
+                    }
+                    static_accumulator_set & self;
+                };
+
+                struct merge_visitor {
+                    merge_visitor(static_accumulator_set & s, static_accumulator_set const & r): self(s), rhs(r) {}
+                    template<std::size_t I> void operator()(index_type<I>) const {
+                        if (self.m_names[I] != rhs.m_names[I])
+                            throw std::logic_error("Can't merge " + self.m_names[I] + " and " + rhs.m_names[I]);
+                        self.template get<I>().merge(rhs.template get<I>());
+                    }
+                    static_accumulator_set & self;
+                    static_accumulator_set const & rhs;
+                };
+
+#ifdef ALPS_HAVE_MPI
+                struct collective_merge_visitor {
+                    collective_merge_visitor(static_accumulator_set & s, alps::mpi::communicator const & c, int r): self(s), comm(c), root(r) {}
+                    template<std::size_t I> void operator()(index_type<I>) const {
+                        self.template get<I>().collective_merge(comm, root);
+                    }
+                    static_accumulator_set & self;
+                    alps::mpi::communicator const & comm;
+                    int root;
+                };
+#endif
+
+                struct result_visitor {
+                    result_visitor(static_accumulator_set const & s, result_set & r): self(s), res(r) {}
+                    template<std::size_t I> void operator()(index_type<I>) const {
+                        typedef typename accumulator_type<I>::type::result_type result_type;
+                        if (self.template get<I>().count() != 0)
+                            res.insert(self.m_names[I], std::shared_ptr<result_wrapper>(new result_wrapper(result_type(self.template get<I>()))));
+                    }
+                    static_accumulator_set const & self;
+                    result_set & res;
+                };
+
+                std::array<std::string, sizeof...(A)> m_names;
+                storage_type m_storage;
+        };
+
+        template<typename... A> inline std::ostream & operator<<(std::ostream & os, const static_accumulator_set<A...> & arg) {
+            arg.print(os);
+            return os;
+        }
+    }
+}
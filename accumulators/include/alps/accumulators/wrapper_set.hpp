@@ -9,6 +9,7 @@
 #include <alps/config.hpp>
 #include <alps/hdf5/archive.hpp>
 
+#include <limits>
 #include <memory>
 #include <mutex>
 
@@ -55,6 +56,12 @@ namespace alps {
                     void save(hdf5::archive & ar) const;
                     void load(hdf5::archive & ar);
 
+                    /// Load the accumulator/result `name` from the current context of `ar`
+                    /** Uses the registered type of the highest rank not above `max_rank` that can be loaded,
+                        e.g., `max_rank=NoBinningAccumulator<double>::result_type::rank()` skips the binning data */
+                    static std::shared_ptr<T> load_member(hdf5::archive & ar, std::string const & name,
+                                                          std::size_t max_rank = std::numeric_limits<std::size_t>::max());
+
                     /// Register a serializable type, without locking
                     template<typename A> static void register_serializable_type_nolock();
                     /// Register a user-defined serializable type
@@ -20,6 +20,7 @@
 #include <boost/variant/apply_visitor.hpp>
 
 #include <typeinfo>
+#include <utility>
 #include <type_traits>
 #include <stdexcept>
 
@@ -32,6 +33,27 @@ namespace alps {
             template<typename T> struct value_wrapper {
                 typedef T value_type;
             };
+
+            template<typename A> struct has_add_batch {
+                template<typename C> static char check(decltype(std::declval<C &>().add_batch(
+                    std::declval<typename value_type<C>::type const *>(), std::size_t()))*);
+                template<typename C> static double check(...);
+                typedef std::integral_constant<bool, sizeof(char) == sizeof(check<A>(0))> type;
+                constexpr static bool value = type::value;
+            };
+
+            /// Add a batch of values to an accumulator providing `add_batch()`
+            template<typename A> typename std::enable_if<has_add_batch<A>::value>::type
+            add_batch_impl(A & acc, typename value_type<A>::type const * values, std::size_t n) {
+                acc.add_batch(values, n);
+            }
+
+            /// Add a batch of values one by one to an accumulator without `add_batch()`
+            template<typename A> typename std::enable_if<!has_add_batch<A>::value>::type
+            add_batch_impl(A & acc, typename value_type<A>::type const * values, std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i)
+                    acc(values[i]);
+            }
         }
 
         template<typename T> class base_wrapper : public
@@ -51,6 +73,8 @@ namespace alps {
                 virtual ~base_wrapper() {}
 
                 virtual void operator()(value_type const & value) = 0;
+                /// Add the `n` values `values[0..n-1]` (one virtual call for the whole batch)
+                virtual void add_batch(value_type const * values, std::size_t n) = 0;
                 // virtual void operator()(value_type const & value, detail::weight_variant_type const & weight) = 0;
 
                 virtual void save(hdf5::archive & ar) const = 0;
@@ -63,6 +87,10 @@ namespace alps {
                 virtual void merge(const base_wrapper<T>&) = 0;
 #ifdef ALPS_HAVE_MPI
                 virtual void collective_merge(alps::mpi::communicator const & comm, int root) = 0;
+                /// Pack the data for a batched collective merge (see `detail::merge_buffer`)
+                virtual void pack_merge(detail::merge_buffer & buffer) const = 0;
+                /// Unpack the data merged by a batched collective merge (on the root)
+                virtual void unpack_merge(detail::merge_buffer & buffer) = 0;
 #endif
 
                 virtual base_wrapper * clone() const = 0;
@@ -189,6 +217,10 @@ namespace alps {
                     this->m_data(value);
                 }
 
+                void add_batch(value_type const * values, std::size_t n) {
+                    detail::add_batch_impl(this->m_data, values, n);
+                }
+
             public:
                 void save(hdf5::archive & ar) const {
                     ar[""] = this->m_data;
@@ -225,6 +257,14 @@ namespace alps {
                 ) const {
                     this->m_data.collective_merge(comm, root);
                 }
+
+                void pack_merge(detail::merge_buffer & buffer) const {
+                    this->m_data.pack_merge(buffer);
+                }
+
+                void unpack_merge(detail::merge_buffer & buffer) {
+                    this->m_data.unpack_merge(buffer);
+                }
 #endif
         };
 
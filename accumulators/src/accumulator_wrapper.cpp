@@ -5,6 +5,7 @@
  */
 
 #include <alps/accumulators/accumulator.hpp>
+#include <alps/accumulators/collective_merge.hpp>
 #include <sstream>
 
 namespace alps {
@@ -211,6 +212,34 @@ namespace alps {
             boost::apply_visitor(collective_merge_visitor(comm, root), m_variant);
             if (comm.rank()!=root) this->reset();
         }
+
+        void accumulator_wrapper::collective_merge(alps::mpi::communicator const & comm, int root, bool hierarchical) {
+            // the request must not own this wrapper
+            collective_merge_request::accumulators_type accs(1, std::make_pair(std::string("accumulator"),
+                std::shared_ptr<accumulator_wrapper>(this, [](accumulator_wrapper *) {})));
+            collective_merge_request(accs, comm, root, hierarchical).wait();
+        }
+
+        struct pack_merge_visitor: public boost::static_visitor<> {
+            pack_merge_visitor(detail::merge_buffer & b): buffer(b) {}
+            template<typename T> void operator()(T const & arg) const { arg->pack_merge(buffer); }
+            detail::merge_buffer & buffer;
+        };
+
+        void accumulator_wrapper::pack_merge(detail::merge_buffer & buffer) const {
+            boost::apply_visitor(pack_merge_visitor(buffer), m_variant);
+        }
+
+        struct unpack_merge_visitor: public boost::static_visitor<> {
+            unpack_merge_visitor(detail::merge_buffer & b): buffer(b) {}
+            template<typename T> void operator()(T & arg) const { arg->unpack_merge(buffer); }
+            template<typename T> void operator()(T const & arg) const { arg->unpack_merge(buffer); }
+            detail::merge_buffer & buffer;
+        };
+
+        void accumulator_wrapper::unpack_merge(detail::merge_buffer & buffer) {
+            boost::apply_visitor(unpack_merge_visitor(buffer), m_variant);
+        }
 #endif
 
         //
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <alps/accumulators/collective_merge.hpp>
+
+#ifdef ALPS_HAVE_MPI
+
+#include <alps/accumulators/merge_buffer.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace alps {
+    namespace accumulators {
+
+        merge_topology::merge_topology(alps::mpi::communicator const & comm, int root)
+            : m_comm(comm), m_root(root), m_node(MPI_COMM_NULL), m_leaders(MPI_COMM_NULL)
+        {
+#if MPI_VERSION >= 3
+            // the root comes first on its node and among the node leaders
+            const int key = comm.rank() == root ? 0 : comm.rank() + 1;
+            MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, key, MPI_INFO_NULL, &m_node);
+            int node_rank;
+            MPI_Comm_rank(m_node, &node_rank);
+            MPI_Comm_split(comm, node_rank == 0 ? 0 : MPI_UNDEFINED, key, &m_leaders);
+#endif
+            // without MPI-3 the nodes are unknown: merges have one level
+        }
+
+        merge_topology::~merge_topology() {
+            int finalized;
+            MPI_Finalized(&finalized);
+            if (finalized)
+                return;
+            if (m_leaders != MPI_COMM_NULL)
+                MPI_Comm_free(&m_leaders);
+            if (m_node != MPI_COMM_NULL)
+                MPI_Comm_free(&m_node);
+        }
+
+        struct collective_merge_request::state {
+            state(accumulators_type const & a, alps::mpi::communicator const & c, int r)
+                : accs(a), comm(c), root(r), node(MPI_COMM_NULL), leaders(MPI_COMM_NULL)
+                , between_nodes(false), done(false)
+            {}
+
+            state(accumulators_type const & a, std::shared_ptr<merge_topology const> const & t)
+                : accs(a), comm(t->comm()), root(t->root()), topology(t), node(t->node()), leaders(t->leaders())
+                , between_nodes(false), done(false)
+            {}
+
+            accumulators_type accs;
+            alps::mpi::communicator comm;
+            int root;
+            std::shared_ptr<merge_topology const> topology; ///< owns `node` and `leaders`
+            MPI_Comm node, leaders;     ///< for a hierarchical merge (`leaders` only on the lowest rank of each node)
+            bool between_nodes;         ///< the sums are being reduced among the node leaders
+            detail::merge_buffer buffer;
+            std::vector<MPI_Request> requests;
+            bool done;
+
+            /// Pack (or, in the unpack phase, unpack) all accumulators
+            /** All accumulators are packed, also those without measurements, so that the
+                layout of the buffers is the same on all ranks. */
+            void pack() {
+                for (accumulators_type::const_iterator it = accs.begin(); it != accs.end(); ++it) {
+                    accumulator_wrapper & acc = *it->second;
+                    if (buffer.phase() == detail::merge_buffer::max_phase) {
+                        buffer.put_same(acc.count() > 0);
+                        acc.pack_merge(buffer);
+                        continue;
+                    }
+                    detail::merge_buffer::size_type min, max;
+                    buffer.get_range(min, max);
+                    if (min != max)
+                        throw std::runtime_error(it->first + " was measured on only some of the MPI processes." + ALPS_STACKTRACE);
+                    if (buffer.phase() != detail::merge_buffer::unpack_phase)
+                        acc.pack_merge(buffer);
+                    else if (max != 0)
+                        acc.unpack_merge(buffer);
+                    else
+                        // measured on no rank: leave it alone
+                        acc.clone().unpack_merge(buffer);
+                }
+            }
+
+            /// Start reducing the sums of type S to the root, or, for a hierarchical merge, to the node leaders
+            template<typename S> void reduce_sums() {
+                detail::merge_buffer::sums_type<S> & sums = buffer.sums(S());
+                if (sums.local.empty())
+                    return;
+                const bool flat = node == MPI_COMM_NULL;
+                MPI_Comm c = flat ? MPI_Comm(comm) : node;
+                const int target = flat ? root : 0;
+                int rank;
+                MPI_Comm_rank(c, &rank);
+                if (rank == target)
+                    sums.global.resize(sums.local.size());
+                using alps::mpi::get_mpi_datatype;
+#if MPI_VERSION >= 3
+                requests.push_back(MPI_REQUEST_NULL);
+                MPI_Ireduce(&sums.local.front(), rank == target ? &sums.global.front() : NULL,
+                            static_cast<int>(sums.local.size()), get_mpi_datatype(S()), MPI_SUM, target, c, &requests.back());
+#else
+                MPI_Reduce(&sums.local.front(), rank == target ? &sums.global.front() : NULL,
+                           static_cast<int>(sums.local.size()), get_mpi_datatype(S()), MPI_SUM, target, c);
+#endif
+            }
+
+            /// Start reducing the sums of type S of the nodes among the node leaders to the root
+            template<typename S> void reduce_node_sums() {
+                detail::merge_buffer::sums_type<S> & sums = buffer.sums(S());
+                if (sums.local.empty())
+                    return;
+                int rank;
+                MPI_Comm_rank(leaders, &rank);
+                using alps::mpi::get_mpi_datatype;
+#if MPI_VERSION >= 3
+                requests.push_back(MPI_REQUEST_NULL);
+                MPI_Ireduce(rank == 0 ? MPI_IN_PLACE : &sums.global.front(), rank == 0 ? &sums.global.front() : NULL,
+                            static_cast<int>(sums.local.size()), get_mpi_datatype(S()), MPI_SUM, 0, leaders, &requests.back());
+#else
+                MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &sums.global.front(), rank == 0 ? &sums.global.front() : NULL,
+                           static_cast<int>(sums.local.size()), get_mpi_datatype(S()), MPI_SUM, 0, leaders);
+#endif
+            }
+
+            /// Pack the accumulators for the current phase and start its communication
+            void start_phase() {
+                using alps::mpi::get_mpi_datatype;
+                typedef detail::merge_buffer::size_type size_type;
+                pack();
+                requests.clear();
+                switch (buffer.phase()) {
+                    case detail::merge_buffer::max_phase: {
+                        std::vector<size_type> & local = buffer.max_local();
+                        buffer.max_global().resize(local.size());
+                        if (local.empty())
+                            break;
+#if MPI_VERSION >= 3
+                        requests.push_back(MPI_REQUEST_NULL);
+                        MPI_Iallreduce(&local.front(), &buffer.max_global().front(), static_cast<int>(local.size()),
+                                       get_mpi_datatype(size_type()), MPI_MAX, comm, &requests.back());
+#else
+                        MPI_Allreduce(&local.front(), &buffer.max_global().front(), static_cast<int>(local.size()),
+                                      get_mpi_datatype(size_type()), MPI_MAX, comm);
+#endif
+                        break;
+                    }
+                    case detail::merge_buffer::offset_phase: {
+                        std::vector<size_type> & local = buffer.offset_local();
+                        buffer.offset_start().assign(local.size(), 0);
+                        buffer.offset_total().resize(local.size());
+                        if (local.empty())
+                            break;
+#if MPI_VERSION >= 3
+                        requests.resize(2, MPI_REQUEST_NULL);
+                        MPI_Iexscan(&local.front(), &buffer.offset_start().front(), static_cast<int>(local.size()),
+                                    get_mpi_datatype(size_type()), MPI_SUM, comm, &requests[0]);
+                        MPI_Iallreduce(&local.front(), &buffer.offset_total().front(), static_cast<int>(local.size()),
+                                       get_mpi_datatype(size_type()), MPI_SUM, comm, &requests[1]);
+#else
+                        MPI_Exscan(&local.front(), &buffer.offset_start().front(), static_cast<int>(local.size()),
+                                   get_mpi_datatype(size_type()), MPI_SUM, comm);
+                        MPI_Allreduce(&local.front(), &buffer.offset_total().front(), static_cast<int>(local.size()),
+                                      get_mpi_datatype(size_type()), MPI_SUM, comm);
+#endif
+                        break;
+                    }
+                    case detail::merge_buffer::sum_phase:
+                        reduce_sums<boost::uint64_t>();
+                        reduce_sums<float>();
+                        reduce_sums<double>();
+                        reduce_sums<long double>();
+                        break;
+                    default:
+                        throw std::logic_error("No communication in this phase of a collective merge" + ALPS_STACKTRACE);
+                }
+            }
+
+            /// Go on with the next phase, once the communication of the current one is complete
+            void next_phase() {
+                if (buffer.phase() == detail::merge_buffer::sum_phase && leaders != MPI_COMM_NULL && !between_nodes) {
+                    // second level of a hierarchical merge
+                    between_nodes = true;
+                    reduce_node_sums<boost::uint64_t>();
+                    reduce_node_sums<float>();
+                    reduce_node_sums<double>();
+                    reduce_node_sums<long double>();
+                    return;
+                }
+                if (buffer.phase() == detail::merge_buffer::offset_phase && comm.rank() == 0)
+                    // the result of MPI_Exscan is undefined on rank 0
+                    std::fill(buffer.offset_start().begin(), buffer.offset_start().end(), 0);
+                buffer.next_phase();
+                if (buffer.phase() != detail::merge_buffer::unpack_phase) {
+                    start_phase();
+                    return;
+                }
+                if (comm.rank() == root)
+                    pack();
+                else
+                    for (accumulators_type::const_iterator it = accs.begin(); it != accs.end(); ++it)
+                        it->second->reset();
+                done = true;
+            }
+
+            void wait_requests() {
+                if (!requests.empty())
+                    MPI_Waitall(static_cast<int>(requests.size()), &requests.front(), MPI_STATUSES_IGNORE);
+                requests.clear();
+            }
+        };
+
+        collective_merge_request::collective_merge_request(accumulators_type const & accs, alps::mpi::communicator const & comm, int root,
+                                                           bool hierarchical)
+            : m_state(hierarchical ? new state(accs, std::make_shared<merge_topology const>(comm, root))
+                                   : new state(accs, comm, root))
+        {
+            m_state->start_phase();
+        }
+
+        collective_merge_request::collective_merge_request(accumulators_type const & accs,
+                                                           std::shared_ptr<merge_topology const> const & topology)
+            : m_state(new state(accs, topology))
+        {
+            m_state->start_phase();
+        }
+
+        collective_merge_request::collective_merge_request(collective_merge_request &&) = default;
+
+        collective_merge_request & collective_merge_request::operator=(collective_merge_request && rhs) {
+            if (m_state)
+                m_state->wait_requests();
+            m_state = std::move(rhs.m_state);
+            return *this;
+        }
+
+        collective_merge_request::~collective_merge_request() {
+            // the buffers must outlive the communication
+            if (m_state)
+                m_state->wait_requests();
+        }
+
+        bool collective_merge_request::test() {
+            while (!m_state->done) {
+                if (!m_state->requests.empty()) {
+                    int flag;
+                    MPI_Testall(static_cast<int>(m_state->requests.size()), &m_state->requests.front(), &flag, MPI_STATUSES_IGNORE);
+                    if (!flag)
+                        return false;
+                    m_state->requests.clear();
+                }
+                m_state->next_phase();
+            }
+            return true;
+        }
+
+        void collective_merge_request::wait() {
+            while (!m_state->done) {
+                m_state->wait_requests();
+                m_state->next_phase();
+            }
+        }
+
+        collective_merge_request collective_merge_async(accumulator_set & measurements, alps::mpi::communicator const & comm, int root,
+                                                        bool hierarchical) {
+            collective_merge_request::accumulators_type accs;
+            for (accumulator_set::iterator it = measurements.begin(); it != measurements.end(); ++it)
+                accs.push_back(*it);
+            return collective_merge_request(accs, comm, root, hierarchical);
+        }
+
+        collective_merge_request collective_merge_async(accumulator_set & measurements, std::vector<std::string> const & names,
+                                                        alps::mpi::communicator const & comm, int root, bool hierarchical) {
+            collective_merge_request::accumulators_type accs;
+            for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+                if (!measurements.has(*it))
+                    throw std::out_of_range("No observable found with the name: " + *it + ALPS_STACKTRACE);
+                accs.push_back(std::make_pair(*it, std::shared_ptr<accumulator_wrapper>(new accumulator_wrapper(measurements[*it]))));
+            }
+            return collective_merge_request(accs, comm, root, hierarchical);
+        }
+
+        void collective_merge(accumulator_set & measurements, alps::mpi::communicator const & comm, int root, bool hierarchical) {
+            collective_merge_async(measurements, comm, root, hierarchical).wait();
+        }
+    }
+}
+
+#endif
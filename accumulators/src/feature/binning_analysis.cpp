@@ -180,57 +180,90 @@ namespace alps {
 
             template<typename T, typename B>
             void Accumulator<T, binning_analysis_tag, B>::operator()(T const & val) {
+                B::operator()(val);
+                add_to_levels(val, B::count());
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, binning_analysis_tag, B>::add_batch(T const * values, std::size_t n) {
+                typename count_type<B>::type count = B::count();
+                B::add_batch(values, n);
+                for (std::size_t i = 0; i < n; ++i)
+                    add_to_levels(values[i], ++count);
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, binning_analysis_tag, B>::add_to_levels(T const & val, typename count_type<B>::type count) {
                 using alps::numeric::operator+=;
-                using alps::numeric::operator*;
                 using alps::numeric::check_size;
+                using alps::numeric::add_square;
+                using alps::numeric::set_zero;
 
-                B::operator()(val);
-                if(B::count() == (1UL << m_ac_sum2.size())) {
+                if(count == (1UL << m_ac_sum2.size())) {
+                    // The first bin of the new level spans all measurements so far:
+                    // its first half is the (only) completed bin of the previous level,
+                    // the second half is carried over from the previous level below.
                     m_ac_sum2.push_back(T());
                     check_size(m_ac_sum2.back(), val);
                     m_ac_sum.push_back(T());
                     check_size(m_ac_sum.back(), val);
-                    m_ac_partial.push_back(m_ac_sum[0]);
+                    m_ac_partial.push_back(m_ac_sum.size() > 1 ? m_ac_sum[m_ac_sum.size() - 2] : T());
                     check_size(m_ac_partial.back(), val);
                     m_ac_count.push_back(typename count_type<B>::type());
                 }
                 BOOST_ASSERT_MSG(m_ac_partial.size() >= m_ac_sum2.size(), "m_ac_partial is as large as m_ac_sum2");
                 BOOST_ASSERT_MSG(m_ac_count.size() >= m_ac_sum2.size(), "m_ac_count is as large as m_ac_sum2");
                 BOOST_ASSERT_MSG(m_ac_sum.size() >= m_ac_sum2.size(), "m_ac_sum is as large as m_ac_sum2");
-                for (unsigned i = 0; i < m_ac_sum2.size(); ++i) {
-                    m_ac_partial[i] += val;
-
-                    // in other words: (B::count() % (1L << i) == 0)
-                    if (!(B::count() & ((1ll << i) - 1))) {
-                        m_ac_sum2[i] += m_ac_partial[i] * m_ac_partial[i];
-                        m_ac_sum[i] += m_ac_partial[i];
-                        m_ac_count[i]++;
-                        m_ac_partial[i] = T();
-                        check_size(m_ac_partial[i], val);
-                    }
+
+                // Level i completes a bin every 2^i measurements; a completed bin is
+                // carried over into the partial bin of level i+1. Thus only the levels
+                // completing a bin are touched (2 on average), and all updates are in-place.
+                m_ac_partial[0] += val;
+                // in other words: (count % (1L << i) == 0)
+                for (unsigned i = 0; i < m_ac_sum2.size() && !(count & ((1ll << i) - 1)); ++i) {
+                    add_square(m_ac_sum2[i], m_ac_partial[i]);
+                    m_ac_sum[i] += m_ac_partial[i];
+                    m_ac_count[i]++;
+                    if (i + 1 < m_ac_sum2.size())
+                        m_ac_partial[i + 1] += m_ac_partial[i];
+                    set_zero(m_ac_partial[i]);
                 }
             }
 
             template<typename T, typename B>
             void Accumulator<T, binning_analysis_tag, B>::save(hdf5::archive & ar) const {
+                using alps::numeric::operator+=;
+
                 B::save(ar);
                 if (B::count())
                     ar["tau/partialbin"] = m_ac_sum;
                 ar["tau/data"] = m_ac_sum2;
                 ar["tau/ac_count"] = m_ac_count; // FIXME: proper dataset name? to be saved always?
-                ar["tau/ac_partial"] = m_ac_partial;  // FIXME: proper dataset name? to be saved always?
+
+                // The archive stores, for each level, the sum of all measurements in the
+                // current bin, including the ones not yet carried over from lower levels.
+                std::vector<T> partial(m_ac_partial);
+                for (std::size_t i = 1; i < partial.size(); ++i)
+                    partial[i] += partial[i - 1];
+                ar["tau/ac_partial"] = partial;  // FIXME: proper dataset name? to be saved always?
             }
 
             template<typename T, typename B>
             void Accumulator<T, binning_analysis_tag, B>::load(hdf5::archive & ar) { // TODO: make archive const
+                using alps::numeric::operator-=;
+
                 B::load(ar);
                 if (ar.is_data("tau/partialbin"))
                     ar["tau/partialbin"] >> m_ac_sum;
                 ar["tau/data"] >> m_ac_sum2;
                 if (ar.is_data("tau/ac_count"))
                     ar["tau/ac_count"] >> m_ac_count; // FIXME: proper dataset name?
-                if (ar.is_data("tau/ac_partial"))
+                if (ar.is_data("tau/ac_partial")) {
                     ar["tau/ac_partial"] >> m_ac_partial;  // FIXME: proper dataset name?
+                    // Convert back to the sums not yet carried over from lower levels (see save())
+                    for (std::size_t i = m_ac_partial.size(); i > 1; --i)
+                        m_ac_partial[i - 1] -= m_ac_partial[i - 2];
+                }
             }
 
             template<typename T, typename B>
@@ -309,6 +342,52 @@ namespace alps {
                     }
                 }
             }
+
+            template<typename T, typename B>
+            void Accumulator<T, binning_analysis_tag, B>::pack_merge(detail::merge_buffer & buffer) const {
+                B::pack_merge(buffer);
+                if (buffer.phase() == detail::merge_buffer::max_phase) {
+                    buffer.put_max(m_ac_count.size());
+                    return;
+                }
+                const std::size_t size = buffer.get_max();
+                if (buffer.phase() == detail::merge_buffer::sum_phase) {
+                    std::vector<typename count_type<B>::type> count(m_ac_count);
+                    count.resize(size);
+                    buffer.put_sum(count);
+
+                    std::vector<T> sum(m_ac_sum);
+                    sum.resize(size);
+                    alps::numeric::rectangularize(sum);
+                    buffer.put_sum(sum);
+
+                    std::vector<T> sum2(m_ac_sum2);
+                    sum2.resize(size);
+                    alps::numeric::rectangularize(sum2);
+                    buffer.put_sum(sum2);
+                }
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, binning_analysis_tag, B>::unpack_merge(detail::merge_buffer & buffer) {
+                B::unpack_merge(buffer);
+                const std::size_t size = buffer.get_max();
+
+                m_ac_count.resize(size);
+                buffer.get_sum(m_ac_count);
+
+                m_ac_sum.resize(size);
+                alps::numeric::rectangularize(m_ac_sum);
+                buffer.get_sum(m_ac_sum);
+
+                m_ac_sum2.resize(size);
+                alps::numeric::rectangularize(m_ac_sum2);
+                buffer.get_sum(m_ac_sum2);
+
+                // the partial bins stay local, but there must be one for each level
+                m_ac_partial.resize(size);
+                alps::numeric::rectangularize(m_ac_partial);
+            }
 #endif
 
             #define ALPS_ACCUMULATOR_INST_BINNING_ANALYSIS_ACC(r, data, T)                         \
@@ -26,6 +26,11 @@ namespace alps {
                 throw std::runtime_error("No values can be added to a result" + ALPS_STACKTRACE);
             }
 
+            template<typename T, typename B>
+            void Result<T, count_tag, B>::add_batch(T const *, std::size_t) {
+                throw std::runtime_error("No values can be added to a result" + ALPS_STACKTRACE);
+            }
+
             template<typename T, typename B>
             void Result<T, count_tag, B>::save(hdf5::archive & ar) const {
                 if (m_count==0) {
@@ -109,6 +114,19 @@ namespace alps {
                 else
                     alps::alps_mpi::reduce(comm, m_count, std::plus<count_type>(), root);
             }
+
+            template<typename T, typename B>
+            void Accumulator<T, count_tag, B>::pack_merge(detail::merge_buffer & buffer) const {
+                B::pack_merge(buffer);
+                if (buffer.phase() == detail::merge_buffer::sum_phase)
+                    buffer.put_sum(m_count);
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, count_tag, B>::unpack_merge(detail::merge_buffer & buffer) {
+                B::unpack_merge(buffer);
+                buffer.get_sum(m_count);
+            }
 #endif
 
             #define ALPS_ACCUMULATOR_INST_COUNT_ACC(r, data, T) \
@@ -39,13 +39,23 @@ namespace alps {
 
             template<typename T, typename B>
             void Accumulator<T, error_tag, B>::operator()(T const & val) {
-                using alps::numeric::operator*;
-                using alps::numeric::operator+=;
                 using alps::numeric::check_size;
+                using alps::numeric::add_square;
 
                 B::operator()(val);
                 check_size(m_sum2, val);
-                m_sum2 += val * val;
+                add_square(m_sum2, val); // m_sum2 += val * val, without a temporary
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, error_tag, B>::add_batch(T const * values, std::size_t n) {
+                using alps::numeric::check_size;
+                using alps::numeric::add_sum_of_squares;
+
+                B::add_batch(values, n);
+                if (n == 0) return;
+                check_size(m_sum2, values[0]);
+                add_sum_of_squares(m_sum2, values, n);
             }
 
             template<typename T, typename B>
@@ -100,6 +110,20 @@ namespace alps {
                 else
                     B::reduce_if(comm, m_sum2, std::plus<typename alps::hdf5::scalar_type<T>::type>(), root);
             }
+
+            template<typename T, typename B>
+            void Accumulator<T, error_tag, B>::pack_merge(detail::merge_buffer & buffer) const {
+                B::pack_merge(buffer);
+                // (the mean has checked the size)
+                if (buffer.phase() == detail::merge_buffer::sum_phase)
+                    buffer.put_sum(m_sum2);
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, error_tag, B>::unpack_merge(detail::merge_buffer & buffer) {
+                B::unpack_merge(buffer);
+                buffer.get_sum(m_sum2);
+            }
 #endif
 
             #define ALPS_ACCUMULATOR_INST_ERROR_ACC(r, data, T)                                    \
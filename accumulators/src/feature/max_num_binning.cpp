@@ -11,6 +11,8 @@
 #include <boost/preprocessor/tuple/to_seq.hpp>
 #include <boost/preprocessor/seq/for_each.hpp>
 
+#include <algorithm>
+
 #define ALPS_ACCUMULATOR_VALUE_TYPES_SEQ BOOST_PP_TUPLE_TO_SEQ(ALPS_ACCUMULATOR_VALUE_TYPES_SIZE, (ALPS_ACCUMULATOR_VALUE_TYPES))
 
 namespace alps {
@@ -28,7 +30,9 @@ namespace alps {
                 , m_mn_elements_in_bin(0)
                 , m_mn_elements_in_partial(0)
                 , m_mn_partial(T())
-            {}
+            {
+                m_mn_bins.reserve(m_mn_max_number);
+            }
 
             template<typename T, typename B>
             Accumulator<T, max_num_binning_tag, B>::Accumulator(Accumulator const & arg)
@@ -42,13 +46,23 @@ namespace alps {
 
             template<typename T, typename B>
             void Accumulator<T, max_num_binning_tag, B>::operator()(T const & val) {
+                B::operator()(val);
+                add_to_bins(val);
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, max_num_binning_tag, B>::add_batch(T const * values, std::size_t n) {
+                B::add_batch(values, n);
+                for (std::size_t i = 0; i < n; ++i)
+                    add_to_bins(values[i]);
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, max_num_binning_tag, B>::add_to_bins(T const & val) {
                 using alps::numeric::operator+=;
                 using alps::numeric::operator+;
-                using alps::numeric::operator/;
                 using alps::numeric::check_size;
 
-                B::operator()(val);
-
                 if (!m_mn_elements_in_bin) {
                     m_mn_bins.push_back(val);
                     m_mn_elements_in_bin = 1;
@@ -61,25 +75,113 @@ namespace alps {
 
                 // TODO: make library for scalar type
                 typename alps::numeric::scalar<T>::type elements_in_bin = m_mn_elements_in_bin;
-                typename alps::numeric::scalar<typename mean_type<B>::type>::type two = 2;
 
                 if (m_mn_elements_in_partial == m_mn_elements_in_bin && m_mn_bins.size() >= m_mn_max_number) {
                     if (m_mn_max_number % 2 == 1) {
                         m_mn_partial += m_mn_bins[m_mn_max_number - 1];
                         m_mn_elements_in_partial += m_mn_elements_in_bin;
                     }
-                    for (typename count_type<T>::type i = 0; i < m_mn_max_number / 2; ++i)
-                        m_mn_bins[i] = (m_mn_bins[2 * i] + m_mn_bins[2 * i + 1]) / two;
-                    m_mn_bins.erase(m_mn_bins.begin() + m_mn_max_number / 2, m_mn_bins.end());
+                    // in place: no temporaries for vector types
+                    alps::numeric::average_blocks(&m_mn_bins.front(), 2 * (m_mn_max_number / 2), 2);
+                    // keep the storage of the dropped bins for the bins to come
+                    for (std::size_t i = m_mn_max_number / 2; i < m_mn_bins.size(); ++i)
+                        m_mn_spare_bins.push_back(std::move(m_mn_bins[i]));
+                    m_mn_bins.resize(m_mn_max_number / 2);
                     m_mn_elements_in_bin *= (typename count_type<T>::type)2;
                 }
                 if (m_mn_elements_in_partial == m_mn_elements_in_bin) {
-                    m_mn_bins.push_back(m_mn_partial / elements_in_bin);
-                    m_mn_partial = T();
+                    if (m_mn_spare_bins.empty()) {
+                        m_mn_bins.push_back(m_mn_partial);
+                    } else {
+                        m_mn_bins.push_back(std::move(m_mn_spare_bins.back()));
+                        m_mn_spare_bins.pop_back();
+                        m_mn_bins.back() = m_mn_partial;
+                    }
+                    alps::numeric::divide_by(m_mn_bins.back(), elements_in_bin);
+                    // keep the storage of the partial bin
+                    alps::numeric::set_zero(m_mn_partial);
                     m_mn_elements_in_partial = 0;
                 }
             }
 
+            template<typename T, typename B>
+            void Accumulator<T, max_num_binning_tag, B>::combine_bins(std::vector<typename mean_type<B>::type> & bins,
+                                                                      typename B::count_type elements_in_bin,
+                                                                      typename B::count_type factor,
+                                                                      T & partial,
+                                                                      typename B::count_type & elements_in_partial)
+            {
+                using alps::numeric::operator+=;
+                using alps::numeric::operator+;
+                using alps::numeric::operator*;
+                using alps::numeric::operator/;
+                using alps::numeric::check_size;
+
+                typedef typename alps::numeric::scalar<typename mean_type<B>::type>::type scalar_type;
+                const std::size_t newbins = bins.size() / factor;
+                if (factor > 1 && newbins > 0)
+                    alps::numeric::average_blocks(&bins.front(), bins.size(), factor);
+                const scalar_type elements_in_bin_vt = elements_in_bin;
+                for (std::size_t i = newbins * factor; i < bins.size(); ++i) {
+                    check_size(partial, bins[i]);
+                    partial += bins[i] * elements_in_bin_vt;
+                    elements_in_partial += elements_in_bin;
+                }
+                bins.resize(newbins);
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, max_num_binning_tag, B>::merge_bins(std::vector<typename mean_type<B>::type> const & bins,
+                                                                    typename B::count_type elements_in_bin,
+                                                                    T const & partial,
+                                                                    typename B::count_type elements_in_partial)
+            {
+                using alps::numeric::operator+=;
+                using alps::numeric::operator*;
+                using alps::numeric::check_size;
+
+                if (!elements_in_bin) return; // nothing to merge
+                if (!m_mn_elements_in_bin) {
+                    m_mn_bins = bins;
+                    m_mn_elements_in_bin = elements_in_bin;
+                    m_mn_partial = partial;
+                    m_mn_elements_in_partial = elements_in_partial;
+                } else {
+                    // bin sizes are powers of 2: bring both sets of bins to the larger one
+                    const typename B::count_type common = std::max(m_mn_elements_in_bin, elements_in_bin);
+                    std::vector<typename mean_type<B>::type> rhs_bins(bins);
+                    combine_bins(m_mn_bins, m_mn_elements_in_bin, common / m_mn_elements_in_bin, m_mn_partial, m_mn_elements_in_partial);
+                    combine_bins(rhs_bins, elements_in_bin, common / elements_in_bin, m_mn_partial, m_mn_elements_in_partial);
+                    m_mn_elements_in_bin = common;
+                    m_mn_bins.insert(m_mn_bins.end(), rhs_bins.begin(), rhs_bins.end());
+                    if (elements_in_partial) {
+                        check_size(m_mn_partial, partial);
+                        m_mn_partial += partial;
+                        m_mn_elements_in_partial += elements_in_partial;
+                    }
+                }
+                for (;;) {
+                    // The merged partial bins may hold more elements than a bin: close as many whole bins
+                    // as they fill, each with their average, and keep the rest of the elements in the partial bin
+                    if (m_mn_elements_in_partial >= m_mn_elements_in_bin) {
+                        typedef typename alps::numeric::scalar<T>::type scalar_type;
+                        const typename B::count_type closed = m_mn_elements_in_partial / m_mn_elements_in_bin;
+                        const typename B::count_type left = m_mn_elements_in_partial - closed * m_mn_elements_in_bin;
+                        alps::numeric::divide_by(m_mn_partial, scalar_type(m_mn_elements_in_partial));
+                        m_mn_bins.insert(m_mn_bins.end(), closed, m_mn_partial);
+                        if (left)
+                            m_mn_partial = m_mn_partial * scalar_type(left);
+                        else
+                            alps::numeric::set_zero(m_mn_partial);
+                        m_mn_elements_in_partial = left;
+                    }
+                    if (m_mn_bins.size() <= m_mn_max_number)
+                        break;
+                    combine_bins(m_mn_bins, m_mn_elements_in_bin, 2, m_mn_partial, m_mn_elements_in_partial);
+                    m_mn_elements_in_bin *= 2;
+                }
+            }
+
             template<typename T, typename B>
             void Accumulator<T, max_num_binning_tag, B>::save(hdf5::archive & ar) const {
                 B::save(ar);
@@ -100,6 +202,7 @@ namespace alps {
                 ar["timeseries/data"] >> m_mn_bins;
                 ar["timeseries/data/@binsize"] >> m_mn_elements_in_bin;
                 ar["timeseries/data/@maxbinnum"] >> m_mn_max_number;
+                m_mn_bins.reserve(m_mn_max_number);
                 if (ar.is_data("timeseries/partialbin")) {
                     ar["timeseries/partialbin"] >> m_mn_partial;
                     ar["timeseries/partialbin/@count"] >> m_mn_elements_in_partial;
@@ -130,7 +233,7 @@ namespace alps {
                 m_mn_elements_in_bin = typename B::count_type();
                 m_mn_elements_in_partial = typename B::count_type();
                 m_mn_partial = T();
-                m_mn_bins = std::vector<typename mean_type<B>::type>();
+                m_mn_bins.clear();
             }
 
 #ifdef ALPS_HAVE_MPI
@@ -181,33 +284,88 @@ namespace alps {
                 typename B::count_type howmany = (elements_in_local_bins - 1) / m_mn_elements_in_bin + 1;
                 if (howmany > 1) {
                     typename B::count_type newbins = local_bins.size() / howmany;
-                    typename alps::numeric::scalar<typename mean_type<B>::type>::type howmany_vt = howmany;
-                    for (typename B::count_type i = 0; i < newbins; ++i) {
-                        local_bins[i] = local_bins[howmany * i];
-                        for (typename B::count_type j = 1; j < howmany; ++j)
-                            local_bins[i] = local_bins[i] + local_bins[howmany * i + j];
-                        local_bins[i] = local_bins[i] / howmany_vt;
-                    }
-                        local_bins.resize(newbins);
+                    if (newbins > 0)
+                        alps::numeric::average_blocks(&local_bins.front(), local_bins.size(), howmany);
+                    local_bins.resize(newbins);
                 }
 
                 std::vector<std::size_t> index(comm.size());
                 alps::mpi::all_gather(comm, local_bins.size(), index);
                 std::size_t total_bins = std::accumulate(index.begin(), index.end(), 0);
                 std::size_t perbin = total_bins < m_mn_max_number ? 1 : total_bins / m_mn_max_number;
-                typename alps::numeric::scalar<typename mean_type<B>::type>::type perbin_vt = perbin;
 
                 merged_bins.resize(perbin == 1 ? total_bins : m_mn_max_number);
                 for (typename std::vector<typename mean_type<B>::type>::iterator it = merged_bins.begin(); it != merged_bins.end(); ++it)
                     check_size(*it, local_bins[0]);
 
                 std::size_t start = std::accumulate(index.begin(), index.begin() + comm.rank(), 0);
+                spread_bins(local_bins, start, perbin, merged_bins);
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, max_num_binning_tag, B>::spread_bins(std::vector<typename mean_type<B>::type> const & local_bins,
+                                                                     std::size_t start,
+                                                                     std::size_t perbin,
+                                                                     std::vector<typename mean_type<B>::type> & merged_bins)
+            {
+                using alps::numeric::operator+;
+                using alps::numeric::operator/;
+
+                typename alps::numeric::scalar<typename mean_type<B>::type>::type perbin_vt = perbin;
                 for (std::size_t i = start / perbin, j = start % perbin, k = 0; i < merged_bins.size() && k < local_bins.size(); ++k) {
                     merged_bins[i] = merged_bins[i] + local_bins[k] / perbin_vt;
                     if (++j == perbin)
                         ++i, j = 0;
                 }
             }
+
+            template<typename T, typename B>
+            void Accumulator<T, max_num_binning_tag, B>::pack_merge(detail::merge_buffer & buffer) const {
+                B::pack_merge(buffer);
+                if (buffer.phase() == detail::merge_buffer::max_phase) {
+                    buffer.put_max(m_mn_elements_in_bin);
+                    buffer.put_max(m_mn_bins.empty() ? 0 : detail::scalar_count(m_mn_bins[0]));
+                    return;
+                }
+                // the local bins are brought to the largest bin size, then concatenated over the ranks, as in collective_merge()
+                const typename B::count_type elements_in_local_bins = buffer.get_max();
+                const std::size_t bin_size = buffer.get_max();
+                const typename B::count_type howmany = m_mn_bins.empty() ? 1 : (elements_in_local_bins - 1) / m_mn_elements_in_bin + 1;
+                if (buffer.phase() == detail::merge_buffer::offset_phase) {
+                    buffer.put_offset(m_mn_bins.size() / howmany);
+                    return;
+                }
+                const detail::merge_buffer::offset_type offset = buffer.get_offset();
+                const std::size_t perbin = offset.total < m_mn_max_number ? 1 : offset.total / m_mn_max_number;
+                if (buffer.phase() == detail::merge_buffer::sum_phase) {
+                    std::vector<typename mean_type<B>::type> local_bins(m_mn_bins);
+                    T partial = T();
+                    typename B::count_type elements_in_partial = 0;
+                    // (the bins left over are dropped, as in collective_merge())
+                    combine_bins(local_bins, m_mn_elements_in_bin, howmany, partial, elements_in_partial);
+
+                    std::vector<typename mean_type<B>::type> merged_bins(perbin == 1 ? offset.total : m_mn_max_number);
+                    for (typename std::vector<typename mean_type<B>::type>::iterator it = merged_bins.begin(); it != merged_bins.end(); ++it)
+                        detail::set_scalar_count(*it, bin_size);
+                    spread_bins(local_bins, offset.start, perbin, merged_bins);
+                    buffer.put_sum(merged_bins);
+                }
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, max_num_binning_tag, B>::unpack_merge(detail::merge_buffer & buffer) {
+                B::unpack_merge(buffer);
+                const typename B::count_type elements_in_local_bins = buffer.get_max();
+                const std::size_t bin_size = buffer.get_max();
+                const detail::merge_buffer::offset_type offset = buffer.get_offset();
+                const std::size_t perbin = offset.total < m_mn_max_number ? 1 : offset.total / m_mn_max_number;
+
+                m_mn_bins.resize(perbin == 1 ? offset.total : m_mn_max_number);
+                for (typename std::vector<typename mean_type<B>::type>::iterator it = m_mn_bins.begin(); it != m_mn_bins.end(); ++it)
+                    detail::set_scalar_count(*it, bin_size);
+                buffer.get_sum(m_mn_bins);
+                m_mn_elements_in_bin = elements_in_local_bins * perbin;
+            }
 #endif
 
             #define ALPS_ACCUMULATOR_INST_MAX_NUM_BINNING_ACC(r, data, T)                          \
@@ -435,9 +593,8 @@ namespace alps {
                 using alps::numeric::acos;                                                        \
                 using std::atan;                                                                  \
                 using alps::numeric::atan;                                                        \
-                typedef typename value_type<B>::type (*fptr_type)(typename value_type<B>::type);  \
-                fptr_type fptr=& FUNCTION_NAME;                                                   \
-                transform(fptr);                                                                  \
+                typedef typename value_type<B>::type value_type;                                  \
+                transform([](value_type const & x) -> value_type { return FUNCTION_NAME (x); });  \
                 B:: FUNCTION_NAME ();                                                             \
             }
 
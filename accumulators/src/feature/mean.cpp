@@ -42,6 +42,17 @@ namespace alps {
                 m_sum += val;
             }
 
+            template<typename T, typename B>
+            void Accumulator<T, mean_tag, B>::add_batch(T const * values, std::size_t n) {
+                using alps::numeric::check_size;
+                using alps::numeric::add_sum;
+
+                B::add_batch(values, n);
+                if (n == 0) return;
+                check_size(m_sum, values[0]);
+                add_sum(m_sum, values, n); // pairwise summation of the block for scalars
+            }
+
             template<typename T, typename B>
             void Accumulator<T, mean_tag, B>::save(hdf5::archive & ar) const {
                 B::save(ar);
@@ -94,6 +105,25 @@ namespace alps {
                 else
                     B::reduce_if(comm, m_sum, std::plus<typename alps::hdf5::scalar_type<T>::type>(), root);
             }
+
+            template<typename T, typename B>
+            void Accumulator<T, mean_tag, B>::pack_merge(detail::merge_buffer & buffer) const {
+                B::pack_merge(buffer);
+                if (buffer.phase() == detail::merge_buffer::max_phase) {
+                    buffer.put_same(detail::scalar_count(m_sum));
+                    return;
+                }
+                buffer.get_same("the size of the mean");
+                if (buffer.phase() == detail::merge_buffer::sum_phase)
+                    buffer.put_sum(m_sum);
+            }
+
+            template<typename T, typename B>
+            void Accumulator<T, mean_tag, B>::unpack_merge(detail::merge_buffer & buffer) {
+                B::unpack_merge(buffer);
+                buffer.get_same("the size of the mean");
+                buffer.get_sum(m_sum);
+            }
 #endif
 
             template<typename T, typename B>
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <alps/config.hpp>
+#include <alps/accumulators/lazy_result_set.hpp>
+#include <alps/accumulators.hpp>
+#include <alps/utilities/stacktrace.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace alps {
+    namespace accumulators {
+
+        lazy_result_set::lazy_result_set(hdf5::archive & ar, std::string const & path, bool bins)
+            : m_archive(ar)
+            , m_path(ar.complete_path(path))
+            , m_bins(bins)
+            , m_names(ar.list_children(m_path))
+        {}
+
+        bool lazy_result_set::has(std::string const & name) const {
+            return std::find(m_names.begin(), m_names.end(), name) != m_names.end();
+        }
+
+        bool lazy_result_set::loaded(std::string const & name) const {
+            return m_loaded.find(name) != m_loaded.end();
+        }
+
+        result_wrapper const & lazy_result_set::operator[](std::string const & name) const {
+            std::map<std::string, std::shared_ptr<result_wrapper> >::const_iterator it = m_loaded.find(name);
+            if (it != m_loaded.end())
+                return *(it->second);
+            if (!has(name))
+                throw std::out_of_range("No result found with the name: " + name + ALPS_STACKTRACE);
+
+            // without bins, load everything as a result of a NoBinningAccumulator
+            std::size_t max_rank = m_bins
+                ? std::numeric_limits<std::size_t>::max()
+                : NoBinningAccumulator<double>::result_type::rank();
+
+            std::string context = m_archive.get_context();
+            m_archive.set_context(m_path);
+            std::shared_ptr<result_wrapper> result;
+            try {
+                result = result_set::load_member(m_archive, name, max_rank);
+            } catch (...) {
+                m_archive.set_context(context);
+                throw;
+            }
+            m_archive.set_context(context);
+            return *(m_loaded[name] = result);
+        }
+
+        void lazy_result_set::load(result_set & results) const {
+            for (std::vector<std::string>::const_iterator it = m_names.begin(); it != m_names.end(); ++it)
+                results.insert(*it, std::shared_ptr<result_wrapper>(new result_wrapper(operator[](*it))));
+        }
+    }
+}
@@ -6,6 +6,7 @@
 
 #include <alps/accumulators/accumulator.hpp>
 #include <sstream>
+#include <utility>
 
 namespace alps {
     namespace accumulators {
@@ -31,6 +32,9 @@ namespace alps {
             copy_visitor visitor(m_variant);
             boost::apply_visitor(visitor, rhs.m_variant);
         }
+        result_wrapper::result_wrapper(result_wrapper && rhs)
+            : m_variant(std::move(rhs.m_variant))
+        {}
         result_wrapper::result_wrapper(hdf5::archive & ar) {
             ar[""] >> *this;
         }
@@ -109,9 +113,12 @@ namespace alps {
         // unary plus
         //
 
-        result_wrapper result_wrapper::operator+ () const {
+        result_wrapper result_wrapper::operator+ () const & {
             return result_wrapper(*this);
         }
+        result_wrapper result_wrapper::operator+ () && {
+            return std::move(*this);
+        }
 
         //
         // unary minus
@@ -122,11 +129,13 @@ namespace alps {
                 arg->negate();
             }
         };
-        result_wrapper result_wrapper::operator- () const {
-            result_wrapper clone(*this);
+        result_wrapper result_wrapper::operator- () const & {
+            return -result_wrapper(*this);
+        }
+        result_wrapper result_wrapper::operator- () && {
             unary_add_visitor visitor;
-            boost::apply_visitor(visitor, clone.m_variant);
-            return clone;
+            boost::apply_visitor(visitor, m_variant);
+            return std::move(*this);
         }
 
         //
@@ -193,16 +202,24 @@ namespace alps {
                 boost::apply_visitor(visitor, m_variant);                                                   \
                 return *this;                                                                               \
             }                                                                                               \
-            result_wrapper result_wrapper:: OPNAME (result_wrapper const & arg) const {                     \
+            result_wrapper result_wrapper:: OPNAME (result_wrapper const & arg) const & {                   \
                 result_wrapper clone(*this);                                                                \
                 clone AUGOP arg;                                                                            \
                 return clone;                                                                               \
             }                                                                                               \
+            result_wrapper result_wrapper:: OPNAME (result_wrapper const & arg) && {                        \
+                *this AUGOP arg;                                                                            \
+                return std::move(*this);                                                                    \
+            }                                                                                               \
             /** @brief Visitor to do OP with RHS constant value */                                          \
-            result_wrapper result_wrapper:: OPNAME (long double arg) const {                                \
+            result_wrapper result_wrapper:: OPNAME (long double arg) const & {                              \
                 result_wrapper clone(*this);                                                                \
                 clone AUGOP arg;                                                                            \
                 return clone;                                                                               \
+            }                                                                                               \
+            result_wrapper result_wrapper:: OPNAME (long double arg) && {                                   \
+                *this AUGOP arg;                                                                            \
+                return std::move(*this);                                                                    \
             }
         ALPS_ACCUMULATOR_OPERATOR_PROXY(operator+, operator+=, +=, add)
         ALPS_ACCUMULATOR_OPERATOR_PROXY(operator-, operator-=, -=, sub)
@@ -217,10 +234,12 @@ namespace alps {
         struct inverse_visitor: public boost::static_visitor<> {
             template<typename T> void operator()(T & arg) const { arg->inverse(); }
         };
-        result_wrapper result_wrapper::inverse() const {
-            result_wrapper clone(*this);
-            boost::apply_visitor(inverse_visitor(), clone.m_variant);
-            return clone;
+        result_wrapper result_wrapper::inverse() const & {
+            return result_wrapper(*this).inverse();
+        }
+        result_wrapper result_wrapper::inverse() && {
+            boost::apply_visitor(inverse_visitor(), m_variant);
+            return std::move(*this);
         }
 
         //
@@ -233,10 +252,12 @@ namespace alps {
                     arg-> FUN ();                                               \
                 }                                                               \
             };                                                                  \
-            result_wrapper result_wrapper:: FUN () const {                      \
-                result_wrapper clone(*this);                                    \
-                boost::apply_visitor( FUN ## _visitor(), clone.m_variant);      \
-                return clone;                                                   \
+            result_wrapper result_wrapper:: FUN () const & {                    \
+                return result_wrapper(*this). FUN ();                           \
+            }                                                                   \
+            result_wrapper result_wrapper:: FUN () && {                         \
+                boost::apply_visitor( FUN ## _visitor(), m_variant);            \
+                return std::move(*this);                                        \
             }
         ALPS_ACCUMULATOR_FUNCTION_PROXY(sin)
         ALPS_ACCUMULATOR_FUNCTION_PROXY(cos)
@@ -262,6 +283,9 @@ namespace alps {
 #define EXTERNAL_FUNCTION(FUN)                                  \
         result_wrapper FUN (result_wrapper const & arg) {       \
             return arg. FUN ();                                 \
+        }                                                       \
+        result_wrapper FUN (result_wrapper && arg) {            \
+            return std::move(arg). FUN ();                      \
         }
         EXTERNAL_FUNCTION(sin)
         EXTERNAL_FUNCTION(cos)
@@ -90,30 +90,43 @@ namespace alps {
             }
 
             template<typename T>
-            void wrapper_set<T>::load(hdf5::archive & ar) {
-                std::lock_guard<std::mutex> guard(m_types_mutex);
-                std::vector<std::string> list = ar.list_children("");
-                for (std::vector<std::string>::const_iterator it = list.begin(); it != list.end(); ++it) {
-                    ar.set_context(*it);
+            std::shared_ptr<T> wrapper_set<T>::load_member(hdf5::archive & ar, std::string const & name, std::size_t max_rank) {
+                ar.set_context(name);
+                std::shared_ptr<T> member;
+                {
+                    std::lock_guard<std::mutex> guard(m_types_mutex);
+                    if (m_types.empty()) detail::register_predefined_serializable_types();
                     for (typename std::vector<std::shared_ptr<detail::serializable_type<T> > >::const_iterator jt = m_types.begin()
                         ; jt != m_types.end()
                         ; ++jt
                     )
-                        if ((*jt)->can_load(ar)) {
-                            operator[](*it) = std::shared_ptr<T>((*jt)->create(ar));
+                        if ((*jt)->rank() <= max_rank && (*jt)->can_load(ar)) {
+                            member.reset((*jt)->create(ar));
                             break;
                         }
-                    if (!has(*it))
-                        throw std::logic_error("The Accumulator/Result " + *it + " cannot be unserilized" + ALPS_STACKTRACE);
-                    operator[](*it).load(ar);
+                }
+                if (!member) {
                     ar.set_context("..");
+                    throw std::logic_error("The Accumulator/Result " + name + " cannot be unserilized" + ALPS_STACKTRACE);
                 }
+                member->load(ar);
+                ar.set_context("..");
+                return member;
+            }
+
+            template<typename T>
+            void wrapper_set<T>::load(hdf5::archive & ar) {
+                std::vector<std::string> list = ar.list_children("");
+                for (std::vector<std::string>::const_iterator it = list.begin(); it != list.end(); ++it)
+                    m_storage[*it] = load_member(ar, *it);
             }
 
             template void wrapper_set<accumulator_wrapper>::save(hdf5::archive &) const;
             template void wrapper_set<result_wrapper>::save(hdf5::archive &) const;
             template void wrapper_set<accumulator_wrapper>::load(hdf5::archive &);
             template void wrapper_set<result_wrapper>::load(hdf5::archive &);
+            template std::shared_ptr<accumulator_wrapper> wrapper_set<accumulator_wrapper>::load_member(hdf5::archive &, std::string const &, std::size_t);
+            template std::shared_ptr<result_wrapper> wrapper_set<result_wrapper>::load_member(hdf5::archive &, std::string const &, std::size_t);
         }
     }
 }
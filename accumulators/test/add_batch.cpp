@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file add_batch.cpp
+    Test adding measurements in batches against adding them one by one
+*/
+
+#include <cmath>
+#include <vector>
+
+#include "alps/accumulators.hpp"
+#include "gtest/gtest.h"
+
+namespace aa=alps::accumulators;
+
+namespace {
+    const std::size_t VSIZE=3;
+    const std::size_t NPOINTS=1000;
+
+    inline void make_value(double x, double& val) { val=x; }
+    inline void make_value(double x, std::vector<double>& val) {
+        val.resize(VSIZE);
+        for (std::size_t k=0; k<VSIZE; ++k) val[k]=x+k*x*x;
+    }
+
+    inline void expect_near(double expected, double actual) {
+        EXPECT_NEAR(expected, actual, 1E-12*std::fabs(expected));
+    }
+    inline void expect_near(const std::vector<double>& expected, const std::vector<double>& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (std::size_t k=0; k<expected.size(); ++k) expect_near(expected[k], actual[k]);
+    }
+}
+
+/// Google Test Fixture: A is a named accumulator type
+template <typename A>
+class AddBatchTest : public ::testing::Test {
+  public:
+    typedef typename A::accumulator_type::value_type value_type;
+
+    aa::accumulator_set measurements;
+    std::vector<value_type> data;
+
+    AddBatchTest() : data(NPOINTS) {
+        measurements << A("single") << A("batch");
+        srand48(43);
+        double x=0;
+        for (value_type& v: data) {
+            x=0.9*x+drand48(); // correlated data, so that the binning levels differ
+            make_value(x, v);
+        }
+    }
+
+    void check() const {
+        const aa::result_set results(measurements);
+        const aa::result_wrapper& single=results["single"];
+        const aa::result_wrapper& batch=results["batch"];
+        EXPECT_EQ(single.count(), batch.count());
+        expect_near(single.mean<value_type>(), batch.mean<value_type>());
+        if (aa::has_feature<typename A::accumulator_type, aa::error_tag>::value)
+            expect_near(single.error<value_type>(), batch.error<value_type>());
+    }
+};
+
+typedef ::testing::Types<
+    aa::MeanAccumulator<double>,
+    aa::NoBinningAccumulator<double>,
+    aa::LogBinningAccumulator<double>,
+    aa::FullBinningAccumulator<double>,
+    aa::MeanAccumulator< std::vector<double> >,
+    aa::NoBinningAccumulator< std::vector<double> >,
+    aa::LogBinningAccumulator< std::vector<double> >,
+    aa::FullBinningAccumulator< std::vector<double> >
+    > test_types;
+
+TYPED_TEST_CASE(AddBatchTest, test_types);
+
+TYPED_TEST(AddBatchTest, wholeBatch) {
+    for (const auto& v: this->data) this->measurements["single"] << v;
+    this->measurements["batch"].add_batch(this->data);
+    this->check();
+}
+
+TYPED_TEST(AddBatchTest, unevenBatches) {
+    for (const auto& v: this->data) this->measurements["single"] << v;
+    // batches crossing the boundaries of the binning levels
+    const std::size_t sizes[]={ 0, 1, 2, 5, 24, 100, 127, 300 };
+    std::size_t first=0;
+    for (std::size_t n: sizes) {
+        this->measurements["batch"].add_batch(&this->data[first], n);
+        first+=n;
+    }
+    this->measurements["batch"].add_batch(&this->data[first], NPOINTS-first);
+    this->check();
+}
+
+TEST(AddBatch, convertsScalars) {
+    aa::accumulator_set measurements;
+    measurements << aa::NoBinningAccumulator<float>("float");
+    const std::vector<double> data={ 1., 2., 3., 4. };
+    measurements["float"].add_batch(data);
+    EXPECT_EQ(4u, measurements["float"].count());
+    EXPECT_EQ(2.5, measurements["float"].mean<float>());
+}
+
+TEST(AddBatch, wrongTypeThrows) {
+    aa::accumulator_set measurements;
+    measurements << aa::NoBinningAccumulator< std::vector<double> >("vector");
+    const std::vector<double> data={ 1., 2. };
+    EXPECT_THROW(measurements["vector"].add_batch(data), std::logic_error);
+}
+
+TEST(AddBatch, emptyVectorThrows) {
+    aa::accumulator_set measurements;
+    measurements << aa::NoBinningAccumulator< std::vector<double> >("vector");
+    const std::vector< std::vector<double> > data={ std::vector<double>(2, 1.), std::vector<double>() };
+    EXPECT_THROW(measurements["vector"].add_batch(data), std::runtime_error);
+    EXPECT_EQ(0u, measurements["vector"].count());
+}
+
+TEST(AddBatch, resultThrows) {
+    aa::accumulator_set measurements;
+    measurements << aa::NoBinningAccumulator<double>("scalar");
+    measurements["scalar"] << 1.;
+    const std::vector<double> data={ 1., 2. };
+    std::shared_ptr<aa::result_wrapper> res=measurements["scalar"].result();
+    EXPECT_THROW(res->get<double>().add_batch(data.data(), data.size()), std::runtime_error);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file binning_levels.cpp
+    Test the per-level error bars of the log-binning accumulator against a direct computation
+*/
+
+#include <cstdio>
+#include <cmath>
+#include <vector>
+
+#include "alps/accumulators.hpp"
+#include "gtest/gtest.h"
+
+namespace aa=alps::accumulators;
+
+namespace {
+    const std::size_t VSIZE=3;
+    const std::size_t NPOINTS=4133;
+
+    inline void make_value(double x, double& val) { val=x; }
+    inline void make_value(double x, std::vector<double>& val) {
+        val.resize(VSIZE);
+        for (std::size_t k=0; k<VSIZE; ++k) val[k]=x+k*x*x;
+    }
+
+    inline double element(double val, std::size_t) { return val; }
+    inline double element(const std::vector<double>& val, std::size_t k) { return val[k]; }
+
+    inline std::size_t value_size(double) { return 1; }
+    inline std::size_t value_size(const std::vector<double>& val) { return val.size(); }
+}
+
+template <typename T>
+class BinningLevelsTest : public ::testing::Test {
+  public:
+    typedef T value_type;
+    typedef typename aa::LogBinningAccumulator<T>::accumulator_type acc_type;
+
+    std::vector<double> data_;
+
+    BinningLevelsTest() : data_(NPOINTS) {
+        srand48(43);
+        // correlated data, so that the levels differ
+        double x=0;
+        for (double& d: data_) {
+            x=0.9*x+drand48();
+            d=x;
+        }
+    }
+
+    void fill(acc_type& acc, std::size_t from, std::size_t to) const {
+        T val;
+        for (std::size_t i=from; i<to; ++i) {
+            make_value(data_[i], val);
+            acc(val);
+        }
+    }
+
+    /// Error bar of element k from bins of size 2^level, computed directly
+    double expected_error(std::size_t level, std::size_t k) const {
+        const std::size_t binlen=1ul<<level;
+        const std::size_t nbins=NPOINTS/binlen;
+        double sum=0, sum2=0;
+        T val;
+        for (std::size_t b=0; b<nbins; ++b) {
+            double bin=0;
+            for (std::size_t i=b*binlen; i<(b+1)*binlen; ++i) {
+                make_value(data_[i], val);
+                bin+=element(val, k);
+            }
+            sum+=bin;
+            sum2+=bin*bin;
+        }
+        const double n=nbins*double(binlen);
+        const double var=(sum2/binlen-sum*sum/n)/n;
+        return std::sqrt(var/(nbins-1.));
+    }
+
+    void check_levels(const acc_type& acc) const {
+        ASSERT_EQ(NPOINTS, acc.count());
+        for (std::size_t level=0; level<acc.binning_depth(); ++level) {
+            const T err=acc.error(level);
+            for (std::size_t k=0; k<value_size(err); ++k) {
+                const double expected=expected_error(level, k);
+                EXPECT_NEAR(expected, element(err, k), 1E-10*expected)
+                    << "level=" << level << " element=" << k;
+            }
+        }
+    }
+};
+
+typedef ::testing::Types<double, std::vector<double> > test_types;
+TYPED_TEST_CASE(BinningLevelsTest, test_types);
+
+TYPED_TEST(BinningLevelsTest, levels) {
+    typename TestFixture::acc_type acc;
+    this->fill(acc, 0, NPOINTS);
+    ASSERT_GT(acc.binning_depth(), 4u);
+    this->check_levels(acc);
+}
+
+TYPED_TEST(BinningLevelsTest, saveLoadMidway) {
+    const std::string fname="binning_levels.h5";
+    const std::size_t half=NPOINTS/2+5;
+    {
+        typename TestFixture::acc_type acc;
+        this->fill(acc, 0, half);
+        std::remove(fname.c_str());
+        alps::hdf5::archive ar(fname, "w");
+        ar["acc"] << acc;
+    }
+    typename TestFixture::acc_type acc;
+    {
+        alps::hdf5::archive ar(fname, "r");
+        ar["acc"] >> acc;
+    }
+    std::remove(fname.c_str());
+    this->fill(acc, half, NPOINTS);
+    this->check_levels(acc);
+}
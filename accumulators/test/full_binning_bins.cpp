@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file full_binning_bins.cpp
+    Test the bins of the full-binning accumulator, which are compacted in place, against a direct computation
+*/
+
+#include <cstdio>
+#include <cmath>
+#include <vector>
+
+#include "alps/accumulators.hpp"
+#include "gtest/gtest.h"
+
+namespace aa=alps::accumulators;
+
+namespace {
+    const std::size_t VSIZE=3;
+    const std::size_t MAXBINS=16;
+
+    inline void make_value(double x, double& val) { val=x; }
+    inline void make_value(double x, std::vector<double>& val) {
+        val.resize(VSIZE);
+        for (std::size_t k=0; k<VSIZE; ++k) val[k]=x+k*x*x;
+    }
+
+    inline double element(double val, std::size_t) { return val; }
+    inline double element(const std::vector<double>& val, std::size_t k) { return val[k]; }
+
+    inline std::size_t value_size(double) { return 1; }
+    inline std::size_t value_size(const std::vector<double>& val) { return val.size(); }
+}
+
+template <typename T>
+class FullBinningBinsTest : public ::testing::Test {
+  public:
+    typedef typename aa::FullBinningAccumulator<T>::accumulator_type acc_type;
+
+    std::vector<double> data_;
+
+    FullBinningBinsTest() {
+        srand48(7);
+        for (std::size_t i=0; i<5000; ++i) data_.push_back(drand48());
+    }
+
+    void fill(acc_type& acc, std::size_t from, std::size_t to) const {
+        T val;
+        for (std::size_t i=from; i<to; ++i) {
+            make_value(data_[i], val);
+            acc(val);
+        }
+    }
+
+    /// The bins are the averages of consecutive blocks of the first `npoints` values
+    void check_bins(const acc_type& acc, std::size_t npoints) const {
+        const std::vector<T> bins=acc.max_num_binning().bins();
+        const std::size_t binlen=acc.max_num_binning().num_elements();
+        ASSERT_LE(bins.size(), MAXBINS);
+        ASSERT_EQ(npoints/binlen, bins.size()) << "binlen=" << binlen;
+        T val;
+        make_value(0., val);
+        for (std::size_t b=0; b<bins.size(); ++b) {
+            ASSERT_EQ(value_size(val), value_size(bins[b]));
+            for (std::size_t k=0; k<value_size(bins[b]); ++k) {
+                double expected=0;
+                for (std::size_t i=b*binlen; i<(b+1)*binlen; ++i) {
+                    make_value(data_[i], val);
+                    expected+=element(val, k);
+                }
+                expected/=binlen;
+                EXPECT_NEAR(expected, element(bins[b], k), 1E-12) << "bin=" << b << " element=" << k;
+            }
+        }
+    }
+};
+
+typedef ::testing::Types<double, std::vector<double> > test_types;
+TYPED_TEST_CASE(FullBinningBinsTest, test_types);
+
+TYPED_TEST(FullBinningBinsTest, compaction) {
+    typename TestFixture::acc_type acc(aa::max_bin_number=MAXBINS);
+    // before and after several compactions
+    const std::size_t npoints[]={ 5, MAXBINS, MAXBINS+1, 2*MAXBINS+2, 1000, 4099 };
+    std::size_t done=0;
+    for (std::size_t n: npoints) {
+        this->fill(acc, done, n);
+        done=n;
+        this->check_bins(acc, n);
+    }
+}
+
+TYPED_TEST(FullBinningBinsTest, saveLoadMidway) {
+    const std::string fname="full_binning_bins.h5";
+    const std::size_t half=1237;
+    {
+        typename TestFixture::acc_type acc(aa::max_bin_number=MAXBINS);
+        this->fill(acc, 0, half);
+        std::remove(fname.c_str());
+        alps::hdf5::archive ar(fname, "w");
+        ar["acc"] << acc;
+    }
+    typename TestFixture::acc_type acc;
+    {
+        alps::hdf5::archive ar(fname, "r");
+        ar["acc"] >> acc;
+    }
+    std::remove(fname.c_str());
+    this->fill(acc, half, 4099);
+    this->check_bins(acc, 4099);
+}
+
+TYPED_TEST(FullBinningBinsTest, mergeUnevenFill) {
+    // the merged partial bins hold more elements than a bin
+    const std::size_t n1=7, npoints=41;
+    typename TestFixture::acc_type acc(aa::max_bin_number=MAXBINS);
+    typename TestFixture::acc_type other(aa::max_bin_number=MAXBINS);
+    typename TestFixture::acc_type all(aa::max_bin_number=MAXBINS);
+    this->fill(acc, 0, n1);
+    this->fill(other, n1, npoints);
+    this->fill(all, 0, npoints);
+    acc.merge(other);
+    EXPECT_EQ(all.count(), acc.count());
+
+    const std::vector<TypeParam> bins=acc.max_num_binning().bins();
+    const std::size_t binlen=acc.max_num_binning().num_elements();
+    ASSERT_EQ(all.max_num_binning().bins().size(), bins.size());
+    ASSERT_EQ(all.max_num_binning().num_elements(), binlen);
+
+    // the partial bin is only accessible from the archive
+    const std::string fname="full_binning_bins_merge.h5";
+    std::remove(fname.c_str());
+    TypeParam partial;
+    std::size_t npartial, npartial_all;
+    {
+        alps::hdf5::archive ar(fname, "w");
+        ar["acc"] << acc;
+        ar["all"] << all;
+        ar["acc/timeseries/partialbin"] >> partial;
+        ar["acc/timeseries/partialbin/@count"] >> npartial;
+        ar["all/timeseries/partialbin/@count"] >> npartial_all;
+    }
+    std::remove(fname.c_str());
+    EXPECT_EQ(npartial_all, npartial);
+
+    // each bin holds `binlen` elements: the bins and the partial bin add up to the sum of all data
+    TypeParam val;
+    make_value(0., val);
+    for (std::size_t k=0; k<value_size(val); ++k) {
+        double expected=0, sum=element(partial, k);
+        for (std::size_t i=0; i<npoints; ++i) {
+            make_value(this->data_[i], val);
+            expected+=element(val, k);
+        }
+        for (std::size_t b=0; b<bins.size(); ++b)
+            sum+=element(bins[b], k)*binlen;
+        EXPECT_NEAR(expected, sum, 1E-10) << "element=" << k;
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file lazy_result_set.cpp: Tests for loading results from an archive on access */
+
+#include "alps/accumulators.hpp"
+#include "alps/accumulators/lazy_result_set.hpp"
+#include "alps/hdf5.hpp"
+#include "alps/testing/unique_file.hpp"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+namespace aa=alps::accumulators;
+
+class LazyResultSetTest : public ::testing::Test {
+  public:
+    alps::testing::unique_file h5_tmp_file;
+    std::shared_ptr<aa::result_set> results_ptr;
+
+    LazyResultSetTest() : h5_tmp_file("lazy_result_set.h5.", alps::testing::unique_file::REMOVE_AFTER) {
+        aa::accumulator_set measurements;
+        measurements << aa::FullBinningAccumulator<double>("full")
+                     << aa::NoBinningAccumulator<std::vector<double> >("vector")
+                     << aa::MeanAccumulator<double>("mean");
+        for (int i=0; i<1000; ++i) {
+            const double x=std::sin(0.1*i);
+            measurements["full"] << x;
+            measurements["vector"] << std::vector<double>(3, x*x);
+            measurements["mean"] << 2*x;
+        }
+        results_ptr.reset(new aa::result_set(measurements));
+
+        alps::hdf5::archive ar(h5_tmp_file.name(), "w");
+        ar["/simulation/results"] << *results_ptr;
+    }
+};
+
+TEST_F(LazyResultSetTest, LoadOnAccess) {
+    alps::hdf5::archive ar(h5_tmp_file.name(), "r");
+    const aa::result_set& results=*results_ptr;
+    const std::string context=ar.get_context();
+    aa::lazy_result_set lazy(ar, "/simulation/results");
+    ASSERT_EQ(3u, lazy.size());
+    EXPECT_TRUE(lazy.has("full"));
+    EXPECT_FALSE(lazy.has("none"));
+    EXPECT_FALSE(lazy.loaded("full"));
+
+    const aa::result_wrapper& full=lazy["full"];
+    EXPECT_TRUE(lazy.loaded("full"));
+    EXPECT_FALSE(lazy.loaded("vector"));
+    EXPECT_FALSE(lazy.loaded("mean"));
+    EXPECT_EQ(&full, &lazy["full"]);
+
+    EXPECT_EQ(results["full"].count(), full.count());
+    EXPECT_NEAR(results["full"].mean<double>(), full.mean<double>(), 1E-12);
+    EXPECT_NEAR(results["full"].error<double>(), full.error<double>(), 1E-12);
+    EXPECT_NO_THROW(full.extract<aa::FullBinningAccumulator<double>::result_type>());
+
+    std::vector<double> expected=results["vector"].mean<std::vector<double> >();
+    std::vector<double> actual=lazy["vector"].mean<std::vector<double> >();
+    ASSERT_EQ(expected.size(), actual.size());
+    for (std::size_t i=0; i<expected.size(); ++i)
+        EXPECT_NEAR(expected[i], actual[i], 1E-12);
+
+    EXPECT_THROW(lazy["none"], std::out_of_range);
+    // the context of the archive is unchanged
+    EXPECT_EQ(context, ar.get_context());
+}
+
+TEST_F(LazyResultSetTest, NoBins) {
+    alps::hdf5::archive ar(h5_tmp_file.name(), "r");
+    const aa::result_set& results=*results_ptr;
+    aa::lazy_result_set lazy(ar, "/simulation/results", false);
+
+    const aa::result_wrapper& full=lazy["full"];
+    EXPECT_EQ(results["full"].count(), full.count());
+    EXPECT_NEAR(results["full"].mean<double>(), full.mean<double>(), 1E-12);
+    EXPECT_NO_THROW(full.extract<aa::NoBinningAccumulator<double>::result_type>());
+    EXPECT_ANY_THROW(full.extract<aa::FullBinningAccumulator<double>::result_type>());
+
+    // results of lower rank are loaded as they are
+    EXPECT_NO_THROW(lazy["mean"].extract<aa::MeanAccumulator<double>::result_type>());
+}
+
+TEST_F(LazyResultSetTest, LoadAll) {
+    alps::hdf5::archive ar(h5_tmp_file.name(), "r");
+    const aa::result_set& results=*results_ptr;
+    aa::lazy_result_set lazy(ar, "/simulation/results");
+    aa::result_set loaded;
+    lazy.load(loaded);
+    EXPECT_EQ(3u, loaded.size());
+    EXPECT_NEAR(results["mean"].mean<double>(), loaded["mean"].mean<double>(), 1E-12);
+}
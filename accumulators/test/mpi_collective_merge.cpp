@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** Test the batched, non-blocking merge of accumulator sets against the merge of each accumulator */
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "alps/utilities/mpi.hpp"
+
+#include "alps/config.hpp"
+#include "alps/accumulators.hpp"
+#include "alps/accumulators/collective_merge.hpp"
+
+#include "alps/utilities/gtest_par_xml_output.hpp"
+#include "gtest/gtest.h"
+
+namespace aa=alps::accumulators;
+
+namespace {
+    const std::size_t VECSIZE=3;
+
+    // different number of samples on each rank, so that the binning differs
+    std::size_t nsamples(int rank) { return 1000+537*rank; }
+
+    double data(int rank, std::size_t i) { return std::sin(0.1*i+rank)+0.01*rank; }
+
+    void make_set(aa::accumulator_set& measurements) {
+        measurements << aa::MeanAccumulator<double>("mean")
+                     << aa::NoBinningAccumulator<double>("nobin")
+                     << aa::LogBinningAccumulator<double>("logbin")
+                     << aa::FullBinningAccumulator<double>("fullbin", aa::max_bin_number=32)
+                     << aa::LogBinningAccumulator<float>("logbin_float")
+                     << aa::FullBinningAccumulator< std::vector<double> >("fullbin_vec", aa::max_bin_number=16)
+                     << aa::NoBinningAccumulator< std::vector<long double> >("nobin_vec_ld")
+                     << aa::NoBinningAccumulator<double>("unmeasured");
+    }
+
+    void fill(aa::accumulator_set& measurements, int rank) {
+        for (std::size_t i=0; i<nsamples(rank); ++i) {
+            const double x=data(rank, i);
+            measurements["mean"] << x;
+            measurements["nobin"] << x;
+            measurements["logbin"] << x;
+            measurements["fullbin"] << x;
+            measurements["logbin_float"] << float(x);
+            measurements["fullbin_vec"] << std::vector<double>(VECSIZE, x);
+            measurements["nobin_vec_ld"] << std::vector<long double>(VECSIZE, x);
+        }
+    }
+
+    template <typename T>
+    void expect_near(const T& expected, const T& actual, const std::string& name) {
+        // the sums may be reduced in a different order
+        const double tol=100*std::numeric_limits<T>::epsilon()*(1+std::fabs(expected));
+        EXPECT_NEAR(expected, actual, tol) << name;
+    }
+    template <typename T>
+    void expect_near(const std::vector<T>& expected, const std::vector<T>& actual, const std::string& name) {
+        ASSERT_EQ(expected.size(), actual.size()) << name;
+        for (std::size_t i=0; i<expected.size(); ++i) expect_near(expected[i], actual[i], name);
+    }
+
+    template <typename T>
+    void expect_same(const aa::result_set& expected, const aa::result_set& actual, const std::string& name, bool has_error) {
+        EXPECT_EQ(expected[name].count(), actual[name].count()) << name;
+        expect_near(expected[name].mean<T>(), actual[name].mean<T>(), name);
+        if (has_error) expect_near(expected[name].error<T>(), actual[name].error<T>(), name);
+    }
+}
+
+TEST(CollectiveMerge, sameAsSingleMerges) {
+    alps::mpi::communicator comm;
+    const int root=0;
+    aa::accumulator_set single, batched;
+    make_set(single);
+    make_set(batched);
+    fill(single, comm.rank());
+    fill(batched, comm.rank());
+
+    for (aa::accumulator_set::iterator it=single.begin(); it!=single.end(); ++it) {
+        if (it->first!="unmeasured") it->second->collective_merge(comm, root);
+    }
+    aa::collective_merge(batched, comm, root);
+
+    if (comm.rank()!=root) {
+        for (aa::accumulator_set::iterator it=batched.begin(); it!=batched.end(); ++it) {
+            EXPECT_EQ(0u, it->second->count()) << it->first << " is reset on the non-root ranks";
+        }
+        return;
+    }
+
+    std::size_t ntot=0;
+    for (int r=0; r<comm.size(); ++r) ntot+=nsamples(r);
+    EXPECT_EQ(ntot, batched["fullbin"].count());
+    EXPECT_EQ(0u, batched["unmeasured"].count());
+
+    const aa::result_set expected(single);
+    const aa::result_set actual(batched);
+    expect_same<double>(expected, actual, "mean", false);
+    expect_same<double>(expected, actual, "nobin", true);
+    expect_same<double>(expected, actual, "logbin", true);
+    expect_same<double>(expected, actual, "fullbin", true);
+    expect_same<float>(expected, actual, "logbin_float", true);
+    expect_same< std::vector<double> >(expected, actual, "fullbin_vec", true);
+    expect_same< std::vector<long double> >(expected, actual, "nobin_vec_ld", true);
+
+    typedef aa::FullBinningAccumulator<double>::accumulator_type fullbin_type;
+    const std::vector<double> expected_bins=single["fullbin"].extract<fullbin_type>().max_num_binning().bins();
+    const std::vector<double> actual_bins=batched["fullbin"].extract<fullbin_type>().max_num_binning().bins();
+    expect_near(expected_bins, actual_bins, "fullbin bins");
+}
+
+TEST(CollectiveMerge, hierarchical) {
+    alps::mpi::communicator comm;
+    const int root=comm.size()/2;
+    aa::accumulator_set flat, hierarchical;
+    make_set(flat);
+    make_set(hierarchical);
+    fill(flat, comm.rank());
+    fill(hierarchical, comm.rank());
+
+    aa::collective_merge(flat, comm, root);
+    aa::collective_merge_async(hierarchical, comm, root, true).wait();
+    if (comm.rank()!=root) {
+        EXPECT_EQ(0u, hierarchical["fullbin"].count());
+        return;
+    }
+
+    const aa::result_set expected(flat);
+    const aa::result_set actual(hierarchical);
+    expect_same<double>(expected, actual, "mean", false);
+    expect_same<double>(expected, actual, "logbin", true);
+    expect_same<double>(expected, actual, "fullbin", true);
+    expect_same< std::vector<double> >(expected, actual, "fullbin_vec", true);
+    expect_same< std::vector<long double> >(expected, actual, "nobin_vec_ld", true);
+    EXPECT_EQ(0u, hierarchical["unmeasured"].count());
+}
+
+TEST(CollectiveMerge, reusedTopology) {
+    alps::mpi::communicator comm;
+    const int root=comm.size()-1;
+    const std::shared_ptr<const aa::merge_topology> topology=std::make_shared<const aa::merge_topology>(comm, root);
+    for (int repeat=0; repeat<2; ++repeat) {
+        aa::accumulator_set flat, hierarchical;
+        make_set(flat);
+        make_set(hierarchical);
+        fill(flat, comm.rank());
+        fill(hierarchical, comm.rank());
+        aa::collective_merge_request::accumulators_type accs;
+        for (aa::accumulator_set::iterator it=hierarchical.begin(); it!=hierarchical.end(); ++it)
+            accs.push_back(*it);
+
+        aa::collective_merge(flat, comm, root);
+        aa::collective_merge_request(accs, topology).wait();
+        if (comm.rank()!=root) {
+            EXPECT_EQ(0u, hierarchical["fullbin"].count());
+            continue;
+        }
+
+        const aa::result_set expected(flat);
+        const aa::result_set actual(hierarchical);
+        expect_same<double>(expected, actual, "logbin", true);
+        expect_same<double>(expected, actual, "fullbin", true);
+    }
+}
+
+TEST(CollectiveMerge, hierarchicalWrapper) {
+    alps::mpi::communicator comm;
+    const int root=0;
+    aa::accumulator_set single, hierarchical;
+    make_set(single);
+    make_set(hierarchical);
+    fill(single, comm.rank());
+    fill(hierarchical, comm.rank());
+
+    single["fullbin"].collective_merge(comm, root);
+    hierarchical["fullbin"].collective_merge(comm, root, true);
+    if (comm.rank()!=root) {
+        EXPECT_EQ(0u, hierarchical["fullbin"].count());
+        return;
+    }
+
+    const aa::result_set expected(single);
+    const aa::result_set actual(hierarchical);
+    expect_same<double>(expected, actual, "fullbin", true);
+}
+
+TEST(CollectiveMerge, nonBlocking) {
+    alps::mpi::communicator comm;
+    const int root=comm.size()-1;
+    aa::accumulator_set measurements;
+    make_set(measurements);
+    fill(measurements, comm.rank());
+    const std::vector<std::string> names={ "nobin", "fullbin" };
+
+    aa::collective_merge_request request=aa::collective_merge_async(measurements, names, comm, root);
+    while (!request.test()) {}
+    EXPECT_TRUE(request.test());
+
+    std::size_t ntot=0;
+    for (int r=0; r<comm.size(); ++r) ntot+=nsamples(r);
+    if (comm.rank()==root) {
+        EXPECT_EQ(ntot, measurements["nobin"].count());
+        EXPECT_EQ(ntot, measurements["fullbin"].count());
+        // not in the list of names
+        EXPECT_EQ(nsamples(comm.rank()), measurements["logbin"].count());
+    }
+}
+
+TEST(CollectiveMerge, partiallyMeasuredThrows) {
+    alps::mpi::communicator comm;
+    if (comm.size()<2) return;
+    aa::accumulator_set measurements;
+    measurements << aa::NoBinningAccumulator<double>("partial");
+    if (comm.rank()==1) measurements["partial"] << 1.;
+    EXPECT_THROW(aa::collective_merge(measurements, comm, 0), std::runtime_error);
+}
+
+int main(int argc, char** argv)
+{
+   alps::mpi::environment env(argc, argv);
+   alps::gtest_par_xml_output tweak;
+   tweak(alps::mpi::communicator().rank(), argc, argv);
+   ::testing::InitGoogleTest(&argc, argv);
+   return RUN_ALL_TESTS();
+}
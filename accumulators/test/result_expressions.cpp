@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file result_expressions.cpp
+    Test expressions of full binning results against a jackknife analysis by hand
+*/
+
+#include <cmath>
+#include <vector>
+
+#include <alps/config.hpp>
+#include <alps/accumulators.hpp>
+#include "gtest/gtest.h"
+
+namespace aa=alps::accumulators;
+
+class ResultExpressionsTest : public ::testing::Test {
+  public:
+    typedef aa::FullBinningAccumulator<double>::result_type raw_result_type;
+
+    aa::accumulator_set measurements;
+    aa::result_set results;
+
+    ResultExpressionsTest() {
+        measurements << aa::FullBinningAccumulator<double>("mag2", aa::max_bin_number=64)
+                     << aa::FullBinningAccumulator<double>("mag4", aa::max_bin_number=64);
+        srand48(17);
+        for (int i=0; i<10000; ++i) {
+            const double m=drand48()-0.3;
+            measurements["mag2"] << m*m;
+            measurements["mag4"] << m*m*m*m;
+        }
+        results=aa::result_set(measurements);
+    }
+
+    std::vector<double> bins(const std::string& name) const {
+        return results[name].extract<raw_result_type>().max_num_binning().bins();
+    }
+
+    /// Jackknife estimates of the mean and the error of f(mag2, mag4)
+    template <typename F>
+    void jackknife(F f, double& mean, double& error) const {
+        const std::vector<double> b2=bins("mag2"), b4=bins("mag4");
+        const std::size_t n=b2.size();
+        double s2=0, s4=0;
+        for (std::size_t i=0; i<n; ++i) { s2+=b2[i]; s4+=b4[i]; }
+        std::vector<double> jk(n);
+        double jk_mean=0;
+        for (std::size_t i=0; i<n; ++i) {
+            jk[i]=f((s2-b2[i])/(n-1), (s4-b4[i])/(n-1));
+            jk_mean+=jk[i]/n;
+        }
+        const double all=f(s2/n, s4/n);
+        mean=all-(jk_mean-all)*(n-1);
+        error=0;
+        for (std::size_t i=0; i<n; ++i) error+=(jk[i]-jk_mean)*(jk[i]-jk_mean);
+        error=std::sqrt(error/n*(n-1));
+    }
+};
+
+double binder(double mag2, double mag4) { return 1-mag4/(3*mag2*mag2); }
+
+TEST_F(ResultExpressionsTest, binderCumulant) {
+    const double mag2_mean=results["mag2"].mean<double>();
+    const double mag4_mean=results["mag4"].mean<double>();
+
+    const aa::result_wrapper res=1-results["mag4"]/(3*results["mag2"]*results["mag2"]);
+
+    double mean, error;
+    jackknife(binder, mean, error);
+    EXPECT_NEAR(mean, res.mean<double>(), 1e-12);
+    EXPECT_NEAR(error, res.error<double>(), 1e-12);
+
+    // the operands are not modified
+    EXPECT_EQ(mag2_mean, results["mag2"].mean<double>());
+    EXPECT_EQ(mag4_mean, results["mag4"].mean<double>());
+}
+
+double sqrt_ratio(double mag2, double mag4) { return std::sqrt(mag4)/mag2; }
+
+TEST_F(ResultExpressionsTest, functionsOfTemporaries) {
+    const aa::result_wrapper& mag2=results["mag2"];
+    const aa::result_wrapper res=sqrt(results["mag4"]*1.)/mag2;
+
+    double mean, error;
+    jackknife(sqrt_ratio, mean, error);
+    EXPECT_NEAR(mean, res.mean<double>(), 1e-12);
+    EXPECT_NEAR(error, res.error<double>(), 1e-12);
+}
+
+TEST_F(ResultExpressionsTest, sameAsStepByStep) {
+    aa::result_wrapper step=results["mag2"]*results["mag2"];
+    step*=3;
+    step=results["mag4"]/step;
+    step=-step;
+    step+=1;
+
+    const aa::result_wrapper res=1-results["mag4"]/(3*results["mag2"]*results["mag2"]);
+    EXPECT_NEAR(step.mean<double>(), res.mean<double>(), 1e-14);
+    EXPECT_NEAR(step.error<double>(), res.error<double>(), 1e-14);
+}
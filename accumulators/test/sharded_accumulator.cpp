@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file sharded_accumulator.cpp
+    Test accumulators fed by several threads through per-thread shards
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "alps/accumulators.hpp"
+#include "alps/accumulators/sharded_accumulator.hpp"
+#include "gtest/gtest.h"
+
+namespace aa=alps::accumulators;
+
+namespace {
+    const std::size_t NTHREADS=4;
+    const std::size_t NPOINTS=5000; // per thread
+
+    inline double data(std::size_t thread, std::size_t i) {
+        return std::sin(0.01*i+thread)+0.5*std::cos(0.3*i*(thread+1));
+    }
+}
+
+/// Google Test Fixture: A is a named accumulator type
+template <typename A>
+class ShardedAccumulatorTest : public ::testing::Test {
+  public:
+    typedef aa::sharded_accumulator<A> sharded_type;
+
+    sharded_type sharded;
+    typename A::accumulator_type reference;
+
+    ShardedAccumulatorTest() : sharded(A("data"), NTHREADS) {}
+
+    void fill() {
+        std::vector<std::thread> threads;
+        for (std::size_t t=0; t<NTHREADS; ++t) {
+            threads.push_back(std::thread([this, t]() {
+                typename A::accumulator_type& acc=sharded.shard(t);
+                for (std::size_t i=0; i<NPOINTS; ++i) acc(data(t, i));
+            }));
+        }
+        for (std::thread& th: threads) th.join();
+        for (std::size_t t=0; t<NTHREADS; ++t)
+            for (std::size_t i=0; i<NPOINTS; ++i) reference(data(t, i));
+    }
+};
+
+typedef ::testing::Types<
+    aa::MeanAccumulator<double>,
+    aa::NoBinningAccumulator<double>,
+    aa::LogBinningAccumulator<double>,
+    aa::FullBinningAccumulator<double>
+    > test_types;
+
+TYPED_TEST_CASE(ShardedAccumulatorTest, test_types);
+
+TYPED_TEST(ShardedAccumulatorTest, shardsAreCacheAligned) {
+    ASSERT_EQ(NTHREADS, this->sharded.size());
+    for (std::size_t t=0; t<NTHREADS; ++t) {
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(&this->sharded.shard(t)) % aa::detail::cache_line_size);
+    }
+}
+
+TYPED_TEST(ShardedAccumulatorTest, merged) {
+    this->fill();
+    EXPECT_EQ(NTHREADS*NPOINTS, this->sharded.count());
+    const typename TypeParam::result_type res=this->sharded.result();
+    EXPECT_EQ(this->reference.count(), res.count());
+    EXPECT_NEAR(this->reference.mean(), res.mean(), 1E-12);
+
+    aa::accumulator_set measurements;
+    measurements << TypeParam("data");
+    measurements["data"].merge(aa::accumulator_wrapper(this->sharded.merged()));
+    EXPECT_EQ(NTHREADS*NPOINTS, measurements["data"].count());
+}
+
+TEST(ShardedAccumulator, fullBinningBins) {
+    typedef aa::FullBinningAccumulator<double> named_type;
+    aa::sharded_accumulator<named_type> sharded(named_type("data", aa::max_bin_number=16), 3);
+    // shards with different numbers of measurements, thus different bin sizes
+    const std::size_t npoints[]={ 100, 1000, 37 };
+    double sum=0;
+    std::size_t count=0;
+    for (std::size_t t=0; t<3; ++t) {
+        for (std::size_t i=0; i<npoints[t]; ++i) {
+            sharded.shard(t)(data(t, i));
+            sum+=data(t, i);
+            ++count;
+        }
+    }
+    const named_type::accumulator_type merged=sharded.merged();
+    EXPECT_EQ(count, merged.count());
+    EXPECT_NEAR(sum/count, merged.mean(), 1E-12);
+
+    const aa::max_num_binning_type<named_type::accumulator_type>::type bins=merged.max_num_binning();
+    EXPECT_LE(bins.bins().size(), 16u);
+    EXPECT_GE(bins.bins().size(), 8u);
+    // the bins (of equal size) cover all measurements except the ones in the partial bin
+    EXPECT_LE(bins.bins().size()*bins.num_elements(), count);
+    EXPECT_GT((bins.bins().size()+1)*bins.num_elements(), count-bins.num_elements());
+
+    // the result can be computed from the merged bins
+    const named_type::result_type res(merged);
+    EXPECT_NEAR(sum/count, res.mean(), 1E-12);
+    EXPECT_TRUE(std::isfinite(res.error()));
+}
+
+TEST(ShardedAccumulator, zeroShardsThrows) {
+    typedef aa::NoBinningAccumulator<double> named_type;
+    EXPECT_THROW(aa::sharded_accumulator<named_type>(named_type("data"), 0), std::invalid_argument);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file static_accumulator_set.cpp
+    Test the compile-time typed accumulator set against accumulator_set
+*/
+
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#include "alps/accumulators.hpp"
+#include "alps/accumulators/static_accumulator_set.hpp"
+#include "gtest/gtest.h"
+
+namespace aa=alps::accumulators;
+
+namespace {
+    typedef aa::static_accumulator_set<
+        aa::FullBinningAccumulator<double>,
+        aa::LogBinningAccumulator<double>,
+        aa::MeanAccumulator< std::vector<double> >
+        > static_set_type;
+
+    enum { ENERGY, MAGNETIZATION, CORRELATIONS };
+
+    const std::size_t NPOINTS=1000;
+
+    static_set_type make_static_set() {
+        return static_set_type(aa::FullBinningAccumulator<double>("Energy", aa::max_bin_number=20),
+                               aa::LogBinningAccumulator<double>("Magnetization"),
+                               aa::MeanAccumulator< std::vector<double> >("Correlations"));
+    }
+
+    void make_dynamic_set(aa::accumulator_set& measurements) {
+        measurements << aa::FullBinningAccumulator<double>("Energy", aa::max_bin_number=20)
+                     << aa::LogBinningAccumulator<double>("Magnetization")
+                     << aa::MeanAccumulator< std::vector<double> >("Correlations");
+    }
+
+    void fill(static_set_type& sset, std::size_t from, std::size_t to) {
+        for (std::size_t i=from; i<to; ++i) {
+            const double x=std::sin(0.1*i);
+            sset.measure<ENERGY>(x);
+            sset.measure<MAGNETIZATION>(x*x);
+            sset.get<CORRELATIONS>()(std::vector<double>(3, x));
+        }
+    }
+
+    void fill(aa::accumulator_set& dset, std::size_t from, std::size_t to) {
+        for (std::size_t i=from; i<to; ++i) {
+            const double x=std::sin(0.1*i);
+            dset["Energy"] << x;
+            dset["Magnetization"] << x*x;
+            dset["Correlations"] << std::vector<double>(3, x);
+        }
+    }
+
+    void expect_same(const aa::result_set& expected, const aa::result_set& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        EXPECT_EQ(expected["Energy"].count(), actual["Energy"].count());
+        EXPECT_NEAR(expected["Energy"].mean<double>(), actual["Energy"].mean<double>(), 1E-12);
+        EXPECT_NEAR(expected["Energy"].error<double>(), actual["Energy"].error<double>(), 1E-12);
+        EXPECT_NEAR(expected["Magnetization"].mean<double>(), actual["Magnetization"].mean<double>(), 1E-12);
+        EXPECT_NEAR(expected["Magnetization"].error<double>(), actual["Magnetization"].error<double>(), 1E-12);
+        const std::vector<double> expected_corr=expected["Correlations"].mean< std::vector<double> >();
+        const std::vector<double> actual_corr=actual["Correlations"].mean< std::vector<double> >();
+        ASSERT_EQ(expected_corr.size(), actual_corr.size());
+        for (std::size_t k=0; k<expected_corr.size(); ++k)
+            EXPECT_NEAR(expected_corr[k], actual_corr[k], 1E-12);
+    }
+
+    void expect_same(const aa::result_set& expected, const static_set_type& sset) {
+        aa::result_set actual;
+        sset.results(actual);
+        expect_same(expected, actual);
+    }
+}
+
+TEST(StaticAccumulatorSet, names) {
+    const static_set_type sset=make_static_set();
+    EXPECT_EQ(3u, static_set_type::size());
+    EXPECT_EQ("Magnetization", sset.name(MAGNETIZATION));
+    EXPECT_EQ(std::size_t(CORRELATIONS), sset.index("Correlations"));
+    EXPECT_THROW(sset.index("nonexistent"), std::out_of_range);
+    EXPECT_EQ(20u, sset.get<ENERGY>().max_num_binning().max_number());
+}
+
+TEST(StaticAccumulatorSet, sameAsDynamic) {
+    static_set_type sset=make_static_set();
+    aa::accumulator_set dset;
+    make_dynamic_set(dset);
+    fill(sset, 0, NPOINTS);
+    fill(dset, 0, NPOINTS);
+    expect_same(aa::result_set(dset), sset);
+
+    std::ostringstream out;
+    out << sset;
+    EXPECT_NE(std::string::npos, out.str().find("Magnetization: "));
+}
+
+TEST(StaticAccumulatorSet, merge) {
+    typedef aa::static_accumulator_set< aa::FullBinningAccumulator<double>, aa::MeanAccumulator<double> > set_type;
+    set_type sset1(aa::FullBinningAccumulator<double>("Magnetization", aa::max_bin_number=20), aa::MeanAccumulator<double>("Sign"));
+    set_type sset2(sset1);
+    aa::accumulator_set dset;
+    make_dynamic_set(dset);
+    for (std::size_t i=0; i<NPOINTS; ++i) {
+        const double x=std::sin(0.1*i);
+        set_type& sset=(i<NPOINTS/2)? sset1 : sset2;
+        sset.measure<0>(x*x);
+        sset.measure<1>(1.);
+        dset["Magnetization"] << x*x;
+    }
+    sset1.merge(sset2);
+    const aa::result_set results(dset);
+    EXPECT_EQ(NPOINTS, sset1.get<0>().count());
+    EXPECT_NEAR(results["Magnetization"].mean<double>(), sset1.get<0>().mean(), 1E-12);
+    EXPECT_LE(sset1.get<0>().max_num_binning().bins().size(), 20u);
+    EXPECT_EQ(1., sset1.get<1>().mean());
+}
+
+TEST(StaticAccumulatorSet, saveStaticLoadDynamic) {
+    const std::string fname="static_accumulator_set_1.h5";
+    static_set_type sset=make_static_set();
+    fill(sset, 0, NPOINTS);
+    {
+        alps::hdf5::archive ar(fname, "w");
+        ar["measurements"] << sset;
+    }
+    aa::accumulator_set dset;
+    {
+        alps::hdf5::archive ar(fname, "r");
+        ar["measurements"] >> dset;
+    }
+    std::remove(fname.c_str());
+    expect_same(aa::result_set(dset), sset);
+}
+
+TEST(StaticAccumulatorSet, saveDynamicLoadStatic) {
+    const std::string fname="static_accumulator_set_2.h5";
+    aa::accumulator_set dset;
+    make_dynamic_set(dset);
+    fill(dset, 0, NPOINTS/2);
+    {
+        alps::hdf5::archive ar(fname, "w");
+        ar["measurements"] << dset;
+    }
+    static_set_type sset=make_static_set();
+    {
+        alps::hdf5::archive ar(fname, "r");
+        ar["measurements"] >> sset;
+    }
+    std::remove(fname.c_str());
+    // continue the simulation after the checkpoint
+    fill(dset, NPOINTS/2, NPOINTS);
+    fill(sset, NPOINTS/2, NPOINTS);
+    expect_same(aa::result_set(dset), sset);
+}
@@ -130,6 +130,7 @@
 
 // Plugins
 #include <alps/alea/hdf5.hpp>
+#include <alps/alea/binary.hpp>
 #ifdef ALPS_HAVE_MPI
     #include <alps/alea/mpi.hpp>
 #endif
@@ -187,6 +187,9 @@ public:
     /** Collect measurements from different instances using sum-reducer */
     void reduce(const reducer &r) { reduce(r, true, true); }
 
+    /** Perform the phases of `reduce()` before and/or after the commit */
+    void reduce(const reducer &r, bool do_pre_commit, bool do_post_commit);
+
     /** Convert result to a permanent format (write to disk etc.) */
     friend void serialize<>(serializer &, const std::string &, const autocorr_result &);
 
@@ -206,9 +209,6 @@ public:
 
     level_result_type &level(size_t i) { return level_[i]; }
 
-protected:
-    void reduce(const reducer &r, bool do_pre_commit, bool do_post_commit);
-
 private:
     const static size_t DEFAULT_MIN_SAMPLES = 1024;
     std::vector<level_result_type> level_;
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+
+#include <alps/alea/core.hpp>
+
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace alps { namespace alea { namespace internal {
+
+/** Type codes of the primitives in a binary container */
+template <typename T> struct binary_type;
+
+template <> struct binary_type<double> { static const uint32_t value = 1; };
+template <> struct binary_type<std::complex<double> > { static const uint32_t value = 2; };
+template <> struct binary_type<int64_t> { static const uint32_t value = 3; };
+template <> struct binary_type<uint64_t> { static const uint32_t value = 4; };
+template <> struct binary_type<int32_t> { static const uint32_t value = 5; };
+template <> struct binary_type<uint32_t> { static const uint32_t value = 6; };
+
+}}}
+
+namespace alps { namespace alea {
+
+/**
+ * Serializer to a compact binary container.
+ *
+ * The container is a self-describing, little-endian stream of records, which
+ * is designed to be memory-mapped and read in place by `binary_deserializer`:
+ *
+ *     header:  char magic[8] = "ALEABIN\0", uint32 version, uint32 alignment
+ *     record:  uint32 tag, uint32 type, uint32 ndim, uint32 key_size,
+ *              uint64 shape[ndim], char key[key_size],
+ *              (padding to `alignment`, data, for arrays only)
+ *
+ * where `tag` is 1 for `enter()`, 2 for `exit()` and 3 for `write()`, and
+ * `type` is given by `internal::binary_type`.  Each record starts on an
+ * 8-byte boundary, and the array data are aligned to `alignment` bytes
+ * relative to the start of the container (a cache line).  Arrays are stored
+ * row-major, as given by the `ndview`.
+ *
+ * The serializer writes to a `std::ostream`, which should be opened in binary
+ * mode, e.g., a `std::ofstream` for checkpoints or a `std::ostringstream` for
+ * shipping results to other processes.
+ */
+class binary_serializer
+    : public serializer
+{
+public:
+    /** Format version written to the header */
+    static const uint32_t version = 1;
+
+    /** Alignment of array data in bytes */
+    static const uint32_t alignment = 64;
+
+public:
+    binary_serializer(std::ostream &out);
+
+    // Common methods
+
+    void enter(const std::string &group) override;
+
+    void exit() override;
+
+    void write(const std::string &key, ndview<const double> value) override {
+        do_write(key, value);
+    }
+
+    void write(const std::string &key, ndview<const std::complex<double>> value) override {
+        do_write(key, value);
+    }
+
+    void write(const std::string &key, ndview<const int64_t> value) override {
+        do_write(key, value);
+    }
+
+    void write(const std::string &key, ndview<const uint64_t> value) override {
+        do_write(key, value);
+    }
+
+    void write(const std::string &key, ndview<const int32_t> value) override {
+        do_write(key, value);
+    }
+
+    void write(const std::string &key, ndview<const uint32_t> value) override {
+        do_write(key, value);
+    }
+
+    ~binary_serializer();
+
+protected:
+    template <typename T>
+    void do_write(const std::string &key, ndview<const T> data)
+    {
+        write_record(3, internal::binary_type<T>::value, key, data.shape(),
+                     data.ndim(), data.data(), data.size() * sizeof(T));
+    }
+
+    void write_record(uint32_t tag, uint32_t type, const std::string &key,
+                      const size_t *shape, size_t ndim, const void *data,
+                      size_t nbytes);
+
+    void write_bytes(const void *data, size_t nbytes);
+
+    void write_padding(size_t boundary);
+
+private:
+    std::ostream *out_;
+    uint64_t offset_;
+    size_t depth_;
+};
+
+/**
+ * Deserializer from a binary container written by `binary_serializer`.
+ *
+ * The container is either memory-mapped from a file or given as a buffer.
+ * On construction, only the record headers are scanned; the array data are
+ * copied on `read()` only, and `view()` gives direct access to them without
+ * any copy.  For example, the batch sums of a `batch_result<double>`
+ * serialized as `"res"` can be used in place by:
+ *
+ *     binary_deserializer ser("results.bin");
+ *     ndview<const double> sum = ser.view<double>("res/batch/sum");
+ *     Eigen::Map<const Eigen::MatrixXd> batch(sum.data(), sum.shape()[1],
+ *                                             sum.shape()[0]);
+ *
+ * (Eigen matrices are serialized as their row-major transposes.)
+ */
+class binary_deserializer
+    : public deserializer
+{
+public:
+    /** Map the file with name `filename` read-only into memory */
+    explicit binary_deserializer(const std::string &filename);
+
+    /** Read from buffer, which must outlive the deserializer */
+    binary_deserializer(const void *data, size_t size);
+
+    // Common methods
+
+    void enter(const std::string &group) override;
+
+    void exit() override;
+
+    // Deserialization methods
+
+    std::vector<size_t> get_shape(const std::string &key) override;
+
+    void read(const std::string &key, ndview<double> value) override {
+        do_read(key, value);
+    }
+
+    void read(const std::string &key, ndview<std::complex<double>> value) override {
+        do_read(key, value);
+    }
+
+    void read(const std::string &key, ndview<int64_t> value) override {
+        do_read(key, value);
+    }
+
+    void read(const std::string &key, ndview<uint64_t> value) override {
+        do_read(key, value);
+    }
+
+    void read(const std::string &key, ndview<int32_t> value) override {
+        do_read(key, value);
+    }
+
+    void read(const std::string &key, ndview<uint32_t> value) override {
+        do_read(key, value);
+    }
+
+    /**
+     * Returns view on the array at `key` in the container without copying.
+     *
+     * The key is relative to the current group, where subgroups may be
+     * separated by `/`.  The view is valid as long as the deserializer.
+     */
+    template <typename T>
+    ndview<const T> view(const std::string &key) const
+    {
+        const entry &e = find(key, internal::binary_type<T>::value);
+        return ndview<const T>(reinterpret_cast<const T *>(e.data),
+                               e.shape.data(), e.shape.size());
+    }
+
+    /** Returns the keys of all arrays in the container */
+    std::vector<std::string> keys() const;
+
+    ~binary_deserializer();
+
+protected:
+    struct entry
+    {
+        uint32_t type;
+        std::vector<size_t> shape;
+        const char *data;
+    };
+
+    template <typename T>
+    void do_read(const std::string &key, ndview<T> data)
+    {
+        const entry &e = find(key, internal::binary_type<T>::value);
+
+        // check shape (this is cheap compared to reading)
+        if (data.ndim() != e.shape.size())
+            throw size_mismatch();
+        for (size_t i = 0; i != e.shape.size(); ++i)
+            if (e.shape[i] != data.shape()[i])
+                throw size_mismatch();
+
+        // discard the data
+        if (data.data() == nullptr)
+            return;
+
+        std::memcpy(data.data(), e.data, data.size() * sizeof(T));
+    }
+
+    void scan();
+
+    const entry &find(const std::string &key, uint32_t type) const;
+
+    std::string get_path(const std::string &key) const;
+
+private:
+    std::shared_ptr<const void> mapping_;
+    const char *data_;
+    size_t size_;
+    std::map<std::string, entry> index_;
+    std::vector<std::string> group_;
+};
+
+}}
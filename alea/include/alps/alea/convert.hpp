@@ -106,9 +106,9 @@ struct joiner<cov_result<T> >
 
         // ignore cross correlation
         res.store().data2().topLeftCorner(first.size(), first.size())
-                                                = first.store().data2();
+                                                = first.cov();
         res.store().data2().bottomRightCorner(second.size(), second.size())
-                                                = second.store().data2();
+                                                = second.cov();
         res.store().count() = first.store().count();
         return res;
     }
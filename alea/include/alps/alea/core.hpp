@@ -236,6 +236,25 @@ struct reducer
     }
 };
 
+/**
+ * Collect measurements of several results with a single commit.
+ *
+ * Performs the pre-commit phase of `reduce()` for all results, commits the
+ * reducer once, and then performs the post-commit phase.  Reducers which
+ * defer their work to `commit()`, such as `packed_mpi_reducer`, can thus
+ * reduce all results at once.
+ */
+template <typename... Results>
+void reduce_all(const reducer &r, Results &... results)
+{
+    // braced initializers are evaluated in order
+    int pre[] = { 0, (results.reduce(r, true, false), 0)... };
+    r.commit();
+    int post[] = { 0, (results.reduce(r, false, true), 0)... };
+    (void) pre;
+    (void) post;
+}
+
 /**
  * Transformer instance.
  *
@@ -251,6 +270,31 @@ struct transformer
     /** apply transformation */
     virtual column<T> operator() (const column<T> &in) const = 0;
 
+    /**
+     * Apply transformation to each column of `in` (batch evaluation).
+     *
+     * The default implementation calls the transformation for each column.
+     * The columns are only processed concurrently (if OpenMP is enabled)
+     * when `is_thread_safe()` returns true.  Override this for
+     * transformations which can be evaluated more efficiently in batches.
+     */
+    virtual Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> apply_batch(
+            const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &in) const
+    {
+        if (in.rows() != (ptrdiff_t)in_size())
+            throw size_mismatch();
+
+        Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> res(out_size(), in.cols());
+        const long ncols = in.cols();
+#if defined(_OPENMP)
+        const bool concurrent = is_thread_safe();
+#pragma omp parallel for schedule(dynamic) if(concurrent)
+#endif
+        for (long j = 0; j < ncols; ++j)
+            res.col(j) = (*this)(column<T>(in.col(j)));
+        return res;
+    }
+
     /** expected number of components of the input vector */
     virtual size_t in_size() const = 0;
 
@@ -260,6 +304,12 @@ struct transformer
     /** Guarantee transformation to be linear (allows certain optimizations) */
     virtual bool is_linear() const { return false; }
 
+    /**
+     * Allow `operator()` to be called from several threads at once, which
+     * lets the default `apply_batch()` process the columns concurrently.
+     */
+    virtual bool is_thread_safe() const { return false; }
+
     /** Destructor */
     virtual ~transformer() { }
 };
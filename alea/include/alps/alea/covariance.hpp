@@ -13,6 +13,7 @@
 #include <alps/alea/var_strategy.hpp>
 
 #include <memory>
+#include <vector>
 
 // Forward declarations
 
@@ -37,6 +38,86 @@ namespace alps { namespace alea {
 
 namespace alps { namespace alea {
 
+/**
+ * Storage layout of the covariance matrix in `cov_acc` and `cov_result`.
+ *
+ * The dense layout (default) stores the full `size x size` matrix.  For
+ * random vectors with many components, this is often too expensive, and one
+ * may instead choose:
+ *
+ *  - the block-diagonal layout, which only keeps the correlations within
+ *    blocks of consecutive components of given sizes;
+ *
+ *  - the low-rank layout, which keeps the exact variances and a randomized
+ *    sketch `Y = C * Omega` of the covariance matrix `C`, where `Omega` is a
+ *    random `size x rank` matrix of signs.  The covariance matrix is then
+ *    approximated by the Nystrom method:
+ *
+ *        C ~ Y (Omega^T Y)^+ Y^+
+ *
+ *    which is exact if `C` has rank at most `rank`.
+ *
+ * Both need `O(size)` memory for fixed block size or rank.  Accumulators and
+ * results can only be merged or reduced if their layouts are equal.  The
+ * layout is stored along with serialized results; results without it are dense.
+ */
+class cov_layout
+{
+public:
+    enum kind_type { DENSE, BLOCK_DIAGONAL, LOW_RANK };
+
+public:
+    /** Dense covariance matrix */
+    cov_layout() : kind_(DENSE), rank_(0), seed_(0) { }
+
+    /** Block-diagonal covariance matrix with blocks of given sizes */
+    static cov_layout block_diagonal(const std::vector<size_t> &block_sizes)
+    {
+        cov_layout layout;
+        layout.kind_ = BLOCK_DIAGONAL;
+        layout.block_sizes_ = block_sizes;
+        return layout;
+    }
+
+    /** Low-rank approximation, where `seed` determines the sketch */
+    static cov_layout low_rank(size_t rank, uint64_t seed=0)
+    {
+        if (rank == 0)
+            throw std::invalid_argument("rank of sketch must be positive");
+
+        cov_layout layout;
+        layout.kind_ = LOW_RANK;
+        layout.rank_ = rank;
+        layout.seed_ = seed;
+        return layout;
+    }
+
+    kind_type kind() const { return kind_; }
+
+    /** Sizes of diagonal blocks (block-diagonal layout only) */
+    const std::vector<size_t> &block_sizes() const { return block_sizes_; }
+
+    /** Number of columns of the sketch (low-rank layout only) */
+    size_t rank() const { return rank_; }
+
+    /** Seed for the random sketch (low-rank layout only) */
+    uint64_t seed() const { return seed_; }
+
+    bool operator==(const cov_layout &other) const
+    {
+        return kind_ == other.kind_ && block_sizes_ == other.block_sizes_
+            && rank_ == other.rank_ && seed_ == other.seed_;
+    }
+
+    bool operator!=(const cov_layout &other) const { return !(*this == other); }
+
+private:
+    kind_type kind_;
+    std::vector<size_t> block_sizes_;
+    size_t rank_;
+    uint64_t seed_;
+};
+
 /**
  * Data for covariance accumulation.
  *
@@ -54,11 +135,14 @@ public:
     typedef typename eigen<cov_type>::matrix cov_matrix_type;
 
 public:
-    cov_data(size_t size);
+    cov_data(size_t size, const cov_layout &layout=cov_layout());
 
     /** Re-allocate and thus clear all accumulated data */
     void reset();
 
+    /** Storage layout of the covariance matrix */
+    const cov_layout &layout() const { return layout_; }
+
     /** Number of components of the random vector (e.g., size of mean) */
     size_t size() const { return data_.rows(); }
 
@@ -78,17 +162,48 @@ public:
 
     column<value_type> &data() { return data_; }
 
+    /** Second moment for the dense layout (empty for other layouts) */
     const cov_matrix_type &data2() const { return data2_; }
 
+    /** Second moment for the dense layout (empty for other layouts) */
     cov_matrix_type &data2() { return data2_; }
 
+    /** Diagonal blocks of the second moment (block-diagonal layout) */
+    const std::vector<cov_matrix_type> &blocks() const { return blocks_; }
+
+    /** Sketch `data2 * Omega` of the second moment (low-rank layout) */
+    const cov_matrix_type &sketch() const { return sketch_; }
+
+    /** Diagonal of the second moment, i.e., the variances */
+    column<cov_type> diagonal() const;
+
+    /** Second moment as dense matrix (approximated for low-rank layout) */
+    cov_matrix_type dense_data2() const;
+
+    /** Add `factor` times the outer product of `x` to the second moment */
+    void add_outer(const column<value_type> &x, double factor);
+
+    /** Add the outer products of all columns of `x` to the second moment */
+    void add_outer(const typename eigen<value_type>::matrix &x);
+
+    /** Add the second moment of `other`, which must have the same layout */
+    void add_data2(const cov_data &other);
+
     void convert_to_mean();
 
     void convert_to_sum();
 
+protected:
+    template <typename Func>
+    void for_each_data2(Func func);
+
 private:
     column<T> data_;
+    cov_layout layout_;
     cov_matrix_type data2_;
+    std::vector<cov_matrix_type> blocks_;
+    cov_matrix_type sketch_, diag_;
+    typename eigen<value_type>::matrix omega_;
     uint64_t count_;
     double count2_;
 
@@ -125,7 +240,8 @@ public:
     using cov_matrix_type = typename eigen<cov_type>::matrix;
 
 public:
-    cov_acc(size_t size=1, uint64_t batch_size=1);
+    cov_acc(size_t size=1, uint64_t batch_size=1,
+            const cov_layout &layout=cov_layout());
 
     cov_acc(const cov_acc &other);
 
@@ -149,6 +265,9 @@ public:
     /** Returns number of data points per batch */
     uint64_t batch_size() const { return current_.target(); }
 
+    /** Storage layout of the covariance matrix */
+    const cov_layout &layout() const { return layout_; }
+
     /** Add computed vector to the accumulator */
     cov_acc& operator<<(const computed<T>& src){ add(src, 1); return *this; }
 
@@ -167,7 +286,7 @@ public:
     const bundle<value_type> &current() const { return current_; }
 
     /** Return backend object used for storing estimands */
-    const cov_data<T,Strategy> &store() const { return *store_; }
+    const cov_data<T,Strategy> &store() const { flush_pending(); return *store_; }
 
 protected:
     void add(const computed<T> &source, uint64_t count);
@@ -176,9 +295,20 @@ protected:
 
     void finalize_to(cov_result<T,Strategy> &result);
 
+    static void add_bundle_to(cov_data<T,Strategy> &store, const bundle<value_type> &batch);
+
+    void flush_pending() const;
+
 private:
     std::unique_ptr<cov_data<T,Strategy> > store_;
     bundle<value_type> current_;
+    cov_layout layout_;
+
+    // Full bundles, scaled by `1/sqrt(count)`, whose outer products have not
+    // yet been added to the second moment.  They are added in one go as a
+    // rank-k update, which is much faster than k rank-one updates.
+    mutable typename eigen<value_type>::matrix pending_;
+    mutable size_t npending_;
 
     friend class batch_result<T>;
 };
@@ -255,10 +385,10 @@ public:
     const column<T> &mean() const { return store_->data(); }
 
     /** Returns bias-corrected sample variance */
-    column<var_type> var() const { return store_->data2().diagonal().real(); }
+    column<var_type> var() const { return store_->diagonal().real(); }
 
     /** Returns bias-corrected sample covariance matrix  */
-    typename eigen<cov_type>::matrix cov() const { return store_->data2(); }
+    typename eigen<cov_type>::matrix cov() const { return store_->dense_data2(); }
 
     /** Returns bias-corrected standard error of the mean */
     column<var_type> stderror() const;
@@ -272,6 +402,9 @@ public:
     /** Collect measurements from different instances using sum-reducer */
     void reduce(const reducer &r) { reduce(r, true, true); }
 
+    /** Perform the phases of `reduce()` before and/or after the commit */
+    void reduce(const reducer &, bool do_pre_commit, bool do_post_commit);
+
     /** Convert result to a permanent format (write to disk etc.) */
     friend void serialize<>(serializer &, const std::string &, const cov_result &);
 
@@ -281,9 +414,6 @@ public:
     /** Write some info about the result to a stream */
     friend std::ostream &operator<< <>(std::ostream &, const cov_result &);
 
-protected:
-    void reduce(const reducer &, bool do_pre_commit, bool do_post_commit);
-
 private:
     std::unique_ptr<cov_data<T,Strategy> > store_;
 
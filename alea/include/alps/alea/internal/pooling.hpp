@@ -18,7 +18,7 @@ namespace alps { namespace alea { namespace internal {
 
 /** Returns covariance, or construct from variances if not available */
 template <typename T, typename Str>
-const typename eigen<typename traits<cov_result<T,Str>>::cov_type>::matrix &
+typename eigen<typename traits<cov_result<T,Str>>::cov_type>::matrix
 get_cov(const cov_result<T,Str> &result)
 {
     return result.cov();
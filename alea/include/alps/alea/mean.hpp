@@ -196,6 +196,9 @@ public:
     /** Collect measurements from different instances using sum-reducer */
     void reduce(const reducer &r) { return reduce(r, true, true); }
 
+    /** Perform the phases of `reduce()` before and/or after the commit */
+    void reduce(const reducer &, bool do_pre_commit, bool do_post_commit);
+
     /** Convert result to a permanent format (write to disk etc.) */
     friend void serialize<>(serializer &, const std::string &, const mean_result &);
 
@@ -205,9 +208,6 @@ public:
     /** Write some info about the result to a stream */
     friend std::ostream &operator<< <>(std::ostream &, const mean_result &);
 
-protected:
-    void reduce(const reducer &, bool do_pre_commit, bool do_post_commit);
-
 private:
     std::unique_ptr< mean_data<T> > store_;
 
@@ -8,6 +8,9 @@
 #include <alps/alea/core.hpp>
 #include <alps/utilities/mpi.hpp>     /* provides mpi.h */
 
+#include <algorithm>
+#include <vector>
+
 // TODO: merge into MPI
 namespace alps { namespace mpi {
 
@@ -99,4 +102,152 @@ private:
     int root_;
 };
 
+/**
+ * Sum-reduction via an MPI communicator, which packs all data of a commit.
+ *
+ * Where `mpi_reducer` performs one `MPI_Reduce` per call of `reduce()`,
+ * this reducer only records the views and sends them on `commit()` in one
+ * buffer per data type.  Use `reduce_all()` to reduce several results with a
+ * single commit.
+ *
+ * If `hierarchical` is set, the data is first summed over the ranks sharing
+ * a node, and only the node leaders take part in the reduction to the root.
+ * `start_commit()` posts the (inter-node) reduction without waiting for it,
+ * so the caller may do other work before `finish_commit()`.
+ */
+struct packed_mpi_reducer
+    : public mpi_reducer
+{
+    packed_mpi_reducer(const mpi::communicator &comm=mpi::communicator(),
+                       int root=0, bool hierarchical=false)
+        : mpi_reducer(comm, root)
+        , hierarchical_(false)
+        , is_leader_(true)
+        , started_(false)
+    {
+#if MPI_VERSION >= 3
+        if (hierarchical) {
+            // order the ranks such that the root leads its node and the
+            // node leaders
+            int key = comm.rank() == root ? 0 : comm.rank() + 1;
+            MPI_Comm node, leaders;
+            mpi::checked(MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, key,
+                                             MPI_INFO_NULL, &node));
+            node_ = mpi::communicator(node, mpi::take_ownership);
+            is_leader_ = node_.rank() == 0;
+            mpi::checked(MPI_Comm_split(comm, is_leader_ ? 0 : MPI_UNDEFINED,
+                                        key, &leaders));
+            if (is_leader_)
+                leaders_ = mpi::communicator(leaders, mpi::take_ownership);
+            hierarchical_ = true;
+        }
+#endif
+    }
+
+    void reduce(view<double> data) const override { doubles_.record(data); }
+
+    void reduce(view<int32_t> data) const override { ints_.record(data); }
+
+    void reduce(view<int64_t> data) const override { longs_.record(data); }
+
+    void commit() const override
+    {
+        if (!started_)
+            start_commit();
+        finish_commit();
+    }
+
+    /** Pack the recorded data and post its reduction */
+    void start_commit() const
+    {
+        start(doubles_);
+        start(ints_);
+        start(longs_);
+        started_ = true;
+    }
+
+    /** Wait for the reduction and copy the sums back on the root */
+    void finish_commit() const
+    {
+        finish(doubles_);
+        finish(ints_);
+        finish(longs_);
+        started_ = false;
+    }
+
+    bool hierarchical() const { return hierarchical_; }
+
+protected:
+    template <typename T>
+    struct packet
+    {
+        std::vector< view<T> > views;
+        std::vector<T> buffer;
+        MPI_Request request = MPI_REQUEST_NULL;
+
+        void record(view<T> data) { if (data.size() != 0) views.push_back(data); }
+    };
+
+    template <typename T>
+    void start(packet<T> &p) const
+    {
+        p.buffer.clear();
+        for (view<T> &v : p.views)
+            p.buffer.insert(p.buffer.end(), v.data(), v.data() + v.size());
+        if (p.buffer.empty())
+            return;
+
+        MPI_Datatype dtype_tag = alps::mpi::get_mpi_datatype(T());
+        if (hierarchical_) {
+            post_reduce(p, dtype_tag, 0, node_, false);
+            if (is_leader_)
+                post_reduce(p, dtype_tag, 0, leaders_, true);
+        } else {
+            post_reduce(p, dtype_tag, root(), comm(), true);
+        }
+    }
+
+    template <typename T>
+    void post_reduce(packet<T> &p, MPI_Datatype dtype_tag, int root,
+                        const mpi::communicator &comm, bool async) const
+    {
+        // In-place requires special value for sendbuf, but only on root
+        void *sendbuf = comm.rank() == root ? MPI_IN_PLACE : p.buffer.data();
+#if MPI_VERSION >= 3
+        if (async) {
+            mpi::checked(MPI_Ireduce(sendbuf, p.buffer.data(), p.buffer.size(),
+                                     dtype_tag, MPI_SUM, root, comm,
+                                     &p.request));
+            return;
+        }
+#endif
+        mpi::checked(MPI_Reduce(sendbuf, p.buffer.data(), p.buffer.size(),
+                                dtype_tag, MPI_SUM, root, comm));
+    }
+
+    template <typename T>
+    void finish(packet<T> &p) const
+    {
+        if (p.request != MPI_REQUEST_NULL)
+            mpi::checked(MPI_Wait(&p.request, MPI_STATUS_IGNORE));
+
+        if (am_root()) {
+            const T *packed = p.buffer.data();
+            for (view<T> &v : p.views) {
+                std::copy(packed, packed + v.size(), v.data());
+                packed += v.size();
+            }
+        }
+        p.views.clear();
+    }
+
+private:
+    bool hierarchical_, is_leader_;
+    mpi::communicator node_, leaders_;
+    mutable bool started_;
+    mutable packet<double> doubles_;
+    mutable packet<int32_t> ints_;
+    mutable packet<int64_t> longs_;
+};
+
 }}
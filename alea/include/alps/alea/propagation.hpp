@@ -55,16 +55,27 @@ private:
 /**
  * Estimate propagated variance by sampling the prior.
  *
- * @warning Not implemented
+ * Given a transformation `f` and a random sample `X`, approximate the
+ * distribution of `Mean[X]` by a normal distribution with the estimated
+ * covariance of the mean, draw `nsamples` points `x` from it, and estimate
+ * `Cov[f(X)]` by the covariance of the `f(x)`.  The draws depend only on
+ * `seed` and not on the number of threads.
+ *
+ * @see alps::alea::sample_prior
  */
 struct sampling_prop
 {
-    sampling_prop(size_t nsamples=1024) : nsamples_(nsamples) { }
+    sampling_prop(size_t nsamples=1024, uint64_t seed=0)
+        : nsamples_(nsamples), seed_(seed)
+    { assert(nsamples > 1); }
 
     size_t nsamples() const { return nsamples_; }
 
+    uint64_t seed() const { return seed_; }
+
 private:
     size_t nsamples_;
+    uint64_t seed_;
 };
 
 /**
@@ -81,16 +92,27 @@ struct jackknife_prop { };
 /**
  * Perform non-parametric bootstrap rebatching.
  *
- * @warning Not implemented
+ * Given a transformation `f` and a sample of `N` batches, draw `nsamples`
+ * resamples of `N` batches with replacement and estimate `Cov[f(X)]` by the
+ * covariance of `f` over the resample means.  Unlike the jackknife, the
+ * bootstrap does not remove the bias.  The resamples depend only on `seed`
+ * and not on the number of threads.
+ *
+ * @see alps::alea::bootstrap
  */
 struct bootstrap_prop
 {
-    bootstrap_prop(size_t nsamples=1024) : nsamples_(nsamples) { }
+    bootstrap_prop(size_t nsamples=1024, uint64_t seed=0)
+        : nsamples_(nsamples), seed_(seed)
+    { assert(nsamples > 1); }
 
     size_t nsamples() const { return nsamples_; }
 
+    uint64_t seed() const { return seed_; }
+
 private:
     size_t nsamples_;
+    uint64_t seed_;
 };
 
 /**
@@ -114,4 +136,33 @@ typename eigen<T>::matrix jacobian(const transformer<T> &f, column<T> x, double
 template <typename T>
 batch_data<T> jackknife(const batch_data<T> &in, const transformer<T> &tf);
 
+/**
+ * Transform bootstrap resamples of the batches.
+ *
+ * Returns a matrix whose `r`-th column is `f` evaluated at the mean of the
+ * `r`-th resample of the batches of `in`.  The resamples are drawn from a
+ * counter-based random number generator keyed by `seed`, so the result does
+ * not depend on the number of threads.  The resamples are evaluated by one
+ * call to `f.apply_batch()`, which evaluates them concurrently only if
+ * `f.is_thread_safe()` returns true.
+ */
+template <typename T>
+typename eigen<T>::matrix bootstrap(const batch_data<T> &in,
+                                    const transformer<T> &tf, size_t nsamples,
+                                    uint64_t seed);
+
+/**
+ * Transform samples of a normal distribution.
+ *
+ * Returns a matrix whose `r`-th column is `f` evaluated at a point drawn from
+ * the (circular) normal distribution with `mean` and covariance matrix `cov`.
+ * As for `bootstrap()`, the draws only depend on `seed`, and the points are
+ * evaluated by `f.apply_batch()`, concurrently only if `f.is_thread_safe()`.
+ */
+template <typename T>
+typename eigen<T>::matrix sample_prior(const column<T> &mean,
+                                       const typename eigen<T>::matrix &cov,
+                                       const transformer<T> &tf,
+                                       size_t nsamples, uint64_t seed);
+
 }}
@@ -15,6 +15,7 @@
 
 #include <alps/alea/propagation.hpp>
 #include <alps/alea/convert.hpp>
+#include <alps/alea/internal/pooling.hpp>
 
 #include <random>
 #include <type_traits>
@@ -96,4 +97,60 @@ batch_result<T> transform(jackknife_prop, const transformer<T> &tf, const batch_
     return res;
 }
 
+namespace internal {
+
+/** Covariance of the columns of `samples`, as used by bootstrap and sampling */
+template <typename T>
+typename eigen<T>::matrix sample_cov(const typename eigen<T>::matrix &samples)
+{
+    typename eigen<T>::matrix dev =
+                        samples.colwise() - samples.rowwise().mean();
+    return dev * dev.adjoint() / double(samples.cols() - 1);
+}
+
+}
+
+template <typename T>
+cov_result<T> transform(bootstrap_prop p, const transformer<T> &tf, const batch_result<T> &in)
+{
+    if (tf.in_size() != in.size())
+        throw size_mismatch();
+
+    typename eigen<T>::matrix samples =
+                bootstrap(in.store(), tf, p.nsamples(), p.seed());
+
+    // the sample covariance is the one of the mean; data2 is the one of
+    // the distribution
+    cov_result<T> res(cov_data<T>(tf.out_size()));
+    res.store().data() = tf(in.mean());
+    res.store().data2() = internal::sample_cov<T>(samples) * in.observations();
+    res.store().count() = in.count();
+    res.store().count2() = in.count2();
+    return res;
+}
+
+template <typename T, typename InResult>
+cov_result<T> transform(sampling_prop p, const transformer<T> &tf, const InResult &in)
+{
+    static_assert(traits<InResult>::HAVE_MEAN, "result does not have mean");
+    static_assert(traits<InResult>::HAVE_VAR, "result does not have variance");
+    static_assert(std::is_same<typename traits<InResult>::value_type, T>::value,
+                  "Result and transform types are mismatched");
+
+    if (tf.in_size() != in.size())
+        throw size_mismatch();
+
+    typename eigen<T>::matrix cov = internal::get_cov(in) / in.observations();
+
+    typename eigen<T>::matrix samples =
+                sample_prior(in.mean(), cov, tf, p.nsamples(), p.seed());
+
+    cov_result<T> res(cov_data<T>(tf.out_size()));
+    res.store().data() = tf(in.mean());
+    res.store().data2() = internal::sample_cov<T>(samples) * in.observations();
+    res.store().count() = in.count();
+    res.store().count2() = in.count2();
+    return res;
+}
+
 }}
@@ -59,8 +59,15 @@ public:
         return mat_ * typename eigen<T>::col(in);
     }
 
+    typename eigen<T>::matrix apply_batch(const typename eigen<T>::matrix &in) const
+    {
+        return mat_ * in;
+    }
+
     bool is_linear() const { return true; }
 
+    bool is_thread_safe() const { return true; }
+
 private:
     typename eigen<T>::matrix mat_;
 };
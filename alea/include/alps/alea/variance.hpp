@@ -186,6 +186,16 @@ protected:
 
     void finalize_to(var_result<T,Strategy> &result, var_acc *cascade);
 
+    /**
+     * Writes the result for the current state to `result`, without changing
+     * (or copying) the accumulator.  If given, `carry` is the partial batch
+     * passed up by the level below (see `autocorr_acc`); it is then replaced
+     * with the partial batch to pass on to the level above.
+     */
+    void snapshot_to(var_result<T,Strategy> &result, bundle<value_type> *carry) const;
+
+    static void add_bundle_to(var_data<T,Strategy> &store, const bundle<value_type> &batch);
+
 private:
     std::unique_ptr< var_data<value_type, Strategy> > store_;
     bundle<value_type> current_;
@@ -265,6 +275,9 @@ public:
     /** Collect measurements from different instances using sum-reducer */
     void reduce(const reducer &r) { reduce(r, true, true); }
 
+    /** Perform the phases of `reduce()` before and/or after the commit */
+    void reduce(const reducer &, bool do_pre_commit, bool do_post_commit);
+
     /** Convert result to a permanent format (write to disk etc.) */
     friend void serialize<>(serializer &, const std::string &, const var_result &);
 
@@ -274,9 +287,6 @@ public:
     /** Write some info about the result to a stream */
     friend std::ostream &operator<< <>(std::ostream &, const var_result &);
 
-protected:
-    void reduce(const reducer &, bool do_pre_commit, bool do_post_commit);
-
 private:
     std::unique_ptr< var_data<T,Strategy> > store_;
 
@@ -100,7 +100,13 @@ autocorr_result<T> autocorr_acc<T>::result() const
 {
     internal::check_valid(*this);
     autocorr_result<T> result;
-    autocorr_acc<T>(*this).finalize_to(result);
+    result.level_.resize(level_.size());
+
+    // Bottom-up, as in finalize_to(), but the partial batches propagated
+    // upwards are collected in `carry` instead of the levels.
+    bundle<T> carry(size_, 0);
+    for (size_t i = 0; i != level_.size(); ++i)
+        level_[i].snapshot_to(result.level_[i], &carry);
     return result;
 }
 
@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#include <alps/alea/binary.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+namespace alps { namespace alea {
+
+namespace {
+
+const char binary_magic[8] = {'A', 'L', 'E', 'A', 'B', 'I', 'N', '\0'};
+
+const uint32_t tag_enter = 1, tag_exit = 2, tag_array = 3;
+
+/** Size of the primitive with given type code in bytes */
+size_t binary_type_size(uint32_t type)
+{
+    switch (type) {
+    case internal::binary_type<double>::value:               return 8;
+    case internal::binary_type<std::complex<double> >::value: return 16;
+    case internal::binary_type<int64_t>::value:              return 8;
+    case internal::binary_type<uint64_t>::value:             return 8;
+    case internal::binary_type<int32_t>::value:              return 4;
+    case internal::binary_type<uint32_t>::value:             return 4;
+    default:
+        throw std::runtime_error("Invalid type in binary container");
+    }
+}
+
+/** The container is little-endian, and we do not swap bytes (yet) */
+void check_little_endian()
+{
+    const uint32_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    if (first != 1)
+        throw unsupported_operation();
+}
+
+size_t round_up(size_t offset, size_t boundary)
+{
+    return (offset + boundary - 1) / boundary * boundary;
+}
+
+/** Maps file read-only into memory, which is unmapped on release */
+std::shared_ptr<const void> map_file(const std::string &filename, size_t &size)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Unable to open file: " + filename);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Unable to map empty file: " + filename);
+    }
+    size = info.st_size;
+
+    void *addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);                // the mapping keeps the file open
+    if (addr == MAP_FAILED)
+        throw std::runtime_error("Unable to map file: " + filename);
+
+    const size_t mapped_size = size;
+    return std::shared_ptr<const void>(addr, [mapped_size](const void *p) {
+        ::munmap(const_cast<void *>(p), mapped_size);
+    });
+}
+
+}
+
+const uint32_t binary_serializer::version;
+const uint32_t binary_serializer::alignment;
+
+binary_serializer::binary_serializer(std::ostream &out)
+    : out_(&out)
+    , offset_(0)
+    , depth_(0)
+{
+    check_little_endian();
+
+    const uint32_t header[2] = {version, alignment};
+    write_bytes(binary_magic, sizeof(binary_magic));
+    write_bytes(header, sizeof(header));
+}
+
+void binary_serializer::enter(const std::string &group)
+{
+    write_record(tag_enter, 0, group, nullptr, 0, nullptr, 0);
+    ++depth_;
+}
+
+void binary_serializer::exit()
+{
+    if (depth_ == 0)
+        throw std::runtime_error("exit without enter");
+    write_record(tag_exit, 0, "", nullptr, 0, nullptr, 0);
+    --depth_;
+}
+
+binary_serializer::~binary_serializer()
+{
+    // Cannot do exception because we are in destructor
+    if (depth_ != 0) {
+        std::cerr << "alps::alea::binary_serializer: warning: "
+                  << "enter without exit\n\n";
+    }
+}
+
+void binary_serializer::write_record(uint32_t tag, uint32_t type,
+                                     const std::string &key,
+                                     const size_t *shape, size_t ndim,
+                                     const void *data, size_t nbytes)
+{
+    if (key.find('/') != std::string::npos)
+        throw std::runtime_error("Key must not contain '/'");
+
+    const uint32_t head[4] = {tag, type, static_cast<uint32_t>(ndim),
+                              static_cast<uint32_t>(key.size())};
+    write_bytes(head, sizeof(head));
+    for (size_t d = 0; d != ndim; ++d) {
+        const uint64_t extent = shape[d];
+        write_bytes(&extent, sizeof(extent));
+    }
+    write_bytes(key.data(), key.size());
+
+    if (tag == tag_array) {
+        write_padding(alignment);
+        write_bytes(data, nbytes);
+    }
+    write_padding(8);
+}
+
+void binary_serializer::write_bytes(const void *data, size_t nbytes)
+{
+    out_->write(static_cast<const char *>(data), nbytes);
+    if (!*out_)
+        throw std::runtime_error("Unable to write binary container");
+    offset_ += nbytes;
+}
+
+void binary_serializer::write_padding(size_t boundary)
+{
+    static const char zeros[alignment] = {};
+    write_bytes(zeros, round_up(offset_, boundary) - offset_);
+}
+
+
+binary_deserializer::binary_deserializer(const std::string &filename)
+{
+    check_little_endian();
+    mapping_ = map_file(filename, size_);
+    data_ = static_cast<const char *>(mapping_.get());
+    scan();
+}
+
+binary_deserializer::binary_deserializer(const void *data, size_t size)
+    : data_(static_cast<const char *>(data))
+    , size_(size)
+{
+    check_little_endian();
+    scan();
+}
+
+binary_deserializer::~binary_deserializer()
+{
+    // Cannot do exception because we are in destructor
+    if (!group_.empty()) {
+        std::cerr << "alps::alea::binary_deserializer: warning: "
+                  << "enter without exit\n Lingering groups:"
+                  << get_path("") << "\n\n";
+    }
+}
+
+void binary_deserializer::scan()
+{
+    size_t offset = 0;
+    auto take = [&](size_t nbytes) {
+        if (nbytes > size_ - offset)
+            throw std::runtime_error("Truncated binary container");
+        const char *where = data_ + offset;
+        offset += nbytes;
+        return where;
+    };
+
+    if (size_ < 16 || std::memcmp(take(8), binary_magic, 8) != 0)
+        throw std::runtime_error("Not a binary container");
+    uint32_t header[2];
+    std::memcpy(header, take(sizeof(header)), sizeof(header));
+    if (header[0] != binary_serializer::version)
+        throw std::runtime_error("Unsupported version of binary container");
+    const size_t alignment = header[1];
+
+    std::vector<std::string> groups;
+    while (offset != size_) {
+        uint32_t head[4];
+        std::memcpy(head, take(sizeof(head)), sizeof(head));
+
+        entry e;
+        e.type = head[1];
+        e.shape.resize(head[2]);
+        for (size_t &extent : e.shape) {
+            uint64_t extent_des;
+            std::memcpy(&extent_des, take(sizeof(extent_des)), sizeof(extent_des));
+            extent = extent_des;
+        }
+        const std::string key(take(head[3]), head[3]);
+
+        switch (head[0]) {
+        case tag_enter:
+            groups.push_back(key);
+            break;
+        case tag_exit:
+            if (groups.empty())
+                throw std::runtime_error("Corrupt binary container");
+            groups.pop_back();
+            break;
+        case tag_array: {
+            size_t count = 1;
+            for (size_t extent : e.shape)
+                count *= extent;
+            take(round_up(offset, alignment) - offset);
+            e.data = take(count * binary_type_size(e.type));
+
+            std::string path;
+            for (const std::string &group : groups)
+                path += group + '/';
+            index_[path + key] = e;
+            break;
+        }
+        default:
+            throw std::runtime_error("Corrupt binary container");
+        }
+        take(round_up(offset, 8) - offset);
+    }
+}
+
+void binary_deserializer::enter(const std::string &group)
+{
+    group_.push_back(group);
+}
+
+void binary_deserializer::exit()
+{
+    if (group_.empty())
+        throw std::runtime_error("exit without enter");
+    group_.pop_back();
+}
+
+std::vector<size_t> binary_deserializer::get_shape(const std::string &key)
+{
+    auto it = index_.find(get_path(key));
+    if (it == index_.end())
+        throw std::runtime_error("Key not found: " + get_path(key));
+    return it->second.shape;
+}
+
+std::vector<std::string> binary_deserializer::keys() const
+{
+    std::vector<std::string> result;
+    for (const auto &item : index_)
+        result.push_back(item.first);
+    return result;
+}
+
+const binary_deserializer::entry &binary_deserializer::find(
+                            const std::string &key, uint32_t type) const
+{
+    auto it = index_.find(get_path(key));
+    if (it == index_.end())
+        throw std::runtime_error("Key not found: " + get_path(key));
+    if (it->second.type != type)
+        throw std::runtime_error("Type mismatch for key: " + get_path(key));
+    return it->second;
+}
+
+std::string binary_deserializer::get_path(const std::string &key) const
+{
+    std::string path;
+    for (const std::string &group : group_)
+        path += group + '/';
+    return path + key;
+}
+
+}}
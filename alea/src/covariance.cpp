@@ -10,40 +10,337 @@
 #include <alps/alea/internal/util.hpp>
 #include <alps/alea/internal/format.hpp>
 
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
 namespace alps { namespace alea {
 
+namespace {
+
+/** Random matrix of signs, which is reproducible for given seed */
+template <typename T>
+typename eigen<T>::matrix make_sketch(size_t rows, size_t cols, uint64_t seed)
+{
+    typename eigen<T>::matrix omega(rows, cols);
+    std::mt19937_64 engine(seed);
+    uint64_t bits = 0;
+    for (size_t k = 0; k != rows * cols; ++k) {
+        if (k % 64 == 0)
+            bits = engine();
+        omega.data()[k] = (bits & 1) ? 1.0 : -1.0;
+        bits >>= 1;
+    }
+    return omega;
+}
+
+/** Nystrom approximation `Y (Omega^T Y)^+ Y^+` of a covariance matrix */
+template <typename T>
+Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> nystrom(
+                const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &sketch,
+                const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &omega)
+{
+    typename eigen<T>::matrix core = omega.transpose() * sketch;
+    core = 0.5 * (core + core.adjoint()).eval();
+
+    // The core matrix is positive semi-definite, so we drop the eigenvalues
+    // which are (numerically) zero or negative in the pseudo-inverse
+    Eigen::SelfAdjointEigenSolver<typename eigen<T>::matrix> ecore(core);
+    const double cutoff = 1e-12 * ecore.eigenvalues().cwiseAbs().maxCoeff();
+    Eigen::VectorXd inv = ecore.eigenvalues();
+    for (Eigen::Index i = 0; i != inv.size(); ++i)
+        inv(i) = inv(i) > cutoff ? 1 / inv(i) : 0;
+
+    typename eigen<T>::matrix y = sketch * ecore.eigenvectors();
+    return y * inv.template cast<T>().asDiagonal() * y.adjoint();
+}
+
+/**
+ * Nystrom approximation for elliptic variances.
+ *
+ * A `complex_op` is the covariance of the real and imaginary parts, so the
+ * covariance matrix is a real `2*size x 2*size` matrix of 2x2 blocks.  In
+ * this real embedding, the sketch is `C (Omega x I_2)`, and we can use the
+ * real Nystrom approximation.
+ */
+eigen<complex_op<double> >::matrix nystrom(
+                            const eigen<complex_op<double> >::matrix &sketch,
+                            const eigen<std::complex<double> >::matrix &omega)
+{
+    const Eigen::Index rows = sketch.rows(), cols = sketch.cols();
+    Eigen::MatrixXd sketch_re(2 * rows, 2 * cols);
+    Eigen::MatrixXd omega_re = Eigen::MatrixXd::Zero(2 * rows, 2 * cols);
+    for (Eigen::Index j = 0; j != cols; ++j) {
+        for (Eigen::Index i = 0; i != rows; ++i) {
+            const complex_op<double> &s = sketch(i, j);
+            sketch_re.block<2, 2>(2 * i, 2 * j) << s.rere(), s.reim(),
+                                                   s.imre(), s.imim();
+            omega_re(2 * i, 2 * j) = omega(i, j).real();
+            omega_re(2 * i + 1, 2 * j + 1) = omega(i, j).real();
+        }
+    }
+
+    const Eigen::MatrixXd cov_re = nystrom(sketch_re, omega_re);
+    eigen<complex_op<double> >::matrix result(rows, rows);
+    for (Eigen::Index j = 0; j != rows; ++j) {
+        for (Eigen::Index i = 0; i != rows; ++i) {
+            result(i, j) = complex_op<double>(
+                    cov_re(2 * i, 2 * j), cov_re(2 * i, 2 * j + 1),
+                    cov_re(2 * i + 1, 2 * j), cov_re(2 * i + 1, 2 * j + 1));
+        }
+    }
+    return result;
+}
+
+/** Add `x x^+` to the self-adjoint matrix `m` as rank-k update */
+template <typename T, typename Derived>
+void add_gram(Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &m,
+              const Eigen::MatrixBase<Derived> &x)
+{
+    // syrk/herk-type update of the lower triangle, which is then mirrored
+    m.template selfadjointView<Eigen::Lower>().rankUpdate(x);
+    m.template triangularView<Eigen::StrictlyUpper>() = m.adjoint();
+}
+
+/** Add `x y^+` to the matrix `m` */
+template <typename T, typename Derived1, typename Derived2>
+void add_product(Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &m,
+                 const Eigen::MatrixBase<Derived1> &x,
+                 const Eigen::MatrixBase<Derived2> &y)
+{
+    m.noalias() += x * y.adjoint();
+}
+
+/** Add the diagonal of `x x^+` to the column `d` */
+template <typename T, typename Derived>
+void add_gram_diagonal(Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &d,
+                       const Eigen::MatrixBase<Derived> &x)
+{
+    d.col(0) += x.cwiseAbs2().rowwise().sum().template cast<T>();
+}
+
+// The elliptic outer product is not a matrix product, so we have to fall
+// back to rank-one updates there.
+
+typedef bind<elliptic_var, std::complex<double> > elliptic_bind;
+
+template <typename Derived>
+void add_gram(eigen<complex_op<double> >::matrix &m,
+              const Eigen::MatrixBase<Derived> &x)
+{
+    for (Eigen::Index j = 0; j != x.cols(); ++j)
+        m.noalias() += internal::outer<elliptic_bind>(x.col(j), x.col(j));
+}
+
+template <typename Derived1, typename Derived2>
+void add_product(eigen<complex_op<double> >::matrix &m,
+                 const Eigen::MatrixBase<Derived1> &x,
+                 const Eigen::MatrixBase<Derived2> &y)
+{
+    for (Eigen::Index j = 0; j != x.cols(); ++j)
+        m.noalias() += internal::outer<elliptic_bind>(x.col(j), y.col(j));
+}
+
+template <typename Derived>
+void add_gram_diagonal(eigen<complex_op<double> >::matrix &d,
+                       const Eigen::MatrixBase<Derived> &x)
+{
+    for (Eigen::Index j = 0; j != x.cols(); ++j)
+        d.col(0) += internal::outer<elliptic_bind>(x.col(j), x.col(j)).diagonal();
+}
+
+/**
+ * Number of bundles which are collected for one rank-k update.
+ *
+ * The update is compute-bound once the panel of bundles is a few dozen
+ * columns wide; beyond that, we try to keep the panel within the L2 cache.
+ */
+template <typename T>
+size_t rank_update_width(size_t size)
+{
+    const size_t cache_size = 256 * 1024;
+    const size_t width = cache_size / (sizeof(T) * std::max<size_t>(size, 1));
+    return std::min<size_t>(std::max<size_t>(width, 16), 64);
+}
+
+}
+
 template <typename T, typename Str>
-cov_data<T,Str>::cov_data(size_t size)
+cov_data<T,Str>::cov_data(size_t size, const cov_layout &layout)
     : data_(size)
-    , data2_(size, size)
+    , layout_(layout)
 {
+    switch (layout.kind()) {
+    case cov_layout::DENSE:
+        data2_.resize(size, size);
+        break;
+    case cov_layout::BLOCK_DIAGONAL:
+        for (size_t block_size : layout.block_sizes())
+            blocks_.push_back(cov_matrix_type(block_size, block_size));
+        if (std::accumulate(layout.block_sizes().begin(),
+                            layout.block_sizes().end(), size_t(0)) != size)
+            throw size_mismatch();
+        break;
+    case cov_layout::LOW_RANK:
+        sketch_.resize(size, layout.rank());
+        diag_.resize(size, 1);
+        omega_ = make_sketch<value_type>(size, layout.rank(), layout.seed());
+        break;
+    }
     reset();
 }
 
+template <typename T, typename Str>
+template <typename Func>
+void cov_data<T,Str>::for_each_data2(Func func)
+{
+    func(data2_);
+    for (cov_matrix_type &block : blocks_)
+        func(block);
+    func(sketch_);
+    func(diag_);
+}
+
 template <typename T, typename Str>
 void cov_data<T,Str>::reset()
 {
     data_.fill(0);
-    data2_.fill(0);
+    for_each_data2([](cov_matrix_type &m) { m.fill(0); });
     count_ = 0;
     count2_ = 0;
 }
 
+template <typename T, typename Str>
+column<typename cov_data<T,Str>::cov_type> cov_data<T,Str>::diagonal() const
+{
+    switch (layout_.kind()) {
+    case cov_layout::BLOCK_DIAGONAL: {
+        column<cov_type> result(size());
+        size_t offset = 0;
+        for (const cov_matrix_type &block : blocks_) {
+            result.segment(offset, block.rows()) = block.diagonal();
+            offset += block.rows();
+        }
+        return result;
+    }
+    case cov_layout::LOW_RANK:
+        return diag_.col(0);
+    default:
+        return data2_.diagonal();
+    }
+}
+
+template <typename T, typename Str>
+typename cov_data<T,Str>::cov_matrix_type cov_data<T,Str>::dense_data2() const
+{
+    switch (layout_.kind()) {
+    case cov_layout::BLOCK_DIAGONAL: {
+        cov_matrix_type result(size(), size());
+        result.fill(0);
+        size_t offset = 0;
+        for (const cov_matrix_type &block : blocks_) {
+            result.block(offset, offset, block.rows(), block.cols()) = block;
+            offset += block.rows();
+        }
+        return result;
+    }
+    case cov_layout::LOW_RANK: {
+        cov_matrix_type result = nystrom(sketch_, omega_);
+        result.diagonal() = diag_.col(0);
+        return result;
+    }
+    default:
+        return data2_;
+    }
+}
+
+template <typename T, typename Str>
+void cov_data<T,Str>::add_outer(const column<value_type> &x, double factor)
+{
+    switch (layout_.kind()) {
+    case cov_layout::DENSE:
+        data2_.noalias() += factor * internal::outer<bind<Str, T> >(x, x);
+        break;
+    case cov_layout::BLOCK_DIAGONAL: {
+        size_t offset = 0;
+        for (cov_matrix_type &block : blocks_) {
+            auto x_block = x.segment(offset, block.rows());
+            block.noalias() +=
+                    factor * internal::outer<bind<Str, T> >(x_block, x_block);
+            offset += block.rows();
+        }
+        break;
+    }
+    case cov_layout::LOW_RANK: {
+        // (x x^+) Omega = x (Omega^T x)^+, as Omega is real
+        column<value_type> x_omega = omega_.transpose() * x;
+        sketch_.noalias() +=
+                    factor * internal::outer<bind<Str, T> >(x, x_omega);
+        diag_.col(0) +=
+                    factor * internal::outer<bind<Str, T> >(x, x).diagonal();
+        break;
+    }
+    }
+}
+
+template <typename T, typename Str>
+void cov_data<T,Str>::add_outer(const typename eigen<value_type>::matrix &x)
+{
+    switch (layout_.kind()) {
+    case cov_layout::DENSE:
+        add_gram(data2_, x);
+        break;
+    case cov_layout::BLOCK_DIAGONAL: {
+        size_t offset = 0;
+        for (cov_matrix_type &block : blocks_) {
+            add_gram(block, x.middleRows(offset, block.rows()));
+            offset += block.rows();
+        }
+        break;
+    }
+    case cov_layout::LOW_RANK: {
+        typename eigen<value_type>::matrix x_omega = omega_.transpose() * x;
+        add_product(sketch_, x, x_omega);
+        add_gram_diagonal(diag_, x);
+        break;
+    }
+    }
+}
+
+template <typename T, typename Str>
+void cov_data<T,Str>::add_data2(const cov_data &other)
+{
+    if (layout_ != other.layout_ || size() != other.size())
+        throw size_mismatch();
+
+    data2_ += other.data2_;
+    for (size_t i = 0; i != blocks_.size(); ++i)
+        blocks_[i] += other.blocks_[i];
+    sketch_ += other.sketch_;
+    diag_ += other.diag_;
+}
+
 template <typename T, typename Str>
 void cov_data<T,Str>::convert_to_mean()
 {
     data_ /= count_;
-    data2_ -= count_ * internal::outer<bind<Str, T> >(data_, data_);
+    add_outer(data_, -double(count_));
 
     // In case of zero unbiased information, the variance is infinite.
     // However, data2_ is 0 in this case as well, so we need to handle it
     // specially to avoid 0/0 = nan while propagating intrinsic NaN's.
     const double nunbiased = count_ - count2_/count_;
     if (nunbiased == 0)
-        data2_ = data2_.array().isNaN().select(data2_, INFINITY);
+        for_each_data2([](cov_matrix_type &m) {
+            m = m.array().isNaN().select(m, INFINITY);
+        });
     else
         // HACK: this is written in out-of-place notation to work around Eigen
-        data2_ = data2_ / nunbiased;
+        for_each_data2([nunbiased](cov_matrix_type &m) { m = m / nunbiased; });
 }
 
 template <typename T, typename Str>
@@ -58,11 +355,13 @@ void cov_data<T,Str>::convert_to_sum()
     // Care must be taken again for zero unbiased info since inf/0 is NaN.
     const double nunbiased = count_ - count2_/count_;
     if (nunbiased == 0)
-        data2_ = data2_.array().isNaN().select(data2_, 0);
+        for_each_data2([](cov_matrix_type &m) {
+            m = m.array().isNaN().select(m, 0);
+        });
     else
-        data2_ = data2_ * nunbiased;
+        for_each_data2([nunbiased](cov_matrix_type &m) { m = m * nunbiased; });
 
-    data2_ += count_ * internal::outer<bind<Str, T> >(data_, data_);
+    add_outer(data_, count_);
     data_ *= count_;
 }
 
@@ -72,9 +371,13 @@ template class cov_data<std::complex<double>, elliptic_var>;
 
 
 template <typename T, typename Str>
-cov_acc<T,Str>::cov_acc(size_t size, uint64_t batch_size)
-    : store_(new cov_data<T,Str>(size))
+cov_acc<T,Str>::cov_acc(size_t size, uint64_t batch_size,
+                        const cov_layout &layout)
+    : store_(new cov_data<T,Str>(size, layout))
     , current_(size, batch_size)
+    , layout_(layout)
+    , pending_(size, rank_update_width<T>(size))
+    , npending_(0)
 { }
 
 // We need an explicit copy constructor, as we need to copy the data
@@ -82,6 +385,9 @@ template <typename T, typename Str>
 cov_acc<T,Str>::cov_acc(const cov_acc &other)
     : store_(other.store_ ? new cov_data<T,Str>(*other.store_) : nullptr)
     , current_(other.current_)
+    , layout_(other.layout_)
+    , pending_(other.pending_)
+    , npending_(other.npending_)
 { }
 
 template <typename T, typename Str>
@@ -89,6 +395,9 @@ cov_acc<T,Str> &cov_acc<T,Str>::operator=(const cov_acc &other)
 {
     store_.reset(other.store_ ? new cov_data<T,Str>(*other.store_) : nullptr);
     current_ = other.current_;
+    layout_ = other.layout_;
+    pending_ = other.pending_;
+    npending_ = other.npending_;
     return *this;
 }
 
@@ -96,18 +405,21 @@ template <typename T, typename Str>
 void cov_acc<T,Str>::reset()
 {
     current_.reset();
+    npending_ = 0;
     if (valid())
         store_->reset();
     else
-        store_.reset(new cov_data<T,Str>(size()));
+        store_.reset(new cov_data<T,Str>(size(), layout_));
 }
 
 template <typename T, typename Str>
 void cov_acc<T,Str>::set_size(size_t size)
 {
     current_ = bundle<T>(size, current_.target());
+    pending_.resize(size, rank_update_width<T>(size));
+    npending_ = 0;
     if (valid())
-        store_.reset(new cov_data<T,Str>(size));
+        store_.reset(new cov_data<T,Str>(size, layout_));
 }
 
 template <typename T, typename Str>
@@ -133,7 +445,7 @@ template <typename T, typename Str>
 cov_acc<T,Str> &cov_acc<T,Str>::operator<<(const cov_result<T,Str> &other)
 {
     internal::check_valid(*this);
-    if (size() != other.size())
+    if (size() != other.size() || store_->layout() != other.store().layout())
         throw size_mismatch();
 
     // NOTE partial sums are unchanged
@@ -141,7 +453,7 @@ cov_acc<T,Str> &cov_acc<T,Str>::operator<<(const cov_result<T,Str> &other)
     cov_data<T,Str> &other_store = const_cast<cov_data<T,Str> &>(other.store());
     other_store.convert_to_sum();
     store_->data() += other_store.data();
-    store_->data2() += other_store.data2();
+    store_->add_data2(other_store);
     store_->count() += other_store.count();
     store_->count2() += other_store.count2();
     other_store.convert_to_mean();
@@ -152,8 +464,13 @@ template <typename T, typename Str>
 cov_result<T,Str> cov_acc<T,Str>::result() const
 {
     internal::check_valid(*this);
+
+    // as finalize_to(), but without changing (or copying) the accumulator
+    flush_pending();
     cov_result<T,Str> result(*store_);
-    cov_acc<T,Str>(*this).finalize_to(result);
+    if (current_.count() != 0)
+        add_bundle_to(*result.store_, current_);
+    result.store_->convert_to_mean();
     return result;
 }
 
@@ -170,9 +487,12 @@ void cov_acc<T,Str>::finalize_to(cov_result<T,Str> &result)
 {
     internal::check_valid(*this);
 
-    // add leftover data to the covariance.
-    if (current_.count() != 0)
-        add_bundle();
+    // add leftover data to the covariance (in the same order as result())
+    flush_pending();
+    if (current_.count() != 0) {
+        add_bundle_to(*store_, current_);
+        current_.reset();
+    }
 
     // swap data with result
     result.store_.reset();
@@ -183,20 +503,42 @@ void cov_acc<T,Str>::finalize_to(cov_result<T,Str> &result)
 }
 
 template <typename T, typename Str>
-void cov_acc<T,Str>::add_bundle()
+void cov_acc<T,Str>::add_bundle_to(cov_data<T,Str> &store, const bundle<T> &batch)
 {
     // add batch to average and squared
+    store.data().noalias() += batch.sum();
+    store.add_outer(batch.sum(), 1.0 / batch.count());
+    store.count() += batch.count();
+    store.count2() += batch.count() * batch.count();
+}
+
+template <typename T, typename Str>
+void cov_acc<T,Str>::add_bundle()
+{
+    // as add_bundle_to(), but defer the update of the second moment
     store_->data().noalias() += current_.sum();
-    store_->data2().noalias() +=
-                internal::outer<bind<Str, T> >(current_.sum(), current_.sum())
-                / current_.count();
     store_->count() += current_.count();
     store_->count2() += current_.count() * current_.count();
 
+    pending_.col(npending_) = current_.sum() / std::sqrt(double(current_.count()));
+    ++npending_;
+    if (npending_ == size_t(pending_.cols()))
+        flush_pending();
+
     // TODO: add possibility for uplevel also here
     current_.reset();
 }
 
+template <typename T, typename Str>
+void cov_acc<T,Str>::flush_pending() const
+{
+    if (npending_ == 0)
+        return;
+
+    store_->add_outer(pending_.leftCols(npending_));
+    npending_ = 0;
+}
+
 template class cov_acc<double>;
 template class cov_acc<std::complex<double>, circular_var>;
 template class cov_acc<std::complex<double>, elliptic_var>;
@@ -223,8 +565,12 @@ bool operator==(const cov_result<T,Strategy> &r1, const cov_result<T,Strategy> &
 
     return r1.count() == r2.count()
         && r1.count2() == r2.count2()
+        && r1.store().layout() == r2.store().layout()
         && r1.store().data() == r2.store().data()
-        && r1.store().data2() == r2.store().data2();
+        && r1.store().data2() == r2.store().data2()
+        && r1.store().blocks() == r2.store().blocks()
+        && r1.store().sketch() == r2.store().sketch()
+        && r1.store().diagonal() == r2.store().diagonal();
 }
 
 template bool operator==(const cov_result<double> &r1, const cov_result<double> &r2);
@@ -237,7 +583,7 @@ template <typename T, typename Str>
 column<typename cov_result<T,Str>::var_type> cov_result<T,Str>::stderror() const
 {
     internal::check_valid(*this);
-    return (store_->data2().diagonal().real() / observations()).cwiseSqrt();
+    return (store_->diagonal().real() / observations()).cwiseSqrt();
 }
 
 template <typename T, typename Str>
@@ -248,7 +594,10 @@ void cov_result<T,Str>::reduce(const reducer &r, bool pre_commit, bool post_comm
     if (pre_commit) {
         store_->convert_to_sum();
         r.reduce(view<T>(store_->data().data(), store_->data().rows()));
-        r.reduce(view<cov_type>(store_->data2().data(), store_->data2().size()));
+        typedef typename cov_data<T,Str>::cov_matrix_type cov_matrix_type;
+        store_->for_each_data2([&r](cov_matrix_type &m) {
+            r.reduce(view<cov_type>(m.data(), m.size()));
+        });
         r.reduce(view<uint64_t>(&store_->count(), 1));
         r.reduce(view<double>(&store_->count2(), 1));
     }
@@ -269,6 +618,64 @@ template class cov_result<std::complex<double>, circular_var>;
 template class cov_result<std::complex<double>, elliptic_var>;
 
 
+namespace {
+
+void serialize_layout(serializer &s, const cov_layout &layout)
+{
+    serialize(s, "@layout", static_cast<uint32_t>(layout.kind()));
+    switch (layout.kind()) {
+    case cov_layout::DENSE:
+        break;
+    case cov_layout::BLOCK_DIAGONAL: {
+        const std::vector<size_t> &block_sizes = layout.block_sizes();
+        column<uint64_t> sizes(block_sizes.size());
+        std::copy(block_sizes.begin(), block_sizes.end(), sizes.data());
+        serialize(s, "@nblocks", static_cast<uint64_t>(block_sizes.size()));
+        serialize(s, "block_sizes", sizes);
+        break;
+    }
+    case cov_layout::LOW_RANK:
+        serialize(s, "@rank", static_cast<uint64_t>(layout.rank()));
+        serialize(s, "@seed", layout.seed());
+        break;
+    }
+}
+
+cov_layout deserialize_layout(deserializer &s)
+{
+    // results written before the layout was stored have the dense layout
+    try {
+        s.get_shape("@layout");
+    } catch (const std::runtime_error &) {
+        return cov_layout();
+    }
+
+    uint32_t kind;
+    deserialize(s, "@layout", kind);
+    switch (kind) {
+    case cov_layout::DENSE:
+        return cov_layout();
+    case cov_layout::BLOCK_DIAGONAL: {
+        uint64_t nblocks;
+        deserialize(s, "@nblocks", nblocks);
+        column<uint64_t> sizes(nblocks);
+        deserialize(s, "block_sizes", sizes);
+        return cov_layout::block_diagonal(
+                    std::vector<size_t>(sizes.data(), sizes.data() + nblocks));
+    }
+    case cov_layout::LOW_RANK: {
+        uint64_t rank, seed;
+        deserialize(s, "@rank", rank);
+        deserialize(s, "@seed", seed);
+        return cov_layout::low_rank(rank, seed);
+    }
+    default:
+        throw std::runtime_error("Unknown covariance layout");
+    }
+}
+
+}
+
 template <typename T, typename Str>
 void serialize(serializer &s, const std::string &key, const cov_result<T,Str> &self)
 {
@@ -277,13 +684,29 @@ void serialize(serializer &s, const std::string &key, const cov_result<T,Str> &s
 
     // serialize to uint64_t to make sure we are consistent across 32/64 bit
     serialize(s, "@size", static_cast<uint64_t>(self.store_->data_.size()));
+    serialize_layout(s, self.store_->layout_);
     serialize(s, "count", self.store_->count_);
     serialize(s, "count2", self.store_->count2_);
     s.enter("mean");
     serialize(s, "value", self.store_->data_);
     serialize(s, "error", self.stderror());   // TODO temporary
     s.exit();
-    serialize(s, "cov", self.store_->data2_);
+
+    switch (self.store_->layout_.kind()) {
+    case cov_layout::DENSE:
+        serialize(s, "cov", self.store_->data2_);
+        break;
+    case cov_layout::BLOCK_DIAGONAL:
+        s.enter("cov_blocks");
+        for (size_t i = 0; i != self.store_->blocks_.size(); ++i)
+            serialize(s, std::to_string(i), self.store_->blocks_[i]);
+        s.exit();
+        break;
+    case cov_layout::LOW_RANK:
+        serialize(s, "cov_sketch", self.store_->sketch_);
+        serialize(s, "cov_diag", self.store_->diag_);
+        break;
+    }
 }
 
 template <typename T, typename Str>
@@ -298,8 +721,10 @@ void deserialize(deserializer &s, const std::string &key, cov_result<T,Str> &sel
 
     // first deserialize the fundamentals and make sure that the target fits
     size_t new_size = new_size_des;
-    if (!self.valid() || self.size() != new_size)
-        self.store_.reset(new cov_data<T,Str>(new_size));
+    cov_layout new_layout = deserialize_layout(s);
+    if (!self.valid() || self.size() != new_size
+            || self.store_->layout_ != new_layout)
+        self.store_.reset(new cov_data<T,Str>(new_size, new_layout));
 
     // deserialize data
     deserialize(s, "count", self.store_->count_);
@@ -309,7 +734,22 @@ void deserialize(deserializer &s, const std::string &key, cov_result<T,Str> &sel
     Eigen::Matrix<var_type, Eigen::Dynamic, 1> discard(self.size());
     deserialize(s, "error", discard);
     s.exit();
-    deserialize(s, "cov", self.store_->data2_);
+
+    switch (self.store_->layout_.kind()) {
+    case cov_layout::DENSE:
+        deserialize(s, "cov", self.store_->data2_);
+        break;
+    case cov_layout::BLOCK_DIAGONAL:
+        s.enter("cov_blocks");
+        for (size_t i = 0; i != self.store_->blocks_.size(); ++i)
+            deserialize(s, std::to_string(i), self.store_->blocks_[i]);
+        s.exit();
+        break;
+    case cov_layout::LOW_RANK:
+        deserialize(s, "cov_sketch", self.store_->sketch_);
+        deserialize(s, "cov_diag", self.store_->diag_);
+        break;
+    }
 }
 
 template void serialize(serializer &, const std::string &key, const cov_result<double, circular_var> &);
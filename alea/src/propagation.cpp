@@ -5,23 +5,111 @@
  */
 #include <alps/alea/propagation.hpp>
 
+#include <Eigen/Eigenvalues>
+
+#include <cmath>
 #include <iostream>
 
 namespace alps { namespace alea {
 
+namespace {
+
+/**
+ * Philox4x32-10 counter-based random number generator (Salmon et al.)
+ *
+ * The random numbers are a function of the seed, the sample and the position
+ * within the sample only, so every sample may be drawn by a different thread
+ * without changing the result.
+ */
+class counter_rng
+{
+public:
+    counter_rng(uint64_t seed, uint64_t sample)
+        : key0_(uint32_t(seed)), key1_(uint32_t(seed >> 32)), sample_(sample)
+    { }
+
+    /** Returns a uniform random integer in `[0, n)` for position `pos` */
+    size_t index(uint64_t pos, size_t n) const
+    {
+        uint32_t out[4];
+        block(pos, out);
+        return ((uint64_t(out[0]) << 32) | out[1]) % n;
+    }
+
+    /** Returns two independent standard normal numbers for position `pos` */
+    void normal(uint64_t pos, double &x, double &y) const
+    {
+        uint32_t out[4];
+        block(pos, out);
+        // Box-Muller transform of two uniform numbers in (0, 1] and [0, 1)
+        const double u = (((uint64_t(out[0]) << 32 | out[1]) >> 11) + 1.0) / 9007199254740992.0;
+        const double v = ((uint64_t(out[2]) << 32 | out[3]) >> 11) / 9007199254740992.0;
+        const double r = std::sqrt(-2 * std::log(u));
+        x = r * std::cos(2 * M_PI * v);
+        y = r * std::sin(2 * M_PI * v);
+    }
+
+private:
+    void block(uint64_t pos, uint32_t out[4]) const
+    {
+        uint32_t c[4] = { uint32_t(pos), uint32_t(pos >> 32),
+                          uint32_t(sample_), uint32_t(sample_ >> 32) };
+        uint32_t k[2] = { key0_, key1_ };
+        for (int r = 0; r != 10; ++r) {
+            if (r != 0) {
+                k[0] += 0x9E3779B9U;
+                k[1] += 0xBB67AE85U;
+            }
+            const uint64_t p0 = uint64_t(0xD2511F53U) * c[0];
+            const uint64_t p1 = uint64_t(0xCD9E8D57U) * c[2];
+            c[0] = uint32_t(p1 >> 32) ^ c[1] ^ k[0];
+            c[1] = uint32_t(p1);
+            c[2] = uint32_t(p0 >> 32) ^ c[3] ^ k[1];
+            c[3] = uint32_t(p0);
+        }
+        std::copy(c, c + 4, out);
+    }
+
+    uint32_t key0_, key1_;
+    uint64_t sample_;
+};
+
+/** Fill `z` with independent standard normal numbers of sample `r` */
+void fill_normal(const counter_rng &rng, column<double> &z)
+{
+    double y;
+    for (size_t i = 0; i < size_t(z.size()); i += 2) {
+        if (i + 1 < size_t(z.size()))
+            rng.normal(i / 2, z(i), z(i + 1));
+        else
+            rng.normal(i / 2, z(i), y);
+    }
+}
+
+/** Fill `z` with independent circular normal numbers, `E[|z|^2] = 1` */
+void fill_normal(const counter_rng &rng, column<std::complex<double> > &z)
+{
+    double x, y;
+    for (size_t i = 0; i != size_t(z.size()); ++i) {
+        rng.normal(i, x, y);
+        z(i) = std::complex<double>(x, y) * M_SQRT1_2;
+    }
+}
+
+}
+
 template <typename T>
 typename eigen<T>::matrix jacobian(const transformer<T> &f, column<T> x, double dx)
 {
     size_t in_size = f.in_size();
-    size_t out_size = f.out_size();
 
-    typename eigen<T>::matrix result(out_size, in_size);
-    for (size_t j = 0; j != in_size; ++j) {
-        x(j) += dx;
-        result.col(j) = f(x);
-        x(j) -= dx;
-    }
-    result.colwise() -= f(x);
+    // evaluate f at all displaced points and at x in one batch
+    typename eigen<T>::matrix points = x.replicate(1, in_size + 1);
+    points.diagonal().array() += dx;
+
+    typename eigen<T>::matrix values = f.apply_batch(points);
+    typename eigen<T>::matrix result = values.leftCols(in_size);
+    result.colwise() -= values.col(in_size);
     result.array() /= dx;
     return result;
 }
@@ -44,13 +132,13 @@ batch_data<T> jackknife(const batch_data<T> &in, const transformer<T> &tf)
     column<T> sum_batch = in.batch().rowwise().sum();
     ptrdiff_t sum_count = in.count().sum();
 
-    // compute leave-one-out statistics and transforms
-    column<T> leaveout(in.size());
+    // compute leave-one-out statistics and transform them in one batch
+    typename eigen<T>::matrix leaveout(in.size(), in.num_batches());
     for (size_t i = 0; i != in.num_batches(); ++i) {
-        leaveout = (sum_batch - in.batch().col(i))
+        leaveout.col(i) = (sum_batch - in.batch().col(i))
                                     / (sum_count - in.count()(i));
-        res.batch().col(i) = tf(leaveout);
     }
+    res.batch() = tf.apply_batch(leaveout);
 
     res.count() = in.count();
 
@@ -73,5 +161,83 @@ template batch_data<std::complex<double> > jackknife(
                                 const batch_data<std::complex<double> > &in,
                                 const transformer<std::complex<double> > &tf);
 
-}}
+template <typename T>
+typename eigen<T>::matrix bootstrap(const batch_data<T> &in,
+                                    const transformer<T> &tf, size_t nsamples,
+                                    uint64_t seed)
+{
+    if (tf.in_size() != in.size())
+        throw size_mismatch();
+
+    // draw resample means first, then transform them in one batch
+    const size_t num_batches = in.num_batches();
+    typename eigen<T>::matrix means(in.size(), nsamples);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (long r = 0; r < long(nsamples); ++r) {
+        counter_rng rng(seed, r);
+        auto mean = means.col(r);
+        mean.setZero();
+        uint64_t count = 0;
+        for (size_t k = 0; k != num_batches; ++k) {
+            const size_t i = rng.index(k, num_batches);
+            mean += in.batch().col(i);
+            count += in.count()(i);
+        }
+        mean /= double(count);
+    }
+    return tf.apply_batch(means);
+}
+
+template eigen<double>::matrix bootstrap(
+            const batch_data<double> &, const transformer<double> &, size_t,
+            uint64_t);
+template eigen<std::complex<double> >::matrix bootstrap(
+            const batch_data<std::complex<double> > &,
+            const transformer<std::complex<double> > &, size_t, uint64_t);
 
+
+template <typename T>
+typename eigen<T>::matrix sample_prior(const column<T> &mean,
+                                       const typename eigen<T>::matrix &cov,
+                                       const transformer<T> &tf,
+                                       size_t nsamples, uint64_t seed)
+{
+    const Eigen::Index n = static_cast<Eigen::Index>(mean.size());
+    if (tf.in_size() != size_t(mean.size()) || cov.rows() != n
+            || cov.cols() != n)
+        throw size_mismatch();
+
+    // cov = V diag(lambda) V^+, where negative eigenvalues are rounding errors
+    Eigen::SelfAdjointEigenSolver<typename eigen<T>::matrix> ecov(cov);
+    const typename eigen<T>::matrix factor = ecov.eigenvectors()
+            * ecov.eigenvalues().cwiseMax(0).cwiseSqrt().template cast<T>()
+                                                            .asDiagonal();
+
+    typename eigen<T>::matrix points(mean.size(), nsamples);
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+    {
+        column<T> z(mean.size());
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+        for (long r = 0; r < long(nsamples); ++r) {
+            fill_normal(counter_rng(seed, r), z);
+            points.col(r) = mean + factor * z;
+        }
+    }
+    return tf.apply_batch(points);
+}
+
+template eigen<double>::matrix sample_prior(
+            const column<double> &, const eigen<double>::matrix &,
+            const transformer<double> &, size_t, uint64_t);
+template eigen<std::complex<double> >::matrix sample_prior(
+            const column<std::complex<double> > &,
+            const eigen<std::complex<double> >::matrix &,
+            const transformer<std::complex<double> > &, size_t, uint64_t);
+
+}}
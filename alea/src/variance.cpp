@@ -154,9 +154,8 @@ var_acc<T,Str> &var_acc<T,Str>::operator<<(const var_result<T,Str> &other)
 template <typename T, typename Str>
 var_result<T,Str> var_acc<T,Str>::result() const
 {
-    internal::check_valid(*this);
     var_result<T,Str> result;
-    var_acc<T,Str>(*this).finalize_to(result, nullptr);
+    snapshot_to(result, nullptr);
     return result;
 }
 
@@ -187,15 +186,41 @@ void var_acc<T,Str>::finalize_to(var_result<T,Str> &result, var_acc<T,Str> *casc
 }
 
 template <typename T, typename Str>
-void var_acc<T,Str>::add_bundle(var_acc<T,Str> *cascade)
+void var_acc<T,Str>::snapshot_to(var_result<T,Str> &result, bundle<T> *carry) const
+{
+    internal::check_valid(*this);
+
+    // the partial batch is that of finalize_to(): the current batch plus
+    // what the levels below propagate upwards
+    const bundle<T> *leftover = &current_;
+    if (carry != nullptr) {
+        carry->sum() += current_.sum();
+        carry->count() += current_.count();
+        leftover = carry;
+    }
+
+    result.store_.reset(new var_data<T,Str>(*store_));
+    if (leftover->count() != 0)
+        add_bundle_to(*result.store_, *leftover);
+    result.store_->convert_to_mean();
+}
+
+template <typename T, typename Str>
+void var_acc<T,Str>::add_bundle_to(var_data<T,Str> &store, const bundle<T> &batch)
 {
     typename bind<Str, T>::abs2_op abs2;
 
     // add batch to average and squared
-    store_->data().noalias() += current_.sum();
-    store_->data2().noalias() += current_.sum().unaryExpr(abs2) / current_.count();
-    store_->count() += current_.count();
-    store_->count2() += current_.count() * current_.count();
+    store.data().noalias() += batch.sum();
+    store.data2().noalias() += batch.sum().unaryExpr(abs2) / batch.count();
+    store.count() += batch.count();
+    store.count2() += batch.count() * batch.count();
+}
+
+template <typename T, typename Str>
+void var_acc<T,Str>::add_bundle(var_acc<T,Str> *cascade)
+{
+    add_bundle_to(*store_, current_);
 
     // add batch mean also to uplevel
     if (cascade != nullptr)
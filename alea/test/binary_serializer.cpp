@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#include <alps/alea.hpp>
+
+#include <alps/testing/unique_file.hpp>
+#include "gtest/gtest.h"
+#include "dataset.hpp"
+
+#include <fstream>
+#include <sstream>
+
+template <typename Acc>
+class twogauss_binary_case
+    : public ::testing::Test
+{
+public:
+    typedef typename alps::alea::traits<Acc>::value_type value_type;
+    typedef typename alps::alea::traits<Acc>::result_type result_type;
+
+    twogauss_binary_case() { }
+
+    result_type make_result() const
+    {
+        Acc acc(2);
+        for (size_t i = 0; i != twogauss_count; ++i)
+            acc << std::vector<value_type>{twogauss_data[i][0], twogauss_data[i][1]};
+        return acc.finalize();
+    }
+
+    void test_buffer()
+    {
+        result_type in = make_result();
+        std::ostringstream out;
+        {
+            alps::alea::binary_serializer ser(out);
+            serialize(ser, "first", in);
+            serialize(ser, "second", in);
+        }
+        const std::string buffer = out.str();
+
+        Acc out_acc(2);
+        result_type res = out_acc.result();
+        alps::alea::binary_deserializer ser(buffer.data(), buffer.size());
+        deserialize(ser, "second", res);
+        EXPECT_EQ(in, res);
+    }
+
+    void test_file()
+    {
+        result_type in = make_result();
+        alps::testing::unique_file ufile("binary_serializer.bin.",
+                                         alps::testing::unique_file::REMOVE_AFTER);
+        {
+            std::ofstream out(ufile.name(), std::ios::binary);
+            alps::alea::binary_serializer ser(out);
+            serialize(ser, "res", in);
+        }
+
+        Acc out_acc(2);
+        result_type res = out_acc.result();
+        alps::alea::binary_deserializer ser(ufile.name());
+        deserialize(ser, "res", res);
+        EXPECT_EQ(in, res);
+    }
+};
+
+using namespace alps::alea;
+
+typedef ::testing::Types<
+        mean_acc<double>
+      , var_acc<std::complex<double> >
+      , cov_acc<double>
+      , cov_acc<std::complex<double>, elliptic_var>
+      , autocorr_acc<double>
+      , batch_acc<std::complex<double> >
+    > binary_serializable;
+
+TYPED_TEST_CASE(twogauss_binary_case, binary_serializable);
+TYPED_TEST(twogauss_binary_case, test_buffer) { this->test_buffer(); }
+TYPED_TEST(twogauss_binary_case, test_file) { this->test_file(); }
+
+TEST(binary_serializer, zero_copy_view)
+{
+    batch_acc<double> acc(2, 16);
+    for (size_t i = 0; i != twogauss_count; ++i)
+        acc << std::vector<double>{twogauss_data[i][0], twogauss_data[i][1]};
+    batch_result<double> res = acc.finalize();
+
+    std::ostringstream out;
+    {
+        binary_serializer ser(out);
+        serialize(ser, "res", res);
+    }
+    const std::string buffer = out.str();
+    binary_deserializer ser(buffer.data(), buffer.size());
+
+    // the view points into the buffer and is aligned relative to its start
+    ndview<const double> sum = ser.view<double>("res/batch/sum");
+    const char *where = reinterpret_cast<const char *>(sum.data());
+    EXPECT_TRUE(where > buffer.data() && where < buffer.data() + buffer.size());
+    EXPECT_EQ(0u, (where - buffer.data()) % binary_serializer::alignment);
+
+    ASSERT_EQ(2u, sum.ndim());
+    Eigen::Map<const Eigen::MatrixXd> batch(sum.data(), sum.shape()[1],
+                                            sum.shape()[0]);
+    EXPECT_TRUE(res.store().batch() == batch);
+
+    EXPECT_EQ(std::vector<size_t>({16}), ser.get_shape("res/batch/count"));
+    EXPECT_THROW(ser.view<uint64_t>("res/batch/sum"), std::runtime_error);
+    EXPECT_THROW(ser.view<double>("res/batch/nothing"), std::runtime_error);
+}
+
+TEST(binary_serializer, invalid)
+{
+    const std::string garbage = "this is not a binary container";
+    EXPECT_THROW(binary_deserializer(garbage.data(), garbage.size()),
+                 std::runtime_error);
+
+    std::ostringstream out;
+    {
+        binary_serializer ser(out);
+        column<double> x = column<double>::Ones(10);
+        serialize(ser, "x", x);
+    }
+    const std::string truncated = out.str().substr(0, out.str().size() - 8);
+    EXPECT_THROW(binary_deserializer(truncated.data(), truncated.size()),
+                 std::runtime_error);
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#include <alps/alea/covariance.hpp>
+#include <alps/alea/hdf5.hpp>
+#include <alps/alea/serialize.hpp>
+
+#include <alps/testing/near.hpp>
+#include <alps/testing/unique_file.hpp>
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <complex>
+
+using alps::alea::cov_layout;
+
+/**
+ * Compares accumulators of a random vector with a given covariance layout
+ * to a dense accumulator.  The random vector has 3 independent blocks of
+ * 4 components each, and rank 2 within each block.
+ */
+template <typename T>
+class cov_layout_case
+    : public ::testing::Test
+{
+public:
+    typedef typename alps::alea::eigen<T>::matrix matrix_type;
+
+    cov_layout_case()
+        : mixing_(matrix_type::Zero(12, 6))
+    {
+        srand48(42);
+        for (size_t b = 0; b != 3; ++b)
+            for (size_t i = 0; i != 4; ++i)
+                for (size_t j = 0; j != 2; ++j)
+                    mixing_(4 * b + i, 2 * b + j) = draw();
+    }
+
+    void fill(alps::alea::cov_acc<T> &acc, alps::alea::cov_acc<T> &dense)
+    {
+        srand48(17);
+        for (size_t n = 0; n != 500; ++n) {
+            alps::alea::column<T> z(6);
+            for (size_t j = 0; j != 6; ++j)
+                z(j) = draw();
+            alps::alea::column<T> x = mixing_ * z;
+            acc << x;
+            dense << x;
+        }
+    }
+
+    void test_block_diagonal()
+    {
+        alps::alea::cov_acc<T> acc(12, 1,
+                            cov_layout::block_diagonal({4, 4, 4}));
+        alps::alea::cov_acc<T> dense(12);
+        fill(acc, dense);
+
+        alps::alea::cov_result<T> res = acc.finalize();
+        alps::alea::cov_result<T> dense_res = dense.finalize();
+        EXPECT_EQ(3u, res.store().blocks().size());
+        EXPECT_EQ(0, res.store().data2().size());
+
+        ALPS_EXPECT_NEAR(dense_res.mean(), res.mean(), 1e-12);
+        ALPS_EXPECT_NEAR(dense_res.stderror(), res.stderror(), 1e-12);
+
+        // blocks are exact, the rest vanishes
+        matrix_type cov = res.cov(), dense_cov = dense_res.cov();
+        for (size_t b = 0; b != 3; ++b) {
+            ALPS_EXPECT_NEAR(dense_cov.block(4 * b, 4 * b, 4, 4),
+                             cov.block(4 * b, 4 * b, 4, 4), 1e-12);
+        }
+        EXPECT_EQ(0, std::abs(cov(0, 4)));
+        EXPECT_EQ(0, std::abs(cov(11, 7)));
+    }
+
+    void test_low_rank()
+    {
+        // The random vector has rank 6, so a sketch of rank 8 is exact
+        alps::alea::cov_acc<T> acc(12, 1, cov_layout::low_rank(8, 3));
+        alps::alea::cov_acc<T> dense(12);
+        fill(acc, dense);
+
+        alps::alea::cov_result<T> res = acc.finalize();
+        alps::alea::cov_result<T> dense_res = dense.finalize();
+        EXPECT_EQ(12, res.store().sketch().rows());
+        EXPECT_EQ(8, res.store().sketch().cols());
+
+        ALPS_EXPECT_NEAR(dense_res.mean(), res.mean(), 1e-12);
+        ALPS_EXPECT_NEAR(dense_res.stderror(), res.stderror(), 1e-12);
+        ALPS_EXPECT_NEAR(dense_res.cov(), res.cov(), 1e-8);
+    }
+
+    void test_rank_update()
+    {
+        // bundles are added as rank-k updates, so compare to a direct
+        // computation, with intermediate results in between
+        alps::alea::cov_acc<T> acc(12, 3);
+        alps::alea::cov_acc<T> dense(12);
+        fill(acc, dense);
+        EXPECT_EQ(500u, acc.result().count());
+        fill(acc, dense);
+
+        matrix_type data(12, 1000);
+        srand48(17);
+        for (size_t n = 0; n != 1000; ++n) {
+            if (n == 500)
+                srand48(17);
+            alps::alea::column<T> z(6);
+            for (size_t j = 0; j != 6; ++j)
+                z(j) = draw();
+            data.col(n) = mixing_ * z;
+        }
+
+        // batches of 3 data points, the last one with one point only
+        matrix_type batches(12, 334);
+        Eigen::VectorXd counts(334);
+        for (size_t b = 0; b != 334; ++b) {
+            const size_t n = std::min<size_t>(3, 1000 - 3 * b);
+            batches.col(b) = data.middleCols(3 * b, n).rowwise().sum();
+            counts(b) = n;
+        }
+        alps::alea::column<T> mean = data.rowwise().sum() / 1000.;
+        matrix_type cov = matrix_type::Zero(12, 12);
+        for (size_t b = 0; b != 334; ++b) {
+            alps::alea::column<T> diff = batches.col(b) - counts(b) * mean;
+            cov += diff * diff.adjoint() / counts(b);
+        }
+        cov /= 1000. - counts.squaredNorm() / 1000.;
+
+        alps::alea::cov_result<T> res = acc.finalize();
+        ALPS_EXPECT_NEAR(mean, res.mean(), 1e-12);
+        ALPS_EXPECT_NEAR(cov, res.cov(), 1e-12);
+        EXPECT_TRUE(res.cov() == res.cov().adjoint());
+    }
+
+    void test_merge_serialize()
+    {
+        const cov_layout layout = cov_layout::block_diagonal({4, 8});
+        alps::alea::cov_acc<T> acc(12, 1, layout);
+        alps::alea::cov_acc<T> dense(12);
+        fill(acc, dense);
+
+        // merging requires the same layout
+        alps::alea::cov_result<T> res = acc.result();
+        EXPECT_THROW(dense << res, alps::alea::size_mismatch);
+        acc << res;
+        res = acc.finalize();
+
+        EXPECT_EQ(res, roundtrip(res));
+    }
+
+    void test_serialize_layouts()
+    {
+        const cov_layout layouts[] = { cov_layout(),
+                                       cov_layout::block_diagonal({4, 4, 4}),
+                                       cov_layout::low_rank(8, 3) };
+        for (const cov_layout &layout : layouts) {
+            alps::alea::cov_acc<T> acc(12, 1, layout);
+            alps::alea::cov_acc<T> dense(12);
+            fill(acc, dense);
+
+            alps::alea::cov_result<T> res = acc.finalize();
+            alps::alea::cov_result<T> res2 = roundtrip(res);
+            EXPECT_TRUE(layout == res2.store().layout());
+            EXPECT_EQ(res, res2);
+            ALPS_EXPECT_NEAR(res.cov(), res2.cov(), 1e-12);
+        }
+    }
+
+    void test_read_legacy()
+    {
+        // results written before the layout was stored have no "@layout"
+        alps::alea::cov_acc<T> acc(12);
+        alps::alea::cov_acc<T> dense(12);
+        fill(acc, dense);
+        alps::alea::cov_result<T> res = acc.finalize();
+
+        alps::testing::unique_file ufile("cov_layout.h5.",
+                                         alps::testing::unique_file::REMOVE_AFTER);
+        {
+            alps::hdf5::archive ar(ufile.name(), "w");
+            alps::alea::hdf5_serializer ser(ar, "");
+            ser.enter("res");
+            alps::serialization::serialize(ser, "@size", uint64_t(res.size()));
+            alps::serialization::serialize(ser, "count", res.count());
+            alps::serialization::serialize(ser, "count2", res.count2());
+            ser.enter("mean");
+            alps::serialization::serialize(ser, "value", res.mean());
+            alps::serialization::serialize(ser, "error", res.stderror());
+            ser.exit();
+            alps::serialization::serialize(ser, "cov", res.cov());
+            ser.exit();
+        }
+        alps::alea::cov_result<T> res2;
+        {
+            alps::hdf5::archive ar(ufile.name(), "r");
+            alps::alea::hdf5_serializer ser(ar, "");
+            alps::alea::deserialize(ser, "res", res2);
+        }
+        EXPECT_TRUE(cov_layout() == res2.store().layout());
+        EXPECT_EQ(res, res2);
+        ALPS_EXPECT_NEAR(res.cov(), res2.cov(), 1e-12);
+    }
+
+private:
+    /** Writes result to file and reads it back into a default result */
+    static alps::alea::cov_result<T> roundtrip(const alps::alea::cov_result<T> &res)
+    {
+        alps::testing::unique_file ufile("cov_layout.h5.",
+                                         alps::testing::unique_file::REMOVE_AFTER);
+        {
+            alps::hdf5::archive ar(ufile.name(), "w");
+            alps::alea::hdf5_serializer ser(ar, "");
+            alps::alea::serialize(ser, "res", res);
+        }
+        alps::alea::cov_result<T> res2;
+        {
+            alps::hdf5::archive ar(ufile.name(), "r");
+            alps::alea::hdf5_serializer ser(ar, "");
+            alps::alea::deserialize(ser, "res", res2);
+        }
+        return res2;
+    }
+
+    static T draw()
+    {
+        T value;
+        make_value(drand48() - 0.5, drand48() - 0.5, value);
+        return value;
+    }
+
+    static void make_value(double x, double, double &value) { value = x; }
+
+    static void make_value(double x, double y, std::complex<double> &value)
+    {
+        value = std::complex<double>(x, y);
+    }
+
+    matrix_type mixing_;
+};
+
+typedef ::testing::Types<double, std::complex<double> > value_types;
+
+TYPED_TEST_CASE(cov_layout_case, value_types);
+TYPED_TEST(cov_layout_case, test_block_diagonal) { this->test_block_diagonal(); }
+TYPED_TEST(cov_layout_case, test_low_rank) { this->test_low_rank(); }
+TYPED_TEST(cov_layout_case, test_rank_update) { this->test_rank_update(); }
+TYPED_TEST(cov_layout_case, test_merge_serialize) { this->test_merge_serialize(); }
+TYPED_TEST(cov_layout_case, test_serialize_layouts) { this->test_serialize_layouts(); }
+TYPED_TEST(cov_layout_case, test_read_legacy) { this->test_read_legacy(); }
+
+TEST(cov_layout, block_size_mismatch)
+{
+    EXPECT_THROW(alps::alea::cov_acc<double>(5, 1, cov_layout::block_diagonal({2, 2})),
+                 alps::alea::size_mismatch);
+}
+
+TEST(cov_layout, elliptic_low_rank)
+{
+    // The random vector has (real) rank 4, so a sketch of rank 3 is exact
+    typedef alps::alea::cov_acc<std::complex<double>, alps::alea::elliptic_var> acc_type;
+    acc_type acc(6, 1, cov_layout::low_rank(3, 5));
+    acc_type dense(6);
+
+    srand48(23);
+    Eigen::MatrixXcd mixing(6, 2);
+    for (size_t i = 0; i != 6; ++i)
+        for (size_t j = 0; j != 2; ++j)
+            mixing(i, j) = std::complex<double>(drand48() - 0.5, drand48() - 0.5);
+    for (size_t n = 0; n != 200; ++n) {
+        Eigen::VectorXcd z(2);
+        for (size_t j = 0; j != 2; ++j)
+            z(j) = std::complex<double>(drand48() - 0.5, drand48() - 0.5);
+        alps::alea::column<std::complex<double> > x = mixing * z;
+        acc << x;
+        dense << x;
+    }
+
+    auto res = acc.finalize();
+    auto dense_res = dense.finalize();
+    auto cov = res.cov(), dense_cov = dense_res.cov();
+    for (size_t i = 0; i != 6; ++i) {
+        for (size_t j = 0; j != 6; ++j) {
+            EXPECT_NEAR(dense_cov(i, j).rere(), cov(i, j).rere(), 1e-8);
+            EXPECT_NEAR(dense_cov(i, j).reim(), cov(i, j).reim(), 1e-8);
+            EXPECT_NEAR(dense_cov(i, j).imre(), cov(i, j).imre(), 1e-8);
+            EXPECT_NEAR(dense_cov(i, j).imim(), cov(i, j).imim(), 1e-8);
+        }
+    }
+}
@@ -10,6 +10,7 @@
 #include <alps/alea/autocorr.hpp>
 #include <alps/alea/batch.hpp>
 
+#include <alps/testing/near.hpp>
 #include "alps/utilities/gtest_par_xml_output.hpp"
 #include "gtest/gtest.h"
 #include "dataset.hpp"
@@ -124,6 +125,99 @@ TYPED_TEST_CASE(mpi_twogauss_case, test_types);
 
 TYPED_TEST(mpi_twogauss_case, test_mean) { this->test_mean(); }
 
+class mpi_packed_case
+    : public ::testing::Test
+{
+public:
+    mpi_packed_case()
+        : mean_acc_(2), var_acc_(2), auto_acc_(2), batch_acc_(2)
+    {
+        alps::alea::mpi_reducer red(alps::mpi::communicator(), 0);
+        alps::alea::reducer_setup setup = red.get_setup();
+
+        std::vector<double> curr(2);
+        for (size_t i = setup.pos; i < twogauss_count; i += setup.count) {
+            std::copy(twogauss_data[i], twogauss_data[i+1], curr.begin());
+            mean_acc_ << curr;
+            var_acc_ << curr;
+            auto_acc_ << curr;
+            batch_acc_ << curr;
+        }
+    }
+
+    void test_reduce_all(bool hierarchical, bool overlap)
+    {
+        alps::alea::mpi_reducer red(alps::mpi::communicator(), 0);
+        alps::alea::packed_mpi_reducer packed(alps::mpi::communicator(), 0,
+                                              hierarchical);
+
+        // reference: reduce one by one
+        alps::alea::mean_result<double> mean_ref = mean_acc_.result();
+        alps::alea::var_result<double> var_ref = var_acc_.result();
+        alps::alea::autocorr_result<double> auto_ref = auto_acc_.result();
+        alps::alea::batch_result<double> batch_ref = batch_acc_.result();
+        mean_ref.reduce(red);
+        var_ref.reduce(red);
+        auto_ref.reduce(red);
+        batch_ref.reduce(red);
+
+        alps::alea::mean_result<double> mean_res = mean_acc_.result();
+        alps::alea::var_result<double> var_res = var_acc_.result();
+        alps::alea::autocorr_result<double> auto_res = auto_acc_.result();
+        alps::alea::batch_result<double> batch_res = batch_acc_.result();
+        if (overlap) {
+            mean_res.reduce(packed, true, false);
+            var_res.reduce(packed, true, false);
+            auto_res.reduce(packed, true, false);
+            batch_res.reduce(packed, true, false);
+            packed.start_commit();
+            packed.finish_commit();
+            mean_res.reduce(packed, false, true);
+            var_res.reduce(packed, false, true);
+            auto_res.reduce(packed, false, true);
+            batch_res.reduce(packed, false, true);
+        } else {
+            alps::alea::reduce_all(packed, mean_res, var_res, auto_res,
+                                   batch_res);
+        }
+
+        alps::alea::reducer_setup setup = packed.get_setup();
+        EXPECT_EQ(setup.have_result, mean_res.valid());
+        EXPECT_EQ(setup.have_result, auto_res.valid());
+        if (setup.have_result) {
+            // the order of summation may differ
+            expect_near(mean_ref, mean_res);
+            expect_near_var(var_ref, var_res);
+            expect_near_var(auto_ref, auto_res);
+            expect_near(batch_ref, batch_res);
+        }
+    }
+
+    template <typename Result>
+    void expect_near(const Result &expected, const Result &actual)
+    {
+        EXPECT_EQ(expected.count(), actual.count());
+        ALPS_EXPECT_NEAR(expected.mean(), actual.mean(), 1e-12);
+    }
+
+    template <typename Result>
+    void expect_near_var(const Result &expected, const Result &actual)
+    {
+        expect_near(expected, actual);
+        ALPS_EXPECT_NEAR(expected.var(), actual.var(), 1e-12);
+    }
+
+private:
+    alps::alea::mean_acc<double> mean_acc_;
+    alps::alea::var_acc<double> var_acc_;
+    alps::alea::autocorr_acc<double> auto_acc_;
+    alps::alea::batch_acc<double> batch_acc_;
+};
+
+TEST_F(mpi_packed_case, reduce_all) { test_reduce_all(false, false); }
+TEST_F(mpi_packed_case, hierarchical) { test_reduce_all(true, false); }
+TEST_F(mpi_packed_case, overlap) { test_reduce_all(true, true); }
+
 int main(int argc, char** argv)
 {
    alps::mpi::environment env(argc, argv, false);
@@ -163,6 +163,39 @@ struct transformer_ratio : public alps::alea::transformer<T>
     bool is_linear() const override { return false; }
 };
 
+TEST(transformer, batch)
+{
+    Eigen::MatrixXd in = Eigen::MatrixXd::Random(2, 5);
+    in.row(1).array() += 2;
+
+    // default batch evaluation calls the transformer for each column
+    transformer_ratio<double> tf;
+    Eigen::MatrixXd out = tf.apply_batch(in);
+    ASSERT_EQ(1, out.rows());
+    ASSERT_EQ(5, out.cols());
+    for (int j = 0; j != 5; ++j)
+        EXPECT_EQ(in(0, j) / in(1, j), out(0, j));
+
+    EXPECT_THROW(tf.apply_batch(Eigen::MatrixXd(3, 5)), alps::alea::size_mismatch);
+
+    // linear transformers evaluate the batch as a matrix product
+    Eigen::MatrixXd tfmat = Eigen::MatrixXd::Random(2, 2);
+    alps::alea::linear_transformer<double> lin = tfmat;
+    ALPS_EXPECT_NEAR(tfmat * in, lin.apply_batch(in), 1e-12);
+}
+
+TEST(jacobian, ratio)
+{
+    transformer_ratio<double> tf;
+    Eigen::VectorXd x(2);
+    x << 3, 2;
+    Eigen::MatrixXd jac = alps::alea::jacobian<double>(tf, x, 1e-6);
+
+    Eigen::MatrixXd expected(1, 2);
+    expected << 1 / x(1), -x(0) / (x(1) * x(1));
+    ALPS_EXPECT_NEAR(expected, jac, 1e-5);
+}
+
 TEST(twogauss, ratio) {
     alps::alea::batch_acc<double> acc(2);
 
@@ -239,3 +272,79 @@ typedef ::testing::Types<
 
 TYPED_TEST_CASE(twogauss_batched_id_case, batchable);
 TYPED_TEST(twogauss_batched_id_case, test_result) { this->test_result(); }
+
+TEST(twogauss, bootstrap_ratio) {
+    alps::alea::batch_acc<double> acc(2);
+
+    for (size_t i = 0; i != twogauss_count; ++i) {
+        Eigen::Map<Eigen::Vector2d> dat((double *)twogauss_data[i], 2);
+        acc << alps::alea::column<double>(dat);
+    }
+
+    alps::alea::batch_result<double> res = acc.finalize();
+
+    transformer_ratio<double> tf;
+    alps::alea::cov_result<double> boot_res =
+        alps::alea::transform(alps::alea::bootstrap_prop(4096, 7), tf, res);
+    alps::alea::batch_result<double> jack_res =
+        alps::alea::transform(alps::alea::jackknife_prop(), tf, res);
+
+    EXPECT_NEAR(boot_res.mean()[0],
+                twogauss_mean[0] / twogauss_mean[1],
+                boot_res.stderror()[0]);
+    EXPECT_NEAR(jack_res.stderror()[0], boot_res.stderror()[0],
+                0.2 * jack_res.stderror()[0]);
+
+    // resampling is reproducible and only depends on the seed
+    alps::alea::cov_result<double> again =
+        alps::alea::transform(alps::alea::bootstrap_prop(4096, 7), tf, res);
+    alps::alea::cov_result<double> other =
+        alps::alea::transform(alps::alea::bootstrap_prop(4096, 8), tf, res);
+    EXPECT_EQ(boot_res.cov()(0, 0), again.cov()(0, 0));
+    EXPECT_NE(boot_res.cov()(0, 0), other.cov()(0, 0));
+}
+
+TEST(twogauss, sampling_rotate)
+{
+    Eigen::Matrix2d rot;
+    rot << 1, 2, 3, 4;
+
+    alps::alea::cov_acc<double> acc(2);
+    for (size_t i = 0; i != twogauss_count; ++i) {
+        Eigen::Map<Eigen::Vector2d> dat((double *)twogauss_data[i], 2);
+        acc << alps::alea::column<double>(dat);
+    }
+    alps::alea::cov_result<double> res = acc.finalize();
+
+    // for a linear transform, sampling approximates linear propagation
+    alps::alea::linear_transformer<double> tf(rot);
+    alps::alea::cov_result<double> lin_res =
+                alps::alea::transform(alps::alea::linear_prop(), tf, res);
+    alps::alea::cov_result<double> samp_res =
+                alps::alea::transform(alps::alea::sampling_prop(8192), tf, res);
+
+    ALPS_EXPECT_NEAR(lin_res.mean(), samp_res.mean(), 1e-12);
+    EXPECT_NEAR(0, (samp_res.cov() - lin_res.cov()).norm(),
+                0.1 * lin_res.cov().norm());
+    EXPECT_EQ(lin_res.observations(), samp_res.observations());
+}
+
+TEST(sampling, complex_var)
+{
+    typedef std::complex<double> complex;
+    alps::alea::var_acc<complex> acc(2);
+    for (size_t i = 0; i != twogauss_count; ++i)
+        acc << alps::alea::column<complex>(Eigen::Vector2cd(
+                   complex(twogauss_data[i][0], twogauss_data[i][1]),
+                   complex(twogauss_data[i][1], -twogauss_data[i][0])));
+    alps::alea::var_result<complex> res = acc.finalize();
+
+    transformer_id<complex> tf(2);
+    alps::alea::cov_result<complex> samp_res =
+                alps::alea::transform(alps::alea::sampling_prop(8192), tf, res);
+
+    ALPS_EXPECT_NEAR(res.mean(), samp_res.mean(), 1e-12);
+    for (size_t i = 0; i != 2; ++i)
+        EXPECT_NEAR(res.stderror()[i], samp_res.stderror()[i],
+                    0.05 * res.stderror()[i]);
+}
@@ -93,6 +93,18 @@ public:
         test_result();    // keeps mean constant
     }
 
+    void test_snapshot()
+    {
+        result_type snapshot = this->acc().result();
+        this->acc() << std::vector<value_type>(2, 0.5);
+        result_type later = this->acc().result();
+        EXPECT_FALSE(snapshot == later);
+
+        // the snapshot did not change the accumulator
+        result_type res = this->acc().finalize();
+        EXPECT_TRUE(later == res);
+    }
+
     void test_resize()
     {
         this->acc().set_size(3);
@@ -163,6 +175,8 @@ TYPED_TEST(twogauss_mean_case, test_finalize) { this->test_finalize(); }
 
 TYPED_TEST(twogauss_mean_case, test_lifecycle) { this->test_lifecycle(); }
 
+TYPED_TEST(twogauss_mean_case, test_snapshot) { this->test_snapshot(); }
+
 TYPED_TEST(twogauss_mean_case, test_serialize) { this->test_serialize(); }
 
 TYPED_TEST(twogauss_mean_case, test_sederialize) { this->test_sederialize(); }
@@ -230,6 +244,14 @@ public:
         EXPECT_NEAR(obs_err[0], twogauss_block40_stderr[0], 1e-6);
         EXPECT_NEAR(obs_err[1], twogauss_block40_stderr[1], 1e-6);
     }
+
+    void test_snapshot()
+    {
+        // the snapshot includes the partial batch, like finalize()
+        result_type res = this->acc().result();
+        EXPECT_TRUE(this->acc().valid());
+        EXPECT_TRUE(res == this->acc().finalize());
+    }
 };
 
 typedef ::testing::Types<
@@ -239,6 +261,7 @@ typedef ::testing::Types<
 
 TYPED_TEST_CASE(twogauss_block_case, has_var);
 TYPED_TEST(twogauss_block_case, test) { this->test(); }
+TYPED_TEST(twogauss_block_case, test_snapshot) { this->test_snapshot(); }
 
 // int main(int argc, char **argv)
 // {
@@ -273,6 +273,14 @@ macro(add_testing)
   endif (Testing)
 endmacro(add_testing)
 
+# Adds the module's `benchmark` subdirectory if `Benchmarks` is enabled (requires Google Benchmark)
+macro(add_benchmarks)
+  option(Benchmarks "Build benchmarks (requires Google Benchmark)" OFF)
+  if (Benchmarks AND EXISTS ${PROJECT_SOURCE_DIR}/benchmark)
+    add_subdirectory(benchmark)
+  endif (Benchmarks AND EXISTS ${PROJECT_SOURCE_DIR}/benchmark)
+endmacro(add_benchmarks)
+
 macro(gen_documentation)
   set(DOXYFILE_EXTRA_SOURCES "${DOXYFILE_EXTRA_SOURCES} ${PROJECT_SOURCE_DIR}/include ${PROJECT_SOURCE_DIR}/src" PARENT_SCOPE)
   option(Documentation "Build documentation" OFF)
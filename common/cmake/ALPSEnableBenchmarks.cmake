@@ -0,0 +1,29 @@
+#
+# This cmake script adds benchmarks to a project from the 'benchmark' directory in the ALPS module
+#
+
+# Find Google Benchmark (https://github.com/google/benchmark)
+if (NOT benchmarks_are_already_enabled)
+    find_package(benchmark REQUIRED)
+    message(STATUS "Google Benchmark found in ${benchmark_DIR}")
+    set(benchmarks_are_already_enabled TRUE)
+endif(NOT benchmarks_are_already_enabled)
+
+# custom function to add a benchmark executable linked to Google Benchmark
+# arg0 - benchmark (assume the source is ${bench}.cpp)
+# optional arg: SRCS source1 source2... : additional source files
+# The benchmark executable is not registered with ctest.
+# Affected by: ${PROJECT_NAME}_DEPENDS variable.
+function(alps_add_benchmark bench)
+    include(CMakeParseArguments)
+    cmake_parse_arguments("arg" "" "" "SRCS" ${ARGN})
+    set(usage_help_ "alps_add_benchmark(benchname [SRCS extra_sources...])")
+    if (arg_UNPARSED_ARGUMENTS)
+        message(FATAL_ERROR
+            "Unknown parameters: ${arg_UNPARSED_ARGUMENTS}\n"
+            "Usage: ${usage_help_}")
+    endif()
+
+    add_executable(${bench} ${bench}.cpp ${arg_SRCS})
+    target_link_libraries(${bench} ${PROJECT_NAME} ${${PROJECT_NAME}_DEPENDS} benchmark::benchmark_main)
+endfunction(alps_add_benchmark)
@@ -0,0 +1,35 @@
+#
+# This cmake script enables OpenMP support in ALPSCore.
+# The multithreaded code paths (alea propagation and transforms,
+# gf Fourier transforms and Dyson solvers) are compiled with OpenMP
+# if it is found; otherwise they run serially.
+#
+
+# configurable option
+option(ENABLE_OPENMP "Enable OpenMP for multithreaded code paths" ON)
+set(ALPS_HAVE_OPENMP false)
+if (ENABLE_OPENMP)
+  find_package(OpenMP)
+  if (OpenMP_CXX_FOUND)
+    set(ALPS_HAVE_OPENMP TRUE)
+    message(STATUS "OpenMP : Found, flags ${OpenMP_CXX_FLAGS}")
+    # CMake < 3.9 does not define the imported target
+    if (NOT TARGET OpenMP::OpenMP_CXX)
+      add_library(OpenMP::OpenMP_CXX INTERFACE IMPORTED)
+      set_property(TARGET OpenMP::OpenMP_CXX PROPERTY INTERFACE_COMPILE_OPTIONS ${OpenMP_CXX_FLAGS})
+      set_property(TARGET OpenMP::OpenMP_CXX PROPERTY INTERFACE_LINK_LIBRARIES ${OpenMP_CXX_FLAGS})
+    endif()
+  else()
+    message(STATUS "OpenMP not found, multithreaded code paths will run serially.")
+  endif()
+else()
+  message(STATUS "OpenMP disabled. Set ENABLE_OPENMP to ON to enable")
+endif()
+
+# Link OpenMP to the current module (target ${PROJECT_NAME}), if available
+macro(add_openmp)
+  if (ALPS_HAVE_OPENMP)
+    target_link_libraries(${PROJECT_NAME} PUBLIC OpenMP::OpenMP_CXX)
+    set(ALPS_MODULE_USES_OPENMP TRUE)
+  endif()
+endmacro(add_openmp)
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+#include <alps/gf/gf_base.hpp>
+#include <alps/gf/mesh.hpp>
+
+#include <Eigen/Dense>
+
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+namespace alps {
+namespace gf {
+
+  namespace detail {
+
+    /// Row-major matrix of the orbital block, of fixed size N or of dynamic size
+    template<int N>
+    using block_matrix = Eigen::Matrix<std::complex<double>, N, N, Eigen::RowMajor>;
+
+    /// Inversion of `batch` contiguous n x n matrices in place
+    template<int N>
+    struct invert_blocks_kernel {
+      static void apply(std::complex<double> *data, size_t n, size_t batch) {
+        const long nb = long(batch);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+        for (long b = 0; b < nb; ++b) {
+          Eigen::Map<block_matrix<N> > A(data + size_t(b) * n * n, n, n);
+          const block_matrix<N> M = A;
+          A = M.inverse();
+        }
+      }
+    };
+
+    /**
+     * Dyson equation G = [iw + mu - H(k) - Sigma]^{-1} for all nw x nk blocks of G;
+     * Sigma is given for each (w, k) if `sigma_local` is false, and for each w only otherwise.
+     */
+    template<int N>
+    struct dyson_kernel {
+      static void apply(std::complex<double> *g, const std::complex<double> *sigma, const std::complex<double> *hk,
+                        const std::vector<double> &omega, size_t nk, size_t n, double mu, bool sigma_local) {
+        const size_t n2 = n * n;
+        const long nb = long(omega.size() * nk);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+        for (long b = 0; b < nb; ++b) {
+          const size_t w = size_t(b) / nk;
+          const size_t k = size_t(b) % nk;
+          Eigen::Map<const block_matrix<N> > H(hk + k * n2, n, n);
+          Eigen::Map<const block_matrix<N> > S(sigma + (sigma_local ? w : size_t(b)) * n2, n, n);
+          block_matrix<N> A = -H - S;
+          A.diagonal().array() += std::complex<double>(mu, omega[w]);
+          Eigen::Map<block_matrix<N> >(g + size_t(b) * n2, n, n) = A.inverse();
+        }
+      }
+    };
+
+    /**
+     * Call `Kernel<n>::apply` for blocks up to 8x8, and `Kernel<Eigen::Dynamic>::apply` for larger ones.
+     *
+     * For fixed sizes, Eigen unrolls and vectorizes the inversion (by cofactors up to 4x4, by an LU
+     * decomposition otherwise), and no temporaries are allocated on the heap.
+     */
+    template<template<int> class Kernel, typename ...Args>
+    void dispatch_block_size(size_t n, Args &&...args) {
+      switch (n) {
+        case 1: Kernel<1>::apply(std::forward<Args>(args)...); break;
+        case 2: Kernel<2>::apply(std::forward<Args>(args)...); break;
+        case 3: Kernel<3>::apply(std::forward<Args>(args)...); break;
+        case 4: Kernel<4>::apply(std::forward<Args>(args)...); break;
+        case 5: Kernel<5>::apply(std::forward<Args>(args)...); break;
+        case 6: Kernel<6>::apply(std::forward<Args>(args)...); break;
+        case 7: Kernel<7>::apply(std::forward<Args>(args)...); break;
+        case 8: Kernel<8>::apply(std::forward<Args>(args)...); break;
+        default: Kernel<Eigen::Dynamic>::apply(std::forward<Args>(args)...);
+      }
+    }
+  }
+
+  /**
+   * Invert in place `batch` complex n x n matrices, stored contiguously in row-major order from `data`.
+   * The matrices are inverted in parallel if OpenMP is enabled.
+   */
+  inline void invert_blocks(std::complex<double> *data, size_t n, size_t batch) {
+    if (n == 0) return;
+    detail::dispatch_block_size<detail::invert_blocks_kernel>(n, data, n, batch);
+  }
+
+  /**
+   * Invert in place the matrices of the last two indices of a Green's function, e.g. the orbital
+   * blocks of G(iw, k, i, j), for all values of the other indices.
+   */
+  template<class Storage, class ...MESHES>
+  void invert_blocks(detail::gf_base<std::complex<double>, Storage, MESHES...> &g) {
+    static_assert(sizeof...(MESHES) >= 2, "The Green's function should have two orbital indices.");
+    const auto &shape = g.data().shape();
+    const size_t n = shape[sizeof...(MESHES) - 1];
+    if (shape[sizeof...(MESHES) - 2] != n) {
+      throw std::invalid_argument("The blocks of the last two indices should be square");
+    }
+    invert_blocks(g.data().data(), n, n == 0 ? 0 : g.data().size() / (n * n));
+  }
+
+  /**
+   * Solve the Dyson equation G(iw, k) = [iw + mu - H(k) - Sigma(iw)]^{-1} for a local self-energy
+   *
+   * The orbital blocks are contiguous in all three functions, so G is computed in place, block by block,
+   * in a single pass over the frequencies and momenta (in parallel if OpenMP is enabled).
+   *
+   * @param g     - Green's function G(iw, k, i, j), on the meshes of `sigma` and `hk`
+   * @param sigma - self-energy Sigma(iw, i, j)
+   * @param hk    - Hamiltonian H(k, i, j)
+   * @param mu    - chemical potential
+   */
+  template<class GSt, class SSt, class HSt, mesh::frequency_positivity_type PTYPE, class KMESH>
+  void solve_dyson(detail::gf_base<std::complex<double>, GSt, matsubara_mesh<PTYPE>, KMESH, index_mesh, index_mesh> &g,
+                   const detail::gf_base<std::complex<double>, SSt, matsubara_mesh<PTYPE>, index_mesh, index_mesh> &sigma,
+                   const detail::gf_base<std::complex<double>, HSt, KMESH, index_mesh, index_mesh> &hk,
+                   double mu) {
+    if (g.mesh1() != sigma.mesh1() || g.mesh2() != hk.mesh1() || g.mesh3() != sigma.mesh2() || g.mesh4() != sigma.mesh3()
+        || g.mesh3() != hk.mesh2() || g.mesh4() != hk.mesh3() || g.mesh3().extent() != g.mesh4().extent()) {
+      throw std::invalid_argument("Green's function, self-energy and Hamiltonian have incompatible meshes");
+    }
+    detail::dispatch_block_size<detail::dyson_kernel>(size_t(g.mesh3().extent()), g.data().data(), sigma.data().data(),
+      hk.data().data(), g.mesh1().points(), size_t(g.mesh2().extent()), size_t(g.mesh3().extent()), mu, true);
+  }
+
+  /**
+   * Solve the Dyson equation G(iw, k) = [iw + mu - H(k) - Sigma(iw, k)]^{-1} for a momentum dependent self-energy
+   *
+   * @param g     - Green's function G(iw, k, i, j), on the meshes of `sigma` and `hk`
+   * @param sigma - self-energy Sigma(iw, k, i, j)
+   * @param hk    - Hamiltonian H(k, i, j)
+   * @param mu    - chemical potential
+   */
+  template<class GSt, class SSt, class HSt, mesh::frequency_positivity_type PTYPE, class KMESH>
+  void solve_dyson(detail::gf_base<std::complex<double>, GSt, matsubara_mesh<PTYPE>, KMESH, index_mesh, index_mesh> &g,
+                   const detail::gf_base<std::complex<double>, SSt, matsubara_mesh<PTYPE>, KMESH, index_mesh, index_mesh> &sigma,
+                   const detail::gf_base<std::complex<double>, HSt, KMESH, index_mesh, index_mesh> &hk,
+                   double mu) {
+    if (g.meshes() != sigma.meshes() || g.mesh2() != hk.mesh1() || g.mesh3() != hk.mesh2() || g.mesh4() != hk.mesh3()
+        || g.mesh3().extent() != g.mesh4().extent()) {
+      throw std::invalid_argument("Green's function, self-energy and Hamiltonian have incompatible meshes");
+    }
+    detail::dispatch_block_size<detail::dyson_kernel>(size_t(g.mesh3().extent()), g.data().data(), sigma.data().data(),
+      hk.data().data(), g.mesh1().points(), size_t(g.mesh2().extent()), size_t(g.mesh3().extent()), mu, false);
+  }
+
+}
+}
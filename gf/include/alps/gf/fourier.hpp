@@ -6,6 +6,15 @@
 #pragma once
 #include <alps/gf/gf.hpp>
 
+#include <unsupported/Eigen/FFT>
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace alps {
 namespace gf {
 
@@ -80,6 +89,370 @@ namespace gf {
     }
   }
 
+  /// Plan of the omega -> tau transform between given frequencies and times
+  /**
+   * The transform is done for blocks of `tau_block` times, in parallel if OpenMP is enabled;
+   * the frequencies are processed in blocks of `omega_block`, so that the twiddle factors
+   * cos(omega*tau) and sin(omega*tau) of a block stay in cache while they are multiplied
+   * with all orbital components of the input (a blocked matrix-matrix product).
+   *
+   * If they need at most `max_twiddle_bytes`, the twiddle factors are computed once, when
+   * the plan is created; otherwise they are generated for each block, by angle addition
+   * for equidistant frequencies (Matsubara meshes), which needs two sin/cos per time and block.
+   *
+   * For the fermionic Matsubara frequencies (2n+1)pi/beta, n=0,1,..., and equidistant times
+   * from 0 to beta (as on `matsubara_positive_mesh` and `itime_mesh`), the sum over the frequencies
+   * is done by a fast Fourier transform instead, in O(N_omega + N_tau log N_tau) per orbital component.
+   */
+  class fourier_plan {
+  public:
+    using Matrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+    static const size_t tau_block = 32;
+    static const size_t omega_block = 256;
+    static const size_t default_max_twiddle_bytes = size_t(64) << 20;
+
+    /// How the transform is done: by the FFT if the meshes allow it (`automatic`), or by one of the methods
+    enum method_type { automatic, blocked, fft };
+
+    fourier_plan(const std::vector<double> &omega, const std::vector<double> &tau, double beta,
+                 method_type method = automatic, size_t max_twiddle_bytes = default_max_twiddle_bytes)
+      : omega_(omega), tau_(tau), beta_(beta), equidistant_(omega.size() > 1)
+    {
+      const double step = omega.size() > 1 ? omega[1] - omega[0] : 0.;
+      for (size_t k = 1; k < omega.size() && equidistant_; ++k) {
+        equidistant_ = std::abs(omega[k] - omega[0] - k * step) <= 1e-12 * std::abs(omega[k]);
+      }
+      bool fft_possible = tau.size() > 1;
+      for (size_t k = 0; k < omega.size() && fft_possible; ++k) {
+        fft_possible = std::abs(omega[k] - (2 * k + 1) * M_PI / beta) <= 1e-12 * std::abs(omega[k]);
+      }
+      for (size_t i = 0; i < tau.size() && fft_possible; ++i) {
+        fft_possible = std::abs(tau[i] - i * beta / (tau.size() - 1)) <= 1e-12 * beta;
+      }
+      if (method == fft && !fft_possible)
+        throw std::invalid_argument("The FFT needs fermionic Matsubara frequencies and equidistant times from 0 to beta");
+      uses_fft_ = method == fft || (method == automatic && fft_possible);
+      if (!uses_fft_ && 2 * sizeof(double) * omega.size() * tau.size() <= max_twiddle_bytes) {
+        twiddles_.resize(2 * omega.size() * tau.size());
+        for (size_t i0 = 0; i0 < tau.size(); i0 += tau_block) {
+          size_t bt = std::min(size_t(tau_block), tau.size() - i0);
+          for (size_t k0 = 0; k0 < omega.size(); k0 += omega_block) {
+            size_t kt = std::min(size_t(omega_block), omega.size() - k0);
+            double *cos_block = &twiddles_[2 * (i0 * omega.size() + bt * k0)];
+            Eigen::Map<Matrix> Cos(cos_block, bt, kt), Sin(cos_block + bt * kt, bt, kt);
+            compute_twiddles(i0, k0, Cos, Sin);
+          }
+        }
+      }
+    }
+
+    const std::vector<double> &omega() const { return omega_; }
+    const std::vector<double> &tau() const { return tau_; }
+    double beta() const { return beta_; }
+
+    /// Returns true if the twiddle factors are computed once and stored
+    bool stores_twiddles() const { return !twiddles_.empty(); }
+
+    /// Returns true if the transform is done by the FFT
+    bool uses_fft() const { return uses_fft_; }
+
+    /// Returns true if the plan transforms between these frequencies and times
+    bool matches(const std::vector<double> &omega, const std::vector<double> &tau, double beta) const {
+      return beta == beta_ && omega == omega_ && tau == tau_;
+    }
+
+    /// Transform `input_data` (frequency first) to `output_data` (time first)
+    template<size_t D>
+    void execute(const alps::numerics::tensor<std::complex<double>, D> &input_data,
+                 alps::numerics::tensor<double, D> &output_data) const {
+      using MatrixX = Eigen::Matrix<std::complex<double>, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+      const size_t nw = omega_.size();
+      const size_t nt = tau_.size();
+      const size_t rest = input_data.size() / nw;
+      assert(rest == output_data.size() / nt);
+
+      Eigen::Map<const MatrixX> In(input_data.data(), nw, rest);
+      Eigen::Map<Matrix> Out(output_data.data(), nt, rest);
+
+      if (uses_fft_) {
+        execute_fft(In, Out);
+        return;
+      }
+
+      const Matrix Re = In.real();
+      const Matrix Im = In.imag();
+      const long nblocks = long((nt + tau_block - 1) / tau_block);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (long b = 0; b < nblocks; ++b) {
+        size_t i0 = size_t(b) * tau_block;
+        size_t bt = std::min(size_t(tau_block), nt - i0);
+        Matrix Cos, Sin;
+        auto Out_block = Out.middleRows(i0, bt);
+        Out_block.setZero();
+        for (size_t k0 = 0; k0 < nw; k0 += omega_block) {
+          size_t kt = std::min(size_t(omega_block), nw - k0);
+          if (stores_twiddles()) {
+            const double *cos_block = &twiddles_[2 * (i0 * nw + bt * k0)];
+            Eigen::Map<const Matrix> StoredCos(cos_block, bt, kt), StoredSin(cos_block + bt * kt, bt, kt);
+            Out_block.noalias() += StoredCos * Re.middleRows(k0, kt);
+            Out_block.noalias() += StoredSin * Im.middleRows(k0, kt);
+          } else {
+            Cos.resize(bt, kt);
+            Sin.resize(bt, kt);
+            compute_twiddles(i0, k0, Cos, Sin);
+            Out_block.noalias() += Cos * Re.middleRows(k0, kt);
+            Out_block.noalias() += Sin * Im.middleRows(k0, kt);
+          }
+        }
+        // + sign comes from the -i in the phase
+        Out_block *= 2.0 / beta_;
+      }
+    }
+
+  private:
+    /// The sum over w_n = (2n+1)pi/beta at tau_j = j beta/M is e^{-i pi j/M} sum_m F_m e^{-2 pi i m j/M},
+    /// where F_m is the sum of the inputs of the frequencies with n = m mod M
+    template<typename IN, typename OUT>
+    void execute_fft(const IN &In, OUT &Out) const {
+      const size_t nw = omega_.size();
+      const size_t m = tau_.size() - 1;
+      const long rest = long(In.cols());
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+      {
+        Eigen::FFT<double> fft;
+        std::vector<std::complex<double> > folded(m), summed(m);
+#if defined(_OPENMP)
+#pragma omp for
+#endif
+        for (long r = 0; r < rest; ++r) {
+          std::fill(folded.begin(), folded.end(), std::complex<double>());
+          for (size_t k = 0; k < nw; ++k) {
+            folded[k % m] += In(k, r);
+          }
+          fft.fwd(summed, folded);
+          for (size_t j = 0; j <= m; ++j) {
+            const double phase = -M_PI * j / m;
+            // + sign comes from the -i in the phase
+            Out(j, r) = 2.0 * (std::cos(phase) * summed[j % m].real() - std::sin(phase) * summed[j % m].imag()) / beta_;
+          }
+        }
+      }
+    }
+
+    /// Compute the twiddle factors of the times from i0 and the frequencies from k0, for the shape of Cos and Sin
+    template<typename M>
+    void compute_twiddles(size_t i0, size_t k0, M &Cos, M &Sin) const {
+      for (long i = 0; i < Cos.rows(); ++i) {
+        double t = tau_[i0 + i];
+        if (!equidistant_) {
+          for (long k = 0; k < Cos.cols(); ++k) {
+            Cos(i, k) = std::cos(omega_[k0 + k] * t);
+            Sin(i, k) = std::sin(omega_[k0 + k] * t);
+          }
+          continue;
+        }
+        // e^{i w_{k+1} t} = e^{i w_k t} e^{i dw t}; the error grows linearly within a block
+        double c = std::cos(omega_[k0] * t), s = std::sin(omega_[k0] * t);
+        double dc = std::cos((omega_[1] - omega_[0]) * t), ds = std::sin((omega_[1] - omega_[0]) * t);
+        for (long k = 0; k < Cos.cols(); ++k) {
+          Cos(i, k) = c;
+          Sin(i, k) = s;
+          double c_next = c * dc - s * ds;
+          s = s * dc + c * ds;
+          c = c_next;
+        }
+      }
+    }
+
+    std::vector<double> omega_;
+    std::vector<double> tau_;
+    double beta_;
+    bool equidistant_;
+    bool uses_fft_;
+    /// Blocks of cos and sin: for each block of times, for each block of frequencies, the cos then the sin, row major
+    std::vector<double> twiddles_;
+  };
+
+  /// Returns the plan of the omega -> tau transform for these frequencies and times
+  /** The plans for the few meshes used last are kept, so that repeated transforms
+      (e.g. in a self-consistency loop) do not compute the twiddle factors again. Thread safe. */
+  inline std::shared_ptr<const fourier_plan> cached_fourier_plan(const std::vector<double> &omega, const std::vector<double> &tau, double beta) {
+    static const size_t max_plans = 4;
+    static std::mutex mutex;
+    static std::list<std::shared_ptr<const fourier_plan> > plans;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = plans.begin(); it != plans.end(); ++it) {
+      if ((*it)->matches(omega, tau, beta)) {
+        plans.splice(plans.begin(), plans, it);
+        return plans.front();
+      }
+    }
+    plans.push_front(std::make_shared<const fourier_plan>(omega, tau, beta));
+    if (plans.size() > max_plans) plans.pop_back();
+    return plans.front();
+  }
+
+  namespace detail {
+    /// Tail coefficients of orders 0 to 3 of a gf with tail; zero for the orders that are not set
+    template<class GFT>
+    std::array<typename GFT::tail_type::storage_type, 4> tail_coefficients(const GFT &g) {
+      typedef typename GFT::tail_type::storage_type tail_data;
+      std::array<size_t, std::tuple_size<typename GFT::tail_type::mesh_types>::value> tail_shape;
+      for (size_t i = 0; i < tail_shape.size(); ++i) {
+        tail_shape[i] = g.data().shape()[i+1];
+      }
+      std::array<tail_data, 4> c = {{ tail_data(tail_shape), tail_data(tail_shape), tail_data(tail_shape), tail_data(tail_shape) }};
+      for (int order = 0; order < 4; ++order) {
+        if (g.min_tail_order() <= order && g.max_tail_order() >= order) {
+          c[order] = g.tail(order).data();
+        } else {
+          c[order].set_zero();
+        }
+      }
+      for (size_t i = 0; i < c[0].size(); ++i) {
+        if(c[0].data()[i] != 0) throw std::runtime_error("attempt to Fourier transform an object which goes to a constant. FT is ill defined");
+      }
+      return c;
+    }
+
+    /// Weight of the Fourier integral of a cubic spline with knot spacing h, for theta = omega*h
+    inline double cubic_spline_weight(double theta) {
+      double x = 0.5 * theta;
+      double sinc = std::sin(x) / x;
+      return 3 * sinc * sinc * sinc * sinc / (2 + std::cos(theta));
+    }
+  }
+
+  /// Fourier transform helper of the tau -> omega transform, for fermionic frequencies and times from 0 to beta
+  /**
+   * Computes int_0^beta e^{i omega tau} S(tau) dtau exactly for the antiperiodic cubic spline S through the input,
+   * so the input should be antiperiodic with its first two derivatives (i.e. free of the high frequency tail).
+   *
+   * The spline has the second derivatives M_j, constant third derivatives d_j = (M_{j+1}-M_j)/h_j, and vanishing
+   * boundary terms, so that the integral is -omega^{-4} sum_j e^{i omega tau_j} (d_{j-1}-d_j).
+   * For equidistant times this is h W(omega h) sum_j e^{i omega tau_j} S(tau_j), computed by a FFT;
+   * for other times (`power_mesh`) the sum is done directly.
+   */
+  template<size_t D>
+  inline void transform_vector_time_to_frequency(const alps::numerics::tensor<double, D> &input_data, const std::vector<double> &tau,
+                                                 alps::numerics::tensor<std::complex<double>, D> &output_data, const std::vector<double> &omega,
+                                                 double beta) {
+    using Matrix  = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using MatrixX = Eigen::Matrix<std::complex<double>, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    const size_t n = tau.size() - 1;
+    if (tau.size() < 4 || tau.front() != 0 || std::abs(tau.back() - beta) > 1e-12 * beta)
+      throw std::invalid_argument("The tau -> omega transform needs at least 4 times, from 0 to beta");
+    const long rest = long(input_data.size() / tau.size());
+    assert(size_t(rest) == output_data.size() / omega.size());
+
+    Eigen::Map<const Matrix> In(input_data.data(), tau.size(), rest);
+    Eigen::Map<MatrixX> Out(output_data.data(), omega.size(), rest);
+    // the value at tau=0 and (minus) the value at beta belong to the same knot
+    Matrix Data = In.topRows(n);
+    Data.row(0) = 0.5 * (In.row(0) - In.row(n));
+
+    bool equidistant = true;
+    for (size_t j = 0; j <= n && equidistant; ++j) {
+      equidistant = std::abs(tau[j] - j * beta / n) <= 1e-12 * beta;
+    }
+
+    if (equidistant) {
+      const double h = beta / n;
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+      {
+        Eigen::FFT<double> fft;
+        fft.SetFlag(Eigen::FFT<double>::Unscaled);
+        std::vector<std::complex<double> > shifted(n), summed(n);
+#if defined(_OPENMP)
+#pragma omp for
+#endif
+        for (long r = 0; r < rest; ++r) {
+          for (size_t j = 0; j < n; ++j) {
+            shifted[j] = std::polar(Data(j, r), M_PI * j / n);
+          }
+          fft.inv(summed, shifted);
+          for (size_t k = 0; k < omega.size(); ++k) {
+            long m = std::lround(0.5 * (omega[k] * beta / M_PI - 1)) % long(n);
+            Out(k, r) = h * detail::cubic_spline_weight(omega[k] * h) * summed[m < 0 ? m + n : m];
+          }
+        }
+      }
+      return;
+    }
+
+    // Antiperiodic spline: h_{j-1} M_{j-1} + 2 (h_{j-1}+h_j) M_j + h_j M_{j+1} = 6 (D_{j+1}-D_j)/h_j - 6 (D_j-D_{j-1})/h_{j-1},
+    // with M_{-1}=-M_{n-1}, M_n=-M_0; the cyclic tridiagonal system is solved by Sherman-Morrison
+    std::vector<double> h(n), lower(n), diag(n), upper(n);
+    for (size_t j = 0; j < n; ++j) h[j] = tau[j+1] - tau[j];
+    Matrix Rhs(n, rest);
+    for (size_t j = 0; j < n; ++j) {
+      size_t prev = (j + n - 1) % n;
+      double sign_prev = (j == 0) ? -1. : 1., sign_next = (j == n-1) ? -1. : 1.;
+      lower[j] = h[prev];
+      diag[j] = 2 * (h[prev] + h[j]);
+      upper[j] = h[j];
+      Rhs.row(j) = 6 * ((sign_next * Data.row((j+1) % n) - Data.row(j)) / h[j] - (Data.row(j) - sign_prev * Data.row(prev)) / h[prev]);
+    }
+    const double corner = -h[n-1];  // A(0,n-1) = A(n-1,0)
+    const double gamma = -diag[0];
+    diag[0] -= gamma;
+    diag[n-1] -= corner * corner / gamma;
+    Matrix U = Matrix::Zero(n, 1);
+    U(0, 0) = gamma;
+    U(n-1, 0) = corner;
+    // Thomas algorithm for both right hand sides
+    std::vector<double> c(n);
+    c[0] = upper[0] / diag[0];
+    Rhs.row(0) /= diag[0];
+    U.row(0) /= diag[0];
+    for (size_t j = 1; j < n; ++j) {
+      double denom = diag[j] - lower[j] * c[j-1];
+      c[j] = upper[j] / denom;
+      Rhs.row(j) = (Rhs.row(j) - lower[j] * Rhs.row(j-1)) / denom;
+      U.row(j) = (U.row(j) - lower[j] * U.row(j-1)) / denom;
+    }
+    for (size_t j = n - 1; j-- > 0; ) {
+      Rhs.row(j) -= c[j] * Rhs.row(j+1);
+      U.row(j) -= c[j] * U.row(j+1);
+    }
+    const double denom = 1 + U(0, 0) + corner * U(n-1, 0) / gamma;
+    const Matrix M = Rhs - U * ((Rhs.row(0) + corner * Rhs.row(n-1) / gamma) / denom);
+
+    // d_{j-1} - d_j, with d_{-1} = -d_{n-1}
+    Matrix Jumps(n, rest);
+    for (size_t j = 0; j < n; ++j) {
+      size_t prev = (j + n - 1) % n;
+      double sign_next = (j == n-1) ? -1. : 1., sign_prev = (j == 0) ? -1. : 1.;
+      Jumps.row(j) = (M.row(j) - sign_prev * M.row(prev)) / h[prev] - (sign_next * M.row((j+1) % n) - M.row(j)) / h[j];
+    }
+    const MatrixX JumpsX = Jumps.cast<std::complex<double> >();
+    const long nw = long(omega.size());
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+    {
+      Eigen::Matrix<std::complex<double>, 1, Eigen::Dynamic> phases(n);
+#if defined(_OPENMP)
+#pragma omp for
+#endif
+      for (long k = 0; k < nw; ++k) {
+        for (size_t j = 0; j < n; ++j) {
+          phases(j) = std::polar(1., omega[k] * tau[j]);
+        }
+        double w2 = omega[k] * omega[k];
+        Out.row(k).noalias() = (-1. / (w2 * w2)) * (phases * JumpsX);
+      }
+    }
+  }
+
   ///Fourier transform a matsubara gf to an imag time gf
   template<class...MESHES> void fourier_frequency_to_time(
       const gf_tail<
@@ -90,33 +463,92 @@ namespace gf {
       detail::gf_base<double, numerics::tensor<double, sizeof...(MESHES)>, MESHES...> > &g_tau){
     alps::numerics::tensor<std::complex<double>, (sizeof...(MESHES)) + 1> in_data(g_omega.data().shape());
 
-    using tail_data = alps::numerics::tensor<double, sizeof...(MESHES)>;
+    const auto c = detail::tail_coefficients(g_omega);
+    for(int n=0;n<g_omega.mesh1().extent();++n) {
+      in_data(size_t(n)) = g_omega(matsubara_index(size_t(n))).data() - f_omega(g_omega.mesh1().points()[size_t(n)],c[1],c[2],c[3]);
+    }
 
-    std::array<size_t, sizeof...(MESHES)> tail_shape;
-    for (size_t i = 0; i < sizeof...(MESHES); ++i) {
-      tail_shape[i] = g_omega.data().shape()[i+1];
+    cached_fourier_plan(g_omega.mesh1().points(), g_tau.mesh1().points(), g_tau.mesh1().beta())->execute(in_data, g_tau.data());
+
+    for(int t=0;t<g_tau.mesh1().extent();++t){
+      g_tau(itime_index(t)).data() += f_tau(g_tau.mesh1().points()[t],g_tau.mesh1().beta(),c[1],c[2],c[3]);
     }
+  }
 
-    tail_data zero_tail(tail_shape);
+  ///Fourier transform a matsubara gf on positive and negative frequencies to an imag time gf
+  /** Since the imaginary time gf is real, the frequencies -w_n and w_n are combined into the positive one. */
+  template<class...MESHES> void fourier_frequency_to_time(
+      const gf_tail<
+      detail::gf_base<std::complex<double>, numerics::tensor<std::complex<double>, sizeof...(MESHES) + 1>, matsubara_pn_mesh, MESHES...>,
+      detail::gf_base<double, numerics::tensor<double, sizeof...(MESHES)>, MESHES...> > &g_omega,
+      gf_tail<
+      detail::gf_base<double, numerics::tensor<double, sizeof...(MESHES) + 1 >, itime_mesh, MESHES...>,
+      detail::gf_base<double, numerics::tensor<double, sizeof...(MESHES)>, MESHES...> > &g_tau){
+    const int nfreq = g_omega.mesh1().extent();
+    if (nfreq % 2 != 0)
+      throw std::invalid_argument("Fourier transform needs as many negative as positive frequencies");
+    matsubara_positive_mesh positive_mesh(g_omega.mesh1().beta(), nfreq / 2);
+    std::array<size_t, sizeof...(MESHES) + 1> shape = g_omega.data().shape();
+    shape[0] = nfreq / 2;
+    alps::numerics::tensor<std::complex<double>, (sizeof...(MESHES)) + 1> in_data(shape);
 
-    const alps::numerics::tensor<double, sizeof...(MESHES)>& c0=(g_omega.min_tail_order()==0 && g_omega.max_tail_order()>=0 )? g_omega.tail(0).data():zero_tail;
-    const alps::numerics::tensor<double, sizeof...(MESHES)>& c1=(g_omega.min_tail_order()<=1 && g_omega.max_tail_order()>=1 )? g_omega.tail(1).data():zero_tail;
-    const alps::numerics::tensor<double, sizeof...(MESHES)>& c2=(g_omega.min_tail_order()<=2 && g_omega.max_tail_order()>=2 )? g_omega.tail(2).data():zero_tail;
-    const alps::numerics::tensor<double, sizeof...(MESHES)>& c3=(g_omega.min_tail_order()<=3 && g_omega.max_tail_order()>=3 )? g_omega.tail(3).data():zero_tail;
-    for (size_t i = 0; i < c0.size(); ++i) {
-      if(c0.data()[i] != 0) throw std::runtime_error("attempt to Fourier transform an object which goes to a constant. FT is ill defined");
+    const auto c = detail::tail_coefficients(g_omega);
+    const size_t rest = in_data.size() / shape[0];
+    const std::complex<double> *g = g_omega.data().data();
+    for(int n=0;n<nfreq/2;++n) {
+      // the frequency w_n is at index nfreq/2+n, -w_n at nfreq/2-n-1
+      const std::complex<double> *g_pos = g + (nfreq/2+n) * rest, *g_neg = g + (nfreq/2-n-1) * rest;
+      for (size_t r = 0; r < rest; ++r) {
+        in_data.data()[n * rest + r] = 0.5 * (g_pos[r] + std::conj(g_neg[r]));
+      }
+      in_data(size_t(n)) -= f_omega(positive_mesh.points()[size_t(n)],c[1],c[2],c[3]);
     }
-    for(int n=0;n<g_omega.mesh1().extent();++n) {
-      in_data(size_t(n)) = g_omega(matsubara_index(size_t(n))).data() - f_omega(g_omega.mesh1().points()[size_t(n)],c1,c2,c3);
+
+    cached_fourier_plan(positive_mesh.points(), g_tau.mesh1().points(), g_tau.mesh1().beta())->execute(in_data, g_tau.data());
+
+    for(int t=0;t<g_tau.mesh1().extent();++t){
+      g_tau(itime_index(t)).data() += f_tau(g_tau.mesh1().points()[t],g_tau.mesh1().beta(),c[1],c[2],c[3]);
     }
+  }
 
-    if(g_omega.mesh1().extent() * g_tau.mesh1().extent() > 20000000 || g_omega.data().size()/g_omega.mesh1().extent() < 100)
-      transform_vector_no_tail_loop(in_data,g_omega.mesh1().points(), g_tau.data(), g_tau.mesh1().points(), g_tau.mesh1().beta());
-    else
-      transform_vector_no_tail_matrix(in_data,g_omega.mesh1().points(), g_tau.data(), g_tau.mesh1().points(), g_tau.mesh1().beta());
+  ///Fourier transform an imag time gf (on `itime_mesh` or `power_mesh`) to a matsubara gf (on `matsubara_positive_mesh` or `matsubara_pn_mesh`)
+  /**
+   * The model function of the tail (up to third order) is subtracted, the remainder is integrated as a cubic spline,
+   * and the tail is added back analytically; the tail is copied to `g_omega`.
+   * Uniform time meshes use an FFT, in O(N_tau log N_tau + N_omega) per orbital component.
+   */
+  template<class TMESH, class WMESH, class...MESHES> void fourier_time_to_frequency(
+      const gf_tail<
+      detail::gf_base<double, numerics::tensor<double, sizeof...(MESHES) + 1 >, TMESH, MESHES...>,
+      detail::gf_base<double, numerics::tensor<double, sizeof...(MESHES)>, MESHES...> > &g_tau,
+      gf_tail<
+      detail::gf_base<std::complex<double>, numerics::tensor<std::complex<double>, sizeof...(MESHES) + 1>, WMESH, MESHES...>,
+      detail::gf_base<double, numerics::tensor<double, sizeof...(MESHES)>, MESHES...> > &g_omega){
+    static_assert(std::is_same<TMESH, itime_mesh>::value || std::is_same<TMESH, power_mesh>::value,
+                  "Fourier transform from itime_mesh or power_mesh only");
+    static_assert(std::is_same<WMESH, matsubara_positive_mesh>::value || std::is_same<WMESH, matsubara_pn_mesh>::value,
+                  "Fourier transform to matsubara_positive_mesh or matsubara_pn_mesh only");
+    if (g_tau.mesh1().statistics() != statistics::FERMIONIC || g_omega.mesh1().statistics() != statistics::FERMIONIC)
+      throw std::invalid_argument("Fourier transform from imaginary time is implemented for fermions only");
+    const double beta = g_tau.mesh1().beta();
+    if (std::abs(beta - g_omega.mesh1().beta()) > 1e-12 * beta)
+      throw std::invalid_argument("Fourier transform between meshes of different beta");
 
+    alps::numerics::tensor<double, (sizeof...(MESHES)) + 1> in_data(g_tau.data().shape());
+    const auto c = detail::tail_coefficients(g_tau);
     for(int t=0;t<g_tau.mesh1().extent();++t){
-      g_tau(itime_index(t)).data() += f_tau(g_tau.mesh1().points()[t],g_tau.mesh1().beta(),c1,c2,c3);
+      in_data(size_t(t)) = g_tau.data()(size_t(t)) - f_tau(g_tau.mesh1().points()[t],beta,c[1],c[2],c[3]);
+    }
+
+    transform_vector_time_to_frequency(in_data, g_tau.mesh1().points(), g_omega.data(), g_omega.mesh1().points(), beta);
+
+    for(int n=0;n<g_omega.mesh1().extent();++n) {
+      g_omega.data()(size_t(n)) += f_omega(g_omega.mesh1().points()[size_t(n)],c[1],c[2],c[3]);
+    }
+    if (g_tau.min_tail_order() != TAIL_NOT_SET) {
+      for (int order = g_tau.min_tail_order(); order <= g_tau.max_tail_order(); ++order) {
+        g_omega.set_tail(order, g_tau.tail(order));
+      }
     }
   }
 }
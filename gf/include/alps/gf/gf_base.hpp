@@ -65,6 +65,12 @@ namespace alps {
      */
     template<class VTYPE, class ...MESHES>
     using greenf_view = detail::gf_base<VTYPE, numerics::tensor_view<VTYPE, sizeof...(MESHES)>, MESHES...>;
+    /**
+     * Definition of GF with dedicated storage allocated by ALLOC, e.g. numerics::aligned_allocator<VTYPE>,
+     * or numerics::huge_page_allocator<VTYPE> for large GFs
+     */
+    template<class VTYPE, class ALLOC, class ...MESHES>
+    using greenf_alloc = detail::gf_base<VTYPE, numerics::tensor<VTYPE, sizeof...(MESHES), ALLOC>, MESHES...>;
 
     namespace detail {
       /**
@@ -86,8 +92,8 @@ namespace alps {
       private:
         /// current GF type
         using gf_type   = gf_base < VTYPE, Storage, MESHES... >;
-        /// storage types
-        using data_storage = numerics::tensor < VTYPE, sizeof...(MESHES) >;
+        /// storage types (the tensor with storage keeps the allocator of Storage)
+        using data_storage = typename numerics::detail::storage_tensor < Storage >::type;
         using data_view    = numerics::tensor_view < VTYPE, sizeof...(MESHES) >;
         /// Generic GF type
         template<typename St>
@@ -497,7 +503,7 @@ namespace alps {
           if (ndim != N_) throw std::runtime_error("Wrong number of dimension reading GF, ndim=" + std::to_string(ndim)
                                                    + ", should be N=" + std::to_string(N_));
           load_meshes(ar, path, make_index_sequence<sizeof...(MESHES)>());
-          data_ = numerics::tensor < VTYPE, N_ >(get_sizes(meshes_));
+          data_ = data_storage(get_sizes(meshes_));
           ar[path + "/data"] >> data_;
           empty_ = false;
         }
@@ -561,7 +567,7 @@ namespace alps {
           size_t root_sz=data_.size();
           alps::mpi::broadcast(comm, root_sz, root);
           // as long as all grids have been broadcasted we can define tensor object
-          if(comm.rank() != root) data_ = numerics::tensor < VTYPE, N_ >(get_sizes(meshes_));
+          if(comm.rank() != root) data_ = data_storage(get_sizes(meshes_));
           alps::mpi::broadcast(comm, &data_.storage().data(0), root_sz, root);
         }
 #endif
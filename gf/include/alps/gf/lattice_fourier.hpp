@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+#include <alps/gf/gf_base.hpp>
+#include <alps/gf/mesh.hpp>
+
+#include <Eigen/Dense>
+#include <unsupported/Eigen/FFT>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace alps {
+namespace gf {
+
+  /// Plan of the lattice Fourier transform between the points of a momentum and a real space mesh
+  /**
+   * The transforms are G(r) = 1/N_k sum_k e^{i k.r} G(k) and G(k) = sum_r e^{-i k.r} G(r),
+   * applied to data of the shape [outer][N][inner], i.e. for all values of the indices before
+   * and after the momentum or real space index.
+   *
+   * If the real space points are r = (a_1 n_1, ..., a_D n_D) with integer n_d, and the momenta are
+   * k = (2 pi m_1/(a_1 L_1), ..., 2 pi m_D/(a_D L_D)) with integer m_d, and both meshes hold each of the
+   * L_1 x ... x L_D lattice points exactly once (in any order), as for a (rectangular) Bravais lattice
+   * with periodic boundary conditions in reduced coordinates, the transform is done by a D-dimensional FFT,
+   * in O(N log N) per component. Otherwise, the sums are done directly, in O(N_k N_r) per component,
+   * for blocks of `block` output points whose phases are computed once for all components.
+   */
+  class lattice_fourier_plan {
+  public:
+    using MatrixX = Eigen::Matrix<std::complex<double>, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using container_type = momentum_realspace_index_mesh::container_type;
+
+    static const size_t block = 64;
+
+    /// How the transform is done: by the FFT if the meshes allow it (`automatic`), or by one of the methods
+    enum method_type { automatic, direct, fft };
+
+    lattice_fourier_plan(const momentum_index_mesh &kmesh, const real_space_index_mesh &rmesh, method_type method = automatic)
+      : k_(kmesh.points()), r_(rmesh.points())
+    {
+      if (kmesh.dimension() != rmesh.dimension())
+        throw std::invalid_argument("Momentum and real space meshes of different dimensions");
+      const bool fft_possible = find_grid();
+      if (method == fft && !fft_possible)
+        throw std::invalid_argument("The FFT needs momenta and real space points of the same rectangular Bravais lattice");
+      if (!(method == fft || (method == automatic && fft_possible))) {
+        shape_.clear();
+        k_index_.clear();
+        r_index_.clear();
+      }
+    }
+
+    /// Returns true if the transform is done by the FFT
+    bool uses_fft() const { return !shape_.empty(); }
+
+    /// Number of lattice points along each direction, if the transform is done by the FFT
+    const std::vector<size_t> &grid_shape() const { return shape_; }
+
+    /// Transform `in` of shape [outer][N_k][inner] to `out` of shape [outer][N_r][inner]
+    void momentum_to_space(const std::complex<double> *in, std::complex<double> *out, size_t outer, size_t inner) const {
+      const double scale = k_.shape()[0] == 0 ? 0. : 1. / k_.shape()[0];
+      if (uses_fft()) {
+        execute_fft(in, out, outer, inner, k_index_, r_index_, true, scale);
+      } else {
+        execute_direct(in, out, outer, inner, k_, r_, 1., scale);
+      }
+    }
+
+    /// Transform `in` of shape [outer][N_r][inner] to `out` of shape [outer][N_k][inner]
+    void space_to_momentum(const std::complex<double> *in, std::complex<double> *out, size_t outer, size_t inner) const {
+      if (uses_fft()) {
+        execute_fft(in, out, outer, inner, r_index_, k_index_, false, 1.);
+      } else {
+        execute_direct(in, out, outer, inner, r_, k_, -1., 1.);
+      }
+    }
+
+  private:
+    /// Find the lattice of the points, and the index of each point on it; returns false if there is none
+    bool find_grid() {
+      const size_t n = r_.shape()[0];
+      const size_t dim = r_.shape()[1];
+      const double tol = 1e-8;
+      if (n == 0 || k_.shape()[0] != n) return false;
+      shape_.assign(dim, 1);
+      k_index_.assign(n, 0);
+      r_index_.assign(n, 0);
+      for (size_t d = 0; d < dim; ++d) {
+        std::vector<double> values(n);
+        for (size_t p = 0; p < n; ++p) values[p] = r_[p][d];
+        std::sort(values.begin(), values.end());
+        // distinct coordinates, and the lattice constant a as the smallest distance between them
+        size_t distinct = 1;
+        double a = 0.;
+        for (size_t p = 1; p < n; ++p) {
+          double diff = values[p] - values[p - 1];
+          if (diff > tol) {
+            ++distinct;
+            a = (a == 0. || diff < a) ? diff : a;
+          }
+        }
+        if (a == 0.) a = 1.;
+        const size_t L = distinct;
+        for (size_t p = 0; p < n; ++p) {
+          double x = r_[p][d] / a;
+          double y = L == 1 ? 0. : k_[p][d] * a * L / (2 * M_PI);
+          if (std::abs(x - std::round(x)) > tol || std::abs(y - std::round(y)) > tol) return false;
+          r_index_[p] = r_index_[p] * L + positive_modulo(std::lround(x), L);
+          k_index_[p] = k_index_[p] * L + positive_modulo(std::lround(y), L);
+        }
+        shape_[d] = L;
+      }
+      // each lattice point should appear exactly once in both meshes
+      size_t total = 1;
+      for (size_t d = 0; d < dim; ++d) total *= shape_[d];
+      if (total != n) return false;
+      std::vector<char> seen_k(n, 0), seen_r(n, 0);
+      for (size_t p = 0; p < n; ++p) {
+        if (seen_k[k_index_[p]] || seen_r[r_index_[p]]) return false;
+        seen_k[k_index_[p]] = seen_r[r_index_[p]] = 1;
+      }
+      return true;
+    }
+
+    static size_t positive_modulo(long x, size_t L) {
+      long m = x % long(L);
+      return size_t(m < 0 ? m + long(L) : m);
+    }
+
+    /// Sort the input into the lattice, FFT along each direction, and pick the output points from the lattice
+    void execute_fft(const std::complex<double> *in, std::complex<double> *out, size_t outer, size_t inner,
+                     const std::vector<size_t> &in_index, const std::vector<size_t> &out_index, bool inverse, double scale) const {
+      const size_t n = in_index.size();
+      const size_t slab = n * inner;
+      std::vector<std::complex<double> > lattice(outer * slab);
+      const long rows = long(outer * n);
+#if defined(_OPENMP)
+#pragma omp parallel for
+#endif
+      for (long row = 0; row < rows; ++row) {
+        const size_t o = size_t(row) / n, p = size_t(row) % n;
+        std::copy(in + size_t(row) * inner, in + size_t(row + 1) * inner, &lattice[o * slab + in_index[p] * inner]);
+      }
+
+      // the lines along direction d are strided by the points of the directions after d times the inner size
+      size_t after = n;
+      for (size_t d = 0; d < shape_.size(); ++d) {
+        const size_t L = shape_[d];
+        after /= L;
+        if (L == 1) continue;
+        const size_t stride = after * inner;
+        const long lines = long(outer * slab / L);
+#if defined(_OPENMP)
+#pragma omp parallel
+#endif
+        {
+          Eigen::FFT<double> fft;
+          fft.SetFlag(Eigen::FFT<double>::Unscaled);
+          std::vector<std::complex<double> > line(L), transformed(L);
+#if defined(_OPENMP)
+#pragma omp for
+#endif
+          for (long l = 0; l < lines; ++l) {
+            std::complex<double> *start = &lattice[(size_t(l) / stride) * L * stride + size_t(l) % stride];
+            for (size_t j = 0; j < L; ++j) line[j] = start[j * stride];
+            if (inverse) {
+              fft.inv(transformed, line);
+            } else {
+              fft.fwd(transformed, line);
+            }
+            for (size_t j = 0; j < L; ++j) start[j * stride] = transformed[j];
+          }
+        }
+      }
+
+#if defined(_OPENMP)
+#pragma omp parallel for
+#endif
+      for (long row = 0; row < rows; ++row) {
+        const size_t o = size_t(row) / n, p = size_t(row) % n;
+        const std::complex<double> *src = &lattice[o * slab + out_index[p] * inner];
+        for (size_t c = 0; c < inner; ++c) out[size_t(row) * inner + c] = scale * src[c];
+      }
+    }
+
+    /// out[o][i] = scale sum_j e^{i sign to_i.from_j} in[o][j], for blocks of output points
+    void execute_direct(const std::complex<double> *in, std::complex<double> *out, size_t outer, size_t inner,
+                        const container_type &from, const container_type &to, double sign, double scale) const {
+      const size_t n_in = from.shape()[0], n_out = to.shape()[0], dim = from.shape()[1];
+      const long nblocks = long((n_out + block - 1) / block);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (long b = 0; b < nblocks; ++b) {
+        const size_t i0 = size_t(b) * block;
+        const size_t bt = std::min(size_t(block), n_out - i0);
+        MatrixX phases(bt, n_in);
+        for (size_t i = 0; i < bt; ++i) {
+          for (size_t j = 0; j < n_in; ++j) {
+            double x = 0.;
+            for (size_t d = 0; d < dim; ++d) x += to[i0 + i][d] * from[j][d];
+            phases(i, j) = std::polar(scale, sign * x);
+          }
+        }
+        for (size_t o = 0; o < outer; ++o) {
+          Eigen::Map<const MatrixX> In(in + o * n_in * inner, n_in, inner);
+          Eigen::Map<MatrixX> Out(out + (o * n_out + i0) * inner, bt, inner);
+          Out.noalias() = phases * In;
+        }
+      }
+    }
+
+    container_type k_;
+    container_type r_;
+    /// Lattice points along each direction; empty if the transform is done directly
+    std::vector<size_t> shape_;
+    /// Row-major index on the lattice of each momentum and real space point
+    std::vector<size_t> k_index_;
+    std::vector<size_t> r_index_;
+  };
+
+  namespace detail {
+    /// Products of the extents before and after index I, which should be the only one differing between the shapes
+    template<size_t I, size_t N>
+    void lattice_fourier_batch(const std::array<size_t, N> &in_shape, const std::array<size_t, N> &out_shape,
+                               size_t &outer, size_t &inner) {
+      outer = 1;
+      inner = 1;
+      for (size_t d = 0; d < N; ++d) {
+        if (d != I && in_shape[d] != out_shape[d])
+          throw std::invalid_argument("Lattice Fourier transform between Green's functions of incompatible meshes");
+        if (d < I) outer *= in_shape[d];
+        if (d > I) inner *= in_shape[d];
+      }
+    }
+  }
+
+  /// Lattice Fourier transform G(r) = 1/N_k sum_k e^{i k.r} G(k) of the momentum index I of `g_k`
+  /**
+   * `g_r` should have the meshes of `g_k`, with a `real_space_index_mesh` in place of the
+   * `momentum_index_mesh` I; the transform is done for all values of the other indices at once.
+   * Index 1 of e.g. `omega_k_sigma1_sigma2_gf` is transformed to `omega_r_sigma1_sigma2_gf` by
+   *
+   *     fourier_momentum_to_space<1>(g_k, g_r);
+   */
+  template<size_t I, class StK, class StR, class ...MK, class ...MR>
+  void fourier_momentum_to_space(const detail::gf_base<std::complex<double>, StK, MK...> &g_k,
+                                 detail::gf_base<std::complex<double>, StR, MR...> &g_r,
+                                 lattice_fourier_plan::method_type method = lattice_fourier_plan::automatic) {
+    static_assert(sizeof...(MK) == sizeof...(MR), "Green's functions should have the same number of indices");
+    static_assert(std::is_same<typename std::tuple_element<I, std::tuple<MK...> >::type, momentum_index_mesh>::value,
+                  "Index I should be a momentum_index_mesh");
+    static_assert(std::is_same<typename std::tuple_element<I, std::tuple<MR...> >::type, real_space_index_mesh>::value,
+                  "Index I of the result should be a real_space_index_mesh");
+    size_t outer, inner;
+    detail::lattice_fourier_batch<I>(g_k.data().shape(), g_r.data().shape(), outer, inner);
+    lattice_fourier_plan plan(std::get<I>(g_k.meshes()), std::get<I>(g_r.meshes()), method);
+    plan.momentum_to_space(g_k.data().data(), g_r.data().data(), outer, inner);
+  }
+
+  /// Lattice Fourier transform G(k) = sum_r e^{-i k.r} G(r) of the real space index I of `g_r`
+  /** The inverse of `fourier_momentum_to_space`. */
+  template<size_t I, class StR, class StK, class ...MR, class ...MK>
+  void fourier_space_to_momentum(const detail::gf_base<std::complex<double>, StR, MR...> &g_r,
+                                 detail::gf_base<std::complex<double>, StK, MK...> &g_k,
+                                 lattice_fourier_plan::method_type method = lattice_fourier_plan::automatic) {
+    static_assert(sizeof...(MK) == sizeof...(MR), "Green's functions should have the same number of indices");
+    static_assert(std::is_same<typename std::tuple_element<I, std::tuple<MR...> >::type, real_space_index_mesh>::value,
+                  "Index I should be a real_space_index_mesh");
+    static_assert(std::is_same<typename std::tuple_element<I, std::tuple<MK...> >::type, momentum_index_mesh>::value,
+                  "Index I of the result should be a momentum_index_mesh");
+    size_t outer, inner;
+    detail::lattice_fourier_batch<I>(g_r.data().shape(), g_k.data().shape(), outer, inner);
+    lattice_fourier_plan plan(std::get<I>(g_k.meshes()), std::get<I>(g_r.meshes()), method);
+    plan.space_to_momentum(g_r.data().data(), g_k.data().data(), outer, inner);
+  }
+
+}
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include "gtest/gtest.h"
+#include <alps/gf/gf.hpp>
+#include "alps/gf/dyson.hpp"
+
+#include <cmath>
+
+namespace g=alps::gf;
+
+class DysonTest : public ::testing::TestWithParam<int>
+{
+public:
+  typedef g::matsubara_positive_mesh omega_mesh;
+  typedef g::greenf<std::complex<double>, omega_mesh, g::momentum_index_mesh, g::index_mesh, g::index_mesh> gf_type;
+  typedef g::greenf<std::complex<double>, omega_mesh, g::index_mesh, g::index_mesh> local_gf_type;
+  typedef g::greenf<std::complex<double>, g::momentum_index_mesh, g::index_mesh, g::index_mesh> hk_type;
+
+  const double beta;
+  const double mu;
+  const int nk;
+  omega_mesh omega;
+  g::momentum_index_mesh kmesh;
+  g::index_mesh orbitals;
+
+  DysonTest() : beta(10.), mu(0.3), nk(6), omega(beta, 20), kmesh(nk, 1), orbitals(GetParam()) {
+    for (int k = 0; k < nk; ++k) {
+      kmesh.points()[k][0] = 2 * M_PI * k / nk;
+    }
+  }
+
+  /// Hermitian Hamiltonian with nearest-neighbour hopping and interorbital coupling
+  hk_type hamiltonian() const {
+    hk_type hk(kmesh, orbitals, orbitals);
+    for (g::momentum_index_mesh::index_type k(0); k < nk; ++k) {
+      for (g::index_mesh::index_type i(0); i < orbitals.extent(); ++i) {
+        for (g::index_mesh::index_type j(0); j < orbitals.extent(); ++j) {
+          hk(k, i, j) = (i == j()) ? std::complex<double>(-2 * std::cos(kmesh.points()[k()][0]) + 0.1 * i(), 0.)
+                                   : std::complex<double>(0.05, 0.02 * (i() - j()));
+        }
+      }
+    }
+    return hk;
+  }
+
+  /// G(iw, k) from the Dyson equation, orbital block by orbital block
+  std::complex<double> reference(const hk_type &hk, const std::vector<const std::complex<double>*> &sigma,
+                                 int w, int k, int i, int j) const {
+    const int n = orbitals.extent();
+    Eigen::MatrixXcd A(n, n);
+    for (int i1 = 0; i1 < n; ++i1) {
+      for (int j1 = 0; j1 < n; ++j1) {
+        A(i1, j1) = -hk(g::momentum_index_mesh::index_type(k), g::index_mesh::index_type(i1), g::index_mesh::index_type(j1))
+                    - sigma[k][i1 * n + j1];
+      }
+      A(i1, i1) += std::complex<double>(mu, omega.points()[w]);
+    }
+    Eigen::MatrixXcd inv = A.inverse();
+    return inv(i, j);
+  }
+};
+
+TEST_P(DysonTest, LocalSelfEnergy) {
+  const int n = orbitals.extent();
+  hk_type hk = hamiltonian();
+  local_gf_type sigma(omega, orbitals, orbitals);
+  for (omega_mesh::index_type w(0); w < omega.extent(); ++w) {
+    for (g::index_mesh::index_type i(0); i < n; ++i) {
+      for (g::index_mesh::index_type j(0); j < n; ++j) {
+        sigma(w, i, j) = std::complex<double>(0.1 * (i() + j()), -0.5 / omega.points()[w()]);
+      }
+    }
+  }
+
+  gf_type gf(omega, kmesh, orbitals, orbitals);
+  g::solve_dyson(gf, sigma, hk, mu);
+
+  for (int w = 0; w < omega.extent(); ++w) {
+    std::vector<const std::complex<double>*> sigma_w(nk, &sigma.data()(w, 0, 0));
+    for (int k = 0; k < nk; ++k) {
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+          std::complex<double> expected = reference(hk, sigma_w, w, k, i, j);
+          std::complex<double> actual = gf(omega_mesh::index_type(w), g::momentum_index_mesh::index_type(k),
+                                           g::index_mesh::index_type(i), g::index_mesh::index_type(j));
+          ASSERT_NEAR(expected.real(), actual.real(), 1e-12);
+          ASSERT_NEAR(expected.imag(), actual.imag(), 1e-12);
+        }
+      }
+    }
+  }
+}
+
+TEST_P(DysonTest, MomentumDependentSelfEnergy) {
+  const int n = orbitals.extent();
+  hk_type hk = hamiltonian();
+  gf_type sigma(omega, kmesh, orbitals, orbitals);
+  for (omega_mesh::index_type w(0); w < omega.extent(); ++w) {
+    for (g::momentum_index_mesh::index_type k(0); k < nk; ++k) {
+      for (g::index_mesh::index_type i(0); i < n; ++i) {
+        for (g::index_mesh::index_type j(0); j < n; ++j) {
+          sigma(w, k, i, j) = std::complex<double>(0.1 * i() * k(), -0.5 / omega.points()[w()] + 0.01 * j());
+        }
+      }
+    }
+  }
+
+  gf_type gf(omega, kmesh, orbitals, orbitals);
+  g::solve_dyson(gf, sigma, hk, mu);
+
+  for (int w = 0; w < omega.extent(); ++w) {
+    std::vector<const std::complex<double>*> sigma_w(nk);
+    for (int k = 0; k < nk; ++k) {
+      sigma_w[k] = &sigma.data()(w, k, 0, 0);
+    }
+    for (int k = 0; k < nk; ++k) {
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+          std::complex<double> expected = reference(hk, sigma_w, w, k, i, j);
+          std::complex<double> actual = gf(omega_mesh::index_type(w), g::momentum_index_mesh::index_type(k),
+                                           g::index_mesh::index_type(i), g::index_mesh::index_type(j));
+          ASSERT_NEAR(expected.real(), actual.real(), 1e-12);
+          ASSERT_NEAR(expected.imag(), actual.imag(), 1e-12);
+        }
+      }
+    }
+  }
+
+  // inverting the blocks again gives iw + mu - H(k) - Sigma(iw, k)
+  g::invert_blocks(gf);
+  const int w = 2, k = 3;
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      std::complex<double> expected = (i == j ? std::complex<double>(mu, omega.points()[w]) : 0.)
+        - hk(g::momentum_index_mesh::index_type(k), g::index_mesh::index_type(i), g::index_mesh::index_type(j))
+        - sigma.data()(w, k, i, j);
+      std::complex<double> actual = gf(omega_mesh::index_type(w), g::momentum_index_mesh::index_type(k),
+                                       g::index_mesh::index_type(i), g::index_mesh::index_type(j));
+      ASSERT_NEAR(expected.real(), actual.real(), 1e-10);
+      ASSERT_NEAR(expected.imag(), actual.imag(), 1e-10);
+    }
+  }
+}
+
+TEST_P(DysonTest, IncompatibleMeshes) {
+  hk_type hk = hamiltonian();
+  local_gf_type sigma(omega, orbitals, orbitals);
+  gf_type gf(omega_mesh(beta, 10), kmesh, orbitals, orbitals);
+  EXPECT_THROW(g::solve_dyson(gf, sigma, hk, mu), std::invalid_argument);
+}
+
+// fixed-size kernels for 1 to 8 orbitals, and the dynamic one above
+INSTANTIATE_TEST_CASE_P(OrbitalBlocks, DysonTest, ::testing::Values(1, 2, 3, 4, 5, 8, 9));
@@ -58,6 +58,21 @@ public:
       g(n,alps::gf::index(1))=atomic_matsubara(n());
     }
   }
+  /// Set the tails of the atomic gf up to third order
+  template<typename GF>
+  void set_atomic_tails(GF &g){
+    density_matrix_type c=density_matrix_type(alps::gf::index_mesh(2));
+    c.initialize();
+    c(alps::gf::index(0))=1;
+    c(alps::gf::index(1))=1;
+    g.set_tail(1,c);
+    c(alps::gf::index(0))=U*density()-mu;
+    c(alps::gf::index(1))=U*density()-mu;
+    g.set_tail(2,c);
+    c(alps::gf::index(0))=(1-density())*mu*mu+density()*(mu-U)*(mu-U);
+    c(alps::gf::index(1))=(1-density())*mu*mu+density()*(mu-U)*(mu-U);
+    g.set_tail(3,c);
+  }
   void initialize_as_atomic_itime(itime_gf_type &g){
     for(alps::gf::itime_mesh::index_type n(0);n<ntau;++n){
       g(n,alps::gf::index(0))=atomic_itime(tau(n()));
@@ -174,6 +189,62 @@ TEST_F(AtomicFourierTestGF,MatsubaraToTimeFourierAwayHalfFilling){
   EXPECT_NEAR((g_tau-g_tau_2).norm(), 0, 1.e-7);
 }
 
+TEST_F(AtomicFourierTestGF,TimeToMatsubaraFourier){
+  mu=0;
+  U=0.2;
+  set_atomic_tails(g_tau);
+  initialize_as_atomic_itime(g_tau);
+
+  fourier_time_to_frequency(g_tau, g_omega);
+
+  initialize_as_atomic_matsubara(gf2);
+  EXPECT_NEAR((g_omega-gf2).norm(), 0, 1.e-10);
+  EXPECT_EQ(3, g_omega.max_tail_order());
+
+  // and back
+  fourier_frequency_to_time(g_omega, g_tau_2);
+  EXPECT_NEAR((g_tau-g_tau_2).norm(), 0, 1.e-10);
+}
+
+TEST_F(AtomicFourierTestGF,TimeToMatsubaraFourierPN){
+  mu=0;
+  U=0.2;
+  set_atomic_tails(g_tau);
+  initialize_as_atomic_itime(g_tau);
+  typedef alps::gf::two_index_gf_with_tail<alps::gf::greenf<std::complex<double>, alps::gf::matsubara_pn_mesh, alps::gf::index_mesh>,
+                                           alps::gf::one_index_gf<double, alps::gf::index_mesh> > pn_gf_type;
+  pn_gf_type g_pn(alps::gf::greenf<std::complex<double>, alps::gf::matsubara_pn_mesh, alps::gf::index_mesh>(
+      alps::gf::matsubara_pn_mesh(beta, 2*nfreq), alps::gf::index_mesh(2)));
+
+  fourier_time_to_frequency(g_tau, g_pn);
+  for (int n = -nfreq; n < nfreq; ++n) {
+    std::complex<double> expected = (1-density())/(std::complex<double>(0, (2.*n+1)*M_PI/beta)+mu) + density()/(std::complex<double>(0, (2.*n+1)*M_PI/beta)+mu-U);
+    EXPECT_NEAR(std::abs(g_pn(alps::gf::matsubara_pn_index(nfreq+n), alps::gf::index(1)) - expected), 0, 1.e-10) << "n=" << n;
+  }
+
+  fourier_frequency_to_time(g_pn, g_tau_2);
+  EXPECT_NEAR((g_tau-g_tau_2).norm(), 0, 1.e-10);
+}
+
+TEST_F(AtomicFourierTestGF,PowerMeshToMatsubaraFourier){
+  mu=0;
+  U=0.2;
+  typedef alps::gf::two_index_gf_with_tail<alps::gf::greenf<double, alps::gf::power_mesh, alps::gf::index_mesh>,
+                                           alps::gf::one_index_gf<double, alps::gf::index_mesh> > power_gf_type;
+  power_gf_type g_power(alps::gf::greenf<double, alps::gf::power_mesh, alps::gf::index_mesh>(
+      alps::gf::power_mesh(beta, 12, 16), alps::gf::index_mesh(2)));
+  set_atomic_tails(g_power);
+  for (alps::gf::power_mesh::index_type t(0); t < g_power.mesh1().extent(); ++t) {
+    g_power(t, alps::gf::index(0)) = atomic_itime(g_power.mesh1().points()[t()]);
+    g_power(t, alps::gf::index(1)) = atomic_itime(g_power.mesh1().points()[t()]);
+  }
+
+  fourier_time_to_frequency(g_power, g_omega);
+
+  initialize_as_atomic_matsubara(gf2);
+  EXPECT_NEAR((g_omega-gf2).norm(), 0, 1.e-8);
+}
+
 TEST_F(NoninteractingFourierTestGF,MatsubaraToTimeFourier){
   initialize_matsubara(g_omega);
   tail_type unity=tail_type(alps::gf::momentum_index_mesh(nk, 1), alps::gf::index_mesh(2));
@@ -223,3 +294,62 @@ TEST(FourierTestGF, FourierStrategy) {
   alps::gf::transform_vector_no_tail_matrix(matsubara_gf.data(),matsubara_gf.mesh1().points(), itime_gf_2.data(), itime_gf_2.mesh1().points(), itime_gf_2.mesh1().beta());
   EXPECT_NEAR((itime_gf_1-itime_gf_2).norm(), 0, 1.e-11);
 }
+
+TEST(FourierTestGF, FourierPlan) {
+  double beta = 100;
+  int nts = 1001;
+  int iwmax = 1000;
+  int nk = 10;
+  double mu = 0.1;
+  alps::gf::omega_k_sigma_gf matsubara_gf(alps::gf::matsubara_positive_mesh(beta,iwmax),
+                                          alps::gf::momentum_index_mesh(nk, 1),
+                                          alps::gf::index_mesh(2));
+  alps::gf::itime_k_sigma_gf itime_gf_1(alps::gf::itime_mesh(beta,nts),
+                                           alps::gf::momentum_index_mesh(nk, 1),
+                                           alps::gf::index_mesh(2));
+  alps::gf::itime_k_sigma_gf itime_gf_2(itime_gf_1);
+  alps::gf::itime_k_sigma_gf itime_gf_3(itime_gf_1);
+  for (alps::gf::matsubara_index iw(0); iw < matsubara_gf.mesh1().extent(); ++iw) {
+    for (alps::gf::momentum_index ik(0); ik < matsubara_gf.mesh2().extent(); ++ik) {
+      matsubara_gf(iw, ik, alps::gf::index(0)) = 1.0 / (std::complex<double>(0., matsubara_gf.mesh1().points()[iw()]) + mu - cos(2.0 * ik() * M_PI / nk) );
+      matsubara_gf(iw, ik, alps::gf::index(1)) = 1.0/  (std::complex<double>(0., matsubara_gf.mesh1().points()[iw()]) - mu - cos(2.0 * ik() * M_PI / nk) );
+    }
+  }
+  const std::vector<double>& omega = matsubara_gf.mesh1().points();
+  const std::vector<double>& tau = itime_gf_1.mesh1().points();
+  alps::gf::transform_vector_no_tail_loop(matsubara_gf.data(), omega, itime_gf_1.data(), tau, beta);
+
+  alps::gf::fourier_plan stored(omega, tau, beta, alps::gf::fourier_plan::blocked);
+  EXPECT_TRUE(stored.stores_twiddles());
+  stored.execute(matsubara_gf.data(), itime_gf_2.data());
+  EXPECT_NEAR((itime_gf_1-itime_gf_2).norm(), 0, 1.e-11);
+
+  // twiddle factors generated by recurrence for each block
+  alps::gf::fourier_plan generated(omega, tau, beta, alps::gf::fourier_plan::blocked, 0);
+  EXPECT_FALSE(generated.stores_twiddles());
+  generated.execute(matsubara_gf.data(), itime_gf_3.data());
+  EXPECT_NEAR((itime_gf_1-itime_gf_3).norm(), 0, 1.e-11);
+
+  alps::gf::itime_k_sigma_gf itime_gf_4(itime_gf_1);
+  alps::gf::fourier_plan fft(omega, tau, beta);
+  EXPECT_TRUE(fft.uses_fft());
+  EXPECT_FALSE(fft.stores_twiddles());
+  fft.execute(matsubara_gf.data(), itime_gf_4.data());
+  EXPECT_NEAR((itime_gf_1-itime_gf_4).norm(), 0, 1.e-11);
+
+  std::vector<double> bosonic(omega);
+  for (size_t k = 0; k < bosonic.size(); ++k) bosonic[k] = 2 * k * M_PI / beta;
+  EXPECT_FALSE(alps::gf::fourier_plan(bosonic, tau, beta).uses_fft());
+  EXPECT_THROW(alps::gf::fourier_plan(bosonic, tau, beta, alps::gf::fourier_plan::fft), std::invalid_argument);
+}
+
+TEST(FourierTestGF, CachedFourierPlan) {
+  alps::gf::matsubara_positive_mesh omega(10, 100);
+  alps::gf::itime_mesh tau(10, 101);
+  alps::gf::itime_mesh other_tau(20, 101);
+  std::shared_ptr<const alps::gf::fourier_plan> plan = alps::gf::cached_fourier_plan(omega.points(), tau.points(), tau.beta());
+  EXPECT_TRUE(plan->matches(omega.points(), tau.points(), tau.beta()));
+  EXPECT_EQ(plan, alps::gf::cached_fourier_plan(omega.points(), tau.points(), tau.beta()));
+  EXPECT_NE(plan, alps::gf::cached_fourier_plan(omega.points(), other_tau.points(), other_tau.beta()));
+  EXPECT_EQ(plan, alps::gf::cached_fourier_plan(omega.points(), tau.points(), tau.beta()));
+}
@@ -394,3 +394,29 @@ TEST(GreensFunction, ConstructorTests){
     }
   }
 }
+
+TEST(GreensFunction, Allocators) {
+  typedef alps::numerics::huge_page_allocator<std::complex<double> > alloc_type;
+  alps::gf::matsubara_positive_mesh x(100, 10);
+  alps::gf::index_mesh y(10);
+  greenf_alloc<std::complex<double>, alloc_type, alps::gf::matsubara_positive_mesh, alps::gf::index_mesh> g(x, y);
+  greenf<std::complex<double>, alps::gf::matsubara_positive_mesh, alps::gf::index_mesh> g2(x, y);
+  ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(g.data().data()) % 64);
+  for(alps::gf::matsubara_positive_mesh::index_type w(0); w<x.extent(); ++w) {
+    for(alps::gf::index_mesh::index_type i(0); i<y.extent(); ++i) {
+      g(w, i) = 3.0 * i() + w();
+      g2(w, i) = 3.0 * i() + w();
+    }
+  }
+  g *= 2.0;
+  g2 += g2;
+  greenf_view<std::complex<double>, alps::gf::index_mesh> g3 = g(alps::gf::matsubara_positive_mesh::index_type(1));
+  ASSERT_EQ(g2(alps::gf::matsubara_positive_mesh::index_type(1), alps::gf::index_mesh::index_type(2)),
+            g3(alps::gf::index_mesh::index_type(2)));
+
+  alps::hdf5::archive ar("test_alloc.h5", "w");
+  g.save(ar, "");
+  greenf_alloc<std::complex<double>, alloc_type, alps::gf::matsubara_positive_mesh, alps::gf::index_mesh> g4;
+  g4.load(ar, "");
+  ASSERT_TRUE(g4 == g);
+}
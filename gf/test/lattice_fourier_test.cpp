@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include "gtest/gtest.h"
+#include <alps/gf/gf.hpp>
+#include "alps/gf/lattice_fourier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace g=alps::gf;
+
+class LatticeFourierTest : public ::testing::Test
+{
+public:
+  typedef g::matsubara_positive_mesh omega_mesh;
+  typedef g::greenf<std::complex<double>, omega_mesh, g::momentum_index_mesh, g::index_mesh> k_gf_type;
+  typedef g::greenf<std::complex<double>, omega_mesh, g::real_space_index_mesh, g::index_mesh> r_gf_type;
+
+  const int L0, L1;
+  const double a;
+  omega_mesh omega;
+  g::index_mesh orbitals;
+  g::momentum_index_mesh kmesh;
+  g::real_space_index_mesh rmesh;
+
+  /// 4x3 rectangular lattice with lattice constant a; the momenta are shuffled and shifted to (-pi/a, pi/a]
+  LatticeFourierTest() : L0(4), L1(3), a(0.5), omega(5., 4), orbitals(2), kmesh(L0*L1, 2), rmesh(L0*L1, 2) {
+    std::vector<int> order(L0*L1);
+    for (int p = 0; p < L0*L1; ++p) order[p] = p;
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    for (int p = 0; p < L0*L1; ++p) {
+      rmesh.points()[p][0] = a * (p / L1);
+      rmesh.points()[p][1] = a * (p % L1);
+      int m0 = order[p] / L1, m1 = order[p] % L1;
+      kmesh.points()[p][0] = 2 * M_PI * (m0 > L0/2 ? m0 - L0 : m0) / (a * L0);
+      kmesh.points()[p][1] = 2 * M_PI * (m1 > L1/2 ? m1 - L1 : m1) / (a * L1);
+    }
+  }
+
+  k_gf_type random_gf() const {
+    k_gf_type gk(omega, kmesh, orbitals);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+    for (size_t i = 0; i < gk.data().size(); ++i) {
+      gk.data().data()[i] = std::complex<double>(dist(rng), dist(rng));
+    }
+    return gk;
+  }
+
+  /// 1/N_k sum_k e^{i k.r} G(k), computed directly
+  std::complex<double> reference(const k_gf_type &gk, int w, int r, int s) const {
+    std::complex<double> sum = 0.;
+    for (int k = 0; k < kmesh.extent(); ++k) {
+      double kr = kmesh.points()[k][0] * rmesh.points()[r][0] + kmesh.points()[k][1] * rmesh.points()[r][1];
+      sum += std::polar(1., kr) * gk(omega_mesh::index_type(w), g::momentum_index_mesh::index_type(k), g::index_mesh::index_type(s));
+    }
+    return sum / double(kmesh.extent());
+  }
+};
+
+TEST_F(LatticeFourierTest, FFTMatchesDirectSum) {
+  g::lattice_fourier_plan plan(kmesh, rmesh);
+  ASSERT_TRUE(plan.uses_fft());
+  ASSERT_EQ(2u, plan.grid_shape().size());
+  EXPECT_EQ(size_t(L0), plan.grid_shape()[0]);
+  EXPECT_EQ(size_t(L1), plan.grid_shape()[1]);
+
+  k_gf_type gk = random_gf();
+  r_gf_type gr(omega, rmesh, orbitals), gr_direct(omega, rmesh, orbitals);
+  g::fourier_momentum_to_space<1>(gk, gr);
+  g::fourier_momentum_to_space<1>(gk, gr_direct, g::lattice_fourier_plan::direct);
+
+  for (int w = 0; w < omega.extent(); ++w) {
+    for (int r = 0; r < rmesh.extent(); ++r) {
+      for (int s = 0; s < orbitals.extent(); ++s) {
+        std::complex<double> expected = reference(gk, w, r, s);
+        std::complex<double> fft = gr.data()(w, r, s), direct = gr_direct.data()(w, r, s);
+        ASSERT_NEAR(expected.real(), fft.real(), 1e-12);
+        ASSERT_NEAR(expected.imag(), fft.imag(), 1e-12);
+        ASSERT_NEAR(expected.real(), direct.real(), 1e-12);
+        ASSERT_NEAR(expected.imag(), direct.imag(), 1e-12);
+      }
+    }
+  }
+}
+
+TEST_F(LatticeFourierTest, RoundTrip) {
+  k_gf_type gk = random_gf();
+  k_gf_type gk2(omega, kmesh, orbitals), gk3(omega, kmesh, orbitals);
+  r_gf_type gr(omega, rmesh, orbitals);
+  g::fourier_momentum_to_space<1>(gk, gr);
+  g::fourier_space_to_momentum<1>(gr, gk2);
+  g::fourier_space_to_momentum<1>(gr, gk3, g::lattice_fourier_plan::direct);
+  for (size_t i = 0; i < gk.data().size(); ++i) {
+    ASSERT_NEAR(std::abs(gk.data().data()[i] - gk2.data().data()[i]), 0., 1e-12);
+    ASSERT_NEAR(std::abs(gk.data().data()[i] - gk3.data().data()[i]), 0., 1e-12);
+  }
+}
+
+TEST_F(LatticeFourierTest, FirstIndex) {
+  g::greenf<std::complex<double>, g::momentum_index_mesh, g::index_mesh> gk(kmesh, orbitals);
+  g::greenf<std::complex<double>, g::real_space_index_mesh, g::index_mesh> gr(rmesh, orbitals);
+  for (int k = 0; k < kmesh.extent(); ++k) {
+    gk.data()(k, 0) = 1.;
+    gk.data()(k, 1) = std::polar(1., -kmesh.points()[k][1] * a);
+  }
+  g::fourier_momentum_to_space<0>(gk, gr);
+  // a constant is local, a phase e^{-i k.r0} is a delta at r0 = (0, a)
+  for (int r = 0; r < rmesh.extent(); ++r) {
+    bool origin = rmesh.points()[r][0] == 0. && rmesh.points()[r][1] == 0.;
+    bool r0 = rmesh.points()[r][0] == 0. && rmesh.points()[r][1] == a;
+    ASSERT_NEAR(origin ? 1. : 0., std::abs(gr.data()(r, 0)), 1e-12);
+    ASSERT_NEAR(r0 ? 1. : 0., std::abs(gr.data()(r, 1)), 1e-12);
+  }
+}
+
+TEST_F(LatticeFourierTest, IrregularPoints) {
+  // a cluster of real space points which is not a lattice, and fewer momenta than points
+  g::real_space_index_mesh cluster(5, 2);
+  g::momentum_index_mesh momenta(3, 2);
+  for (int p = 0; p < 5; ++p) {
+    cluster.points()[p][0] = 0.3 * p;
+    cluster.points()[p][1] = 0.1 * p * p;
+  }
+  for (int k = 0; k < 3; ++k) {
+    momenta.points()[k][0] = 0.7 * k;
+    momenta.points()[k][1] = -0.2 * k;
+  }
+  g::lattice_fourier_plan plan(momenta, cluster);
+  EXPECT_FALSE(plan.uses_fft());
+  EXPECT_THROW(g::lattice_fourier_plan(momenta, cluster, g::lattice_fourier_plan::fft), std::invalid_argument);
+
+  std::vector<std::complex<double> > in(2 * 3), out(2 * 5);
+  for (size_t i = 0; i < in.size(); ++i) in[i] = std::complex<double>(i, 1.);
+  plan.momentum_to_space(in.data(), out.data(), 2, 1);
+  for (int o = 0; o < 2; ++o) {
+    for (int r = 0; r < 5; ++r) {
+      std::complex<double> expected = 0.;
+      for (int k = 0; k < 3; ++k) {
+        double kr = momenta.points()[k][0] * cluster.points()[r][0] + momenta.points()[k][1] * cluster.points()[r][1];
+        expected += std::polar(1., kr) * in[o * 3 + k] / 3.;
+      }
+      ASSERT_NEAR(std::abs(expected - out[o * 5 + r]), 0., 1e-12);
+    }
+  }
+}
+
+TEST_F(LatticeFourierTest, IncompatibleMeshes) {
+  k_gf_type gk = random_gf();
+  r_gf_type gr(omega_mesh(5., 8), rmesh, orbitals);
+  EXPECT_THROW(g::fourier_momentum_to_space<1>(gk, gr), std::invalid_argument);
+  g::real_space_index_mesh line(L0*L1, 1);
+  EXPECT_THROW(g::lattice_fourier_plan(kmesh, line), std::invalid_argument);
+}
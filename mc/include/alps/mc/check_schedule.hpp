@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <ctime>
 
 namespace alps {
@@ -126,8 +127,29 @@ namespace alps {
                 return std::difftime(t1, t0);
             }
         };
+
+        /// Type for monotonic wall-clock time with sub-second resolution
+        /** Unlike `posix_wall_clock`, it is not affected by adjustments of the
+            system time, and check intervals shorter than a second are meaningful. */
+        class steady_clock {
+          public:
+            /// Type for "point at time" (that is, duration from some epoch)
+            typedef std::chrono::steady_clock::time_point time_point_type;
+
+            /// Type for "duration of time" in seconds (that is, difference between to points in time)
+            typedef double time_duration_type;
+
+            /// Returns current time point
+            static time_point_type now_time() { return std::chrono::steady_clock::now(); }
+
+            /// Returns a difference (duration) between time points
+            static time_duration_type time_diff(time_point_type t1, time_point_type t0)
+            {
+                return std::chrono::duration<double>(t1 - t0).count();
+            }
+        };
     } // detail::
         
-    typedef detail::generic_check_schedule<detail::posix_wall_clock> check_schedule;
+    typedef detail::generic_check_schedule<detail::steady_clock> check_schedule;
 
 } // namespace alps 
@@ -18,7 +18,10 @@
 // move to alps::mcbase root scope
 namespace alps {
 
-    class mcbase {
+    /// Base class of Monte Carlo simulations, drawing random numbers with an engine of type `Engine`
+    /** Explicitly instantiated for `boost::mt19937` (`alps::mcbase`), and for
+        `alps::xoshiro256pp` and `alps::philox4x32` (see random_engines.hpp). */
+    template<typename Engine> class basic_mcbase {
 
         protected:
 
@@ -31,7 +34,9 @@ namespace alps {
 
             typedef alps::accumulators::result_set results_type;
 
-            mcbase(parameters_type const & parms, std::size_t seed_offset = 0);
+            typedef basic_random01<Engine> random_type;
+
+            basic_mcbase(parameters_type const & parms, std::size_t seed_offset = 0);
 
             static parameters_type& define_parameters(parameters_type & parameters);
 
@@ -54,10 +59,10 @@ namespace alps {
 
             parameters_type parameters;
             // parameters_type & params; // TODO: deprecated, remove!
-            alps::random01 random;
+            random_type random;
             observable_collection_type measurements;
     };
 
-    
+    typedef basic_mcbase<boost::mt19937> mcbase;
 }
 
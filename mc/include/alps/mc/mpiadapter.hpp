@@ -14,12 +14,66 @@
 #if defined(ALPS_HAVE_MPI)
 
 #include <alps/accumulators/mpi.hpp>
+#include <alps/accumulators/collective_merge.hpp>
 #include <alps/mc/check_schedule.hpp>
 
+#include <memory>
+
 namespace alps {
 
     namespace detail {
 
+        /// Sum of a `double` over the ranks, computed in the background by `MPI_Iallreduce`
+        /** Without MPI-3, the sum is computed by a blocking `MPI_Allreduce` in `start()`. */
+        class async_sum {
+        public:
+            explicit async_sum(alps::mpi::communicator const & comm)
+                : communicator(comm), request(MPI_REQUEST_NULL), pending(false), local(0.), global(0.)
+            {}
+
+            /// Waits for the outstanding reduction, which writes to this object
+            ~async_sum() {
+                if (request != MPI_REQUEST_NULL)
+                    MPI_Wait(&request, MPI_STATUS_IGNORE);
+            }
+
+            /// Returns `true` while a reduction is in progress, or its sum has not been taken by `test()`
+            bool active() const {
+                return pending;
+            }
+
+            /// Start summing `value` over the ranks (collective; no reduction may be in progress)
+            void start(double value) {
+                local = value;
+                pending = true;
+#if MPI_VERSION >= 3
+                MPI_Iallreduce(&local, &global, 1, MPI_DOUBLE, MPI_SUM, communicator, &request);
+#else
+                MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_SUM, communicator);
+#endif
+            }
+
+            /// Returns `true`, and the sum in `sum`, if the reduction is complete
+            bool test(double & sum) {
+                int flag;
+                MPI_Test(&request, &flag, MPI_STATUS_IGNORE);
+                if (flag) {
+                    sum = global;
+                    pending = false;
+                }
+                return flag != 0;
+            }
+
+        private:
+            async_sum(async_sum const &);
+            async_sum & operator=(async_sum const &);
+
+            alps::mpi::communicator communicator;
+            MPI_Request request;
+            bool pending;
+            double local, global;
+        };
+
         /// Base class for mcmpiadapter; should never be instantiated by a user
 
         template<typename Base, typename ScheduleChecker> class mcmpiadapter_base : public Base {
@@ -50,7 +104,9 @@ namespace alps {
             )
                 : Base(parameters, comm.rank()*rng_seed_step + rng_seed_base)
                 , communicator(comm)
+                , topology(std::make_shared<alps::accumulators::merge_topology const>(comm, 0))
                 , schedule_checker(check)
+                , fraction(0.)
                 , clone(comm.rank())
             {}
 
@@ -59,15 +115,22 @@ namespace alps {
                 return fraction;
             }
 
+            /// Run the simulation until it is completed on all ranks, or stopped by `stop_callback`
+            /** The fractions completed are summed over the ranks in the background (`MPI_Iallreduce`):
+                each rank goes on updating and measuring until the sum is available,
+                instead of waiting for the slowest rank at every check. */
             bool run(boost::function<bool ()> const & stop_callback) {
                 bool done = false, stopped = false;
+                async_sum global_fraction(communicator);
                 do {
                     this->update();
                     this->measure();
-                    if (stopped || schedule_checker.pending()) {
+                    if (!global_fraction.active() && (stopped || schedule_checker.pending())) {
                         stopped = stop_callback();
-                        double local_fraction = stopped ? 1. : Base::fraction_completed();
-                        schedule_checker.update(fraction = alps::mpi::all_reduce(communicator, local_fraction, std::plus<double>()));
+                        global_fraction.start(stopped ? 1. : Base::fraction_completed());
+                    }
+                    if (global_fraction.active() && global_fraction.test(fraction)) {
+                        schedule_checker.update(fraction);
                         done = fraction >= 1.;
                     }
                 } while(!done);
@@ -78,21 +141,21 @@ namespace alps {
                 return collect_results(this->result_names());
             }
 
+            /// Merge the measurements `names` over all ranks, in a few collective operations for all of them
+            /** The data are reduced within each node first, and then between the nodes (see `collective_merge_request`).
+                @note Observables measured on no rank are skipped; an observable measured on some ranks only is an error. */
             typename Base::results_type collect_results(typename Base::result_names_type const & names) const {
-                typename Base::results_type partial_results;
+                typedef typename Base::observable_collection_type::value_type observable_type;
+                alps::accumulators::collective_merge_request::accumulators_type merged;
                 for(typename Base::result_names_type::const_iterator it = names.begin(); it != names.end(); ++it) {
-                    size_t has_count=(this->measurements[*it].count() > 0);
-                    const size_t sum_counts =
-                            alps::mpi::all_reduce(communicator,
-                                                  has_count,
-                                                  std::plus<size_t>());
-                    if (static_cast<int>(sum_counts) == communicator.size()) {
-                        typename Base::observable_collection_type::value_type merged = this->measurements[*it];
-                        merged.collective_merge(communicator, 0);
-                        partial_results.insert(*it, merged.result());
-                    } else if (sum_counts > 0 && static_cast<int>(sum_counts) < communicator.size()) {
-                        throw std::runtime_error(*it + " was measured on only some of the MPI processes.");
-                    }
+                    merged.push_back(std::make_pair(*it, std::make_shared<observable_type>(this->measurements[*it])));
+                }
+                alps::accumulators::collective_merge_request(merged, topology).wait();
+
+                typename Base::results_type partial_results;
+                for(typename alps::accumulators::collective_merge_request::accumulators_type::const_iterator it = merged.begin(); it != merged.end(); ++it) {
+                    if (it->second->count() > 0)
+                        partial_results.insert(it->first, it->second->result());
                 }
                 return partial_results;
             }
@@ -100,6 +163,8 @@ namespace alps {
         protected:
 
             alps::mpi::communicator communicator;
+            /// The nodes of `communicator`, split once for all merges of the results
+            std::shared_ptr<alps::accumulators::merge_topology const> topology;
 
             ScheduleChecker schedule_checker;
             double fraction;
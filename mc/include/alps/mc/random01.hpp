@@ -7,31 +7,108 @@
 #pragma once
 
 #include <alps/hdf5/archive.hpp>
+#include <alps/hdf5/vector.hpp>
+#include <alps/mc/random_engines.hpp>
 
 #include <boost/random.hpp>
 
+#include <cstddef>
 #include <string>
 #include <sstream>
+#include <vector>
 
 namespace alps {
 
-    struct random01 : public boost::variate_generator<boost::mt19937, boost::uniform_01<double> > {
-        random01(int seed = 42)
-            : boost::variate_generator<boost::mt19937, boost::uniform_01<double> >(boost::mt19937(seed), boost::uniform_01<double>())
-        {}
+    namespace detail {
 
-        void save(alps::hdf5::archive & ar) const { // TODO: move this to hdf5 archive!
+        /// Save the state of a generic engine, as text
+        template<typename Engine> void save_engine(alps::hdf5::archive & ar, Engine const & engine) {
             std::ostringstream os;
-            os << this->engine();
+            os << engine;
             ar["engine"] << os.str();
         }
 
-        void load(alps::hdf5::archive & ar) { // TODO: move this to hdf5 archive!
+        /// Load the state of a generic engine, from text
+        template<typename Engine> void load_engine(alps::hdf5::archive & ar, Engine & engine) {
             std::string state;
             ar["engine"] >> state;
             std::istringstream is(state);
-            is >> this->engine();
+            is >> engine;
+        }
+
+        /// Save the state of an engine with a binary state (`state()` / `set_state()`)
+        template<typename Engine> void save_engine_state(alps::hdf5::archive & ar, Engine const & engine) {
+            ar["state"] << engine.state();
+        }
+
+        template<typename Engine> void load_engine_state(alps::hdf5::archive & ar, Engine & engine) {
+            typename Engine::state_type state;
+            ar["state"] >> state;
+            engine.set_state(state);
+        }
+
+        inline void save_engine(alps::hdf5::archive & ar, xoshiro256pp const & engine) { save_engine_state(ar, engine); }
+        inline void load_engine(alps::hdf5::archive & ar, xoshiro256pp & engine) { load_engine_state(ar, engine); }
+
+        inline void save_engine(alps::hdf5::archive & ar, philox4x32 const & engine) { save_engine_state(ar, engine); }
+        inline void load_engine(alps::hdf5::archive & ar, philox4x32 & engine) { load_engine_state(ar, engine); }
+
+        /// Save the state of a Mersenne twister as its 624 words (unlike the default, as binary data)
+        inline void save_engine(alps::hdf5::archive & ar, boost::mt19937 const & engine) {
+            std::stringstream ss;
+            ss << engine;
+            std::vector<boost::uint32_t> state(boost::mt19937::state_size);
+            for (std::size_t i = 0; i < state.size(); ++i)
+                ss >> state[i];
+            ar["state"] << state;
+        }
+
+        /// Load the state of a Mersenne twister; also reads the text state of older checkpoints
+        inline void load_engine(alps::hdf5::archive & ar, boost::mt19937 & engine) {
+            if (!ar.is_data("state")) {
+                load_engine<boost::mt19937>(ar, engine);
+                return;
+            }
+            std::vector<boost::uint32_t> state;
+            ar["state"] >> state;
+            if (state.size() != boost::mt19937::state_size)
+                throw std::invalid_argument("Invalid state of a Mersenne twister engine" + ALPS_STACKTRACE);
+            std::stringstream ss;
+            for (std::size_t i = 0; i < state.size(); ++i)
+                ss << state[i] << ' ';
+            ss >> engine;
+        }
+    }
+
+    /// Generator of random numbers uniformly distributed in [0,1), driven by an engine of type `Engine`
+    /** The engine is accessible by `engine()`, e.g. to draw from other distributions.
+        The engine state is checkpointed in binary form for the Mersenne twister and the engines of
+        random_engines.hpp, and as text for the other engines. */
+    template<typename Engine> struct basic_random01 : public boost::variate_generator<Engine, boost::uniform_01<double> > {
+        typedef Engine engine_type;
+        typedef boost::variate_generator<Engine, boost::uniform_01<double> > base_type;
+
+        basic_random01(int seed = 42)
+            : base_type(Engine(seed), boost::uniform_01<double>())
+        {}
+
+        /// Fill `out[0..n)` with the next `n` random numbers (the same as `n` calls of `operator()`)
+        void fill(double * out, std::size_t n) {
+            Engine & eng = this->engine();
+            boost::uniform_01<double> & dist = this->distribution();
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = dist(eng);
+        }
+
+        void save(alps::hdf5::archive & ar) const { // TODO: move this to hdf5 archive!
+            detail::save_engine(ar, this->engine());
+        }
+
+        void load(alps::hdf5::archive & ar) { // TODO: move this to hdf5 archive!
+            detail::load_engine(ar, this->engine());
         }
     };
 
+    typedef basic_random01<boost::mt19937> random01;
+
 }
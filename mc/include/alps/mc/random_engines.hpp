@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file random_engines.hpp
+    @brief Fast random number engines with a compact binary state
+
+    The engines model the Boost/C++11 uniform random number engine concept
+    (`result_type`, `min()`, `max()`, `operator()`, `discard()`, equality),
+    and can thus be used with `alps::basic_random01` and `alps::basic_mcbase`.
+    Their state is a short array of integers, which is checkpointed as binary
+    data (see `state()` and `set_state()`).
+*/
+
+#pragma once
+
+#include <boost/cstdint.hpp>
+
+#include <alps/utilities/stacktrace.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace alps {
+
+    /// xoshiro256++ 1.0 engine of Blackman and Vigna: 256 bits of state, period 2^256-1
+    /** The state is initialized from the seed by the SplitMix64 generator,
+        as recommended by the authors. */
+    class xoshiro256pp {
+        public:
+            typedef boost::uint64_t result_type;
+            typedef std::vector<boost::uint64_t> state_type;
+
+            static const result_type default_seed = 42;
+
+            explicit xoshiro256pp(result_type seed = default_seed) { this->seed(seed); }
+
+            void seed(result_type value) {
+                for (std::size_t i = 0; i < 4; ++i) {
+                    // SplitMix64
+                    value += 0x9e3779b97f4a7c15ULL;
+                    boost::uint64_t z = value;
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                    m_s[i] = z ^ (z >> 31);
+                }
+            }
+
+            static result_type min() { return 0; }
+            static result_type max() { return ~result_type(0); }
+
+            result_type operator()() {
+                const result_type result = rotl(m_s[0] + m_s[3], 23) + m_s[0];
+                const result_type t = m_s[1] << 17;
+                m_s[2] ^= m_s[0];
+                m_s[3] ^= m_s[1];
+                m_s[1] ^= m_s[2];
+                m_s[0] ^= m_s[3];
+                m_s[2] ^= t;
+                m_s[3] = rotl(m_s[3], 45);
+                return result;
+            }
+
+            void discard(boost::uint64_t n) {
+                for (; n != 0; --n)
+                    (*this)();
+            }
+
+            state_type state() const { return state_type(m_s, m_s + 4); }
+
+            void set_state(state_type const & s) {
+                if (s.size() != 4 || (s[0] == 0 && s[1] == 0 && s[2] == 0 && s[3] == 0))
+                    throw std::invalid_argument("Invalid state of a xoshiro256++ engine" + ALPS_STACKTRACE);
+                std::copy(s.begin(), s.end(), m_s);
+            }
+
+            friend bool operator==(xoshiro256pp const & lhs, xoshiro256pp const & rhs) {
+                return std::equal(lhs.m_s, lhs.m_s + 4, rhs.m_s);
+            }
+            friend bool operator!=(xoshiro256pp const & lhs, xoshiro256pp const & rhs) {
+                return !(lhs == rhs);
+            }
+
+        private:
+            static result_type rotl(result_type x, int k) {
+                return (x << k) | (x >> (64 - k));
+            }
+
+            result_type m_s[4];
+    };
+
+    /// Philox4x32-10 counter-based engine of Salmon et al. (Random123)
+    /** The output is a bijective function of a 128 bit counter, keyed by a 64 bit key:
+        engines with different keys (e.g. one per thread or per MPI rank) give independent streams,
+        and `discard()` is a constant-time jump. The key is the seed. */
+    class philox4x32 {
+        public:
+            typedef boost::uint32_t result_type;
+            typedef std::vector<boost::uint32_t> state_type;
+
+            static const boost::uint64_t default_seed = 42;
+
+            explicit philox4x32(boost::uint64_t seed = default_seed) { this->seed(seed); }
+
+            /// Set the key to `value` and rewind the counter
+            void seed(boost::uint64_t value) {
+                m_key[0] = static_cast<result_type>(value);
+                m_key[1] = static_cast<result_type>(value >> 32);
+                m_ctr[0] = m_ctr[1] = m_ctr[2] = m_ctr[3] = 0;
+                m_pos = 4;
+            }
+
+            static result_type min() { return 0; }
+            static result_type max() { return ~result_type(0); }
+
+            result_type operator()() {
+                if (m_pos == 4) {
+                    block(m_ctr, m_key, m_out);
+                    increment(1);
+                    m_pos = 0;
+                }
+                return m_out[m_pos++];
+            }
+
+            void discard(boost::uint64_t n) {
+                const boost::uint64_t buffered = 4 - m_pos;
+                if (n <= buffered) {
+                    m_pos += static_cast<unsigned>(n);
+                    return;
+                }
+                n -= buffered;
+                increment(n / 4);
+                m_pos = 4;
+                for (n %= 4; n != 0; --n)
+                    (*this)();
+            }
+
+            /// Compute the block of 4 outputs for a counter and a key
+            static void block(result_type const ctr[4], result_type const key[2], result_type out[4]) {
+                result_type c[4] = { ctr[0], ctr[1], ctr[2], ctr[3] };
+                result_type k[2] = { key[0], key[1] };
+                for (int r = 0; r < 10; ++r) {
+                    if (r != 0) {
+                        k[0] += 0x9E3779B9U;
+                        k[1] += 0xBB67AE85U;
+                    }
+                    const boost::uint64_t p0 = boost::uint64_t(0xD2511F53U) * c[0];
+                    const boost::uint64_t p1 = boost::uint64_t(0xCD9E8D57U) * c[2];
+                    const result_type hi0 = static_cast<result_type>(p0 >> 32), lo0 = static_cast<result_type>(p0);
+                    const result_type hi1 = static_cast<result_type>(p1 >> 32), lo1 = static_cast<result_type>(p1);
+                    c[0] = hi1 ^ c[1] ^ k[0];
+                    c[1] = lo1;
+                    c[2] = hi0 ^ c[3] ^ k[1];
+                    c[3] = lo0;
+                }
+                std::copy(c, c + 4, out);
+            }
+
+            /// The state: key (2 words), counter of the next block (4 words), position in the current block
+            state_type state() const {
+                state_type s(m_key, m_key + 2);
+                s.insert(s.end(), m_ctr, m_ctr + 4);
+                s.push_back(m_pos);
+                return s;
+            }
+
+            void set_state(state_type const & s) {
+                if (s.size() != 7 || s[6] > 4)
+                    throw std::invalid_argument("Invalid state of a Philox4x32 engine" + ALPS_STACKTRACE);
+                std::copy(s.begin(), s.begin() + 2, m_key);
+                std::copy(s.begin() + 2, s.begin() + 6, m_ctr);
+                m_pos = s[6];
+                if (m_pos != 4) {
+                    // recompute the current block
+                    result_type ctr[4] = { m_ctr[0], m_ctr[1], m_ctr[2], m_ctr[3] };
+                    decrement(ctr);
+                    block(ctr, m_key, m_out);
+                }
+            }
+
+            friend bool operator==(philox4x32 const & lhs, philox4x32 const & rhs) {
+                return lhs.state() == rhs.state();
+            }
+            friend bool operator!=(philox4x32 const & lhs, philox4x32 const & rhs) {
+                return !(lhs == rhs);
+            }
+
+        private:
+            void increment(boost::uint64_t n) {
+                const boost::uint64_t low = (boost::uint64_t(m_ctr[1]) << 32 | m_ctr[0]);
+                const boost::uint64_t sum = low + n;
+                m_ctr[0] = static_cast<result_type>(sum);
+                m_ctr[1] = static_cast<result_type>(sum >> 32);
+                if (sum < low && ++m_ctr[2] == 0)
+                    ++m_ctr[3];
+            }
+
+            static void decrement(result_type ctr[4]) {
+                for (int i = 0; i < 4 && ctr[i]-- == 0; ++i);
+            }
+
+            result_type m_key[2];
+            result_type m_ctr[4];
+            result_type m_out[4];
+            result_type m_pos;
+    };
+
+}
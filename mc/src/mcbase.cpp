@@ -9,28 +9,28 @@
 
 namespace alps {
 
-    mcbase::mcbase(parameters_type const & parms, std::size_t seed_offset)
+    template<typename Engine> basic_mcbase<Engine>::basic_mcbase(parameters_type const & parms, std::size_t seed_offset)
         : parameters(parms)
         , random(std::size_t(parameters["SEED"]) + seed_offset)
     {
         alps::signal::listen();
     }
 
-    mcbase::parameters_type& mcbase::define_parameters(parameters_type & parameters) {
+    template<typename Engine> typename basic_mcbase<Engine>::parameters_type& basic_mcbase<Engine>::define_parameters(parameters_type & parameters) {
         return parameters.define<long>("SEED", 42, "PRNG seed");
     }
 
-  void mcbase::save(std::string const & filename) const {
+  template<typename Engine> void basic_mcbase<Engine>::save(std::string const & filename) const {
         alps::hdf5::archive ar(filename, "w");
         ar["/simulation/realizations/0/clones/0"] << *this;
     }
 
-    void mcbase::load(std::string const & filename) {
+    template<typename Engine> void basic_mcbase<Engine>::load(std::string const & filename) {
         alps::hdf5::archive ar(filename);
         ar["/simulation/realizations/0/clones/0"] >> *this;
     }
 
-    bool mcbase::run(boost::function<bool ()> const & stop_callback) {
+    template<typename Engine> bool basic_mcbase<Engine>::run(boost::function<bool ()> const & stop_callback) {
         bool stopped = false;
         while(!(stopped = stop_callback()) && fraction_completed() < 1.) {
             update();
@@ -40,39 +40,43 @@ namespace alps {
     }
 
     // implement a nice keys(m) function
-    mcbase::result_names_type mcbase::result_names() const {
+    template<typename Engine> typename basic_mcbase<Engine>::result_names_type basic_mcbase<Engine>::result_names() const {
         result_names_type names;
-        for(observable_collection_type::const_iterator it = measurements.begin(); it != measurements.end(); ++it)
+        for(typename observable_collection_type::const_iterator it = measurements.begin(); it != measurements.end(); ++it)
             names.push_back(it->first);
         return names;
     }
 
-    mcbase::result_names_type mcbase::unsaved_result_names() const {
+    template<typename Engine> typename basic_mcbase<Engine>::result_names_type basic_mcbase<Engine>::unsaved_result_names() const {
         return result_names_type(); 
     }
 
-    mcbase::results_type mcbase::collect_results() const {
+    template<typename Engine> typename basic_mcbase<Engine>::results_type basic_mcbase<Engine>::collect_results() const {
         return collect_results(result_names());
     }
 
-    mcbase::results_type mcbase::collect_results(result_names_type const & names) const {
+    template<typename Engine> typename basic_mcbase<Engine>::results_type basic_mcbase<Engine>::collect_results(result_names_type const & names) const {
         results_type partial_results;
-        for(result_names_type::const_iterator it = names.begin(); it != names.end(); ++it){
+        for(typename result_names_type::const_iterator it = names.begin(); it != names.end(); ++it){
                 partial_results.insert(*it, measurements[*it].result());
         }
         return partial_results;
     }
 
-    void mcbase::save(alps::hdf5::archive & ar) const {
+    template<typename Engine> void basic_mcbase<Engine>::save(alps::hdf5::archive & ar) const {
         ar["/parameters"] << parameters;
         ar["measurements"] << measurements;
         ar["checkpoint"] << random;
     }
 
-    void mcbase::load(alps::hdf5::archive & ar) {
+    template<typename Engine> void basic_mcbase<Engine>::load(alps::hdf5::archive & ar) {
         ar["/parameters"] >> parameters;
         ar["measurements"] >> measurements;
         ar["checkpoint"] >> random;
     }
 
+    template class basic_mcbase<boost::mt19937>;
+    template class basic_mcbase<xoshiro256pp>;
+    template class basic_mcbase<philox4x32>;
+
 }
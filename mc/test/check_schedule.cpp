@@ -6,6 +6,7 @@
 
 /* This is to test schedule checker */
 
+#include <chrono>
 #include <ctime>
 
 #include <alps/mc/check_schedule.hpp>
@@ -161,3 +162,18 @@ TEST(CheckSheduleTest, PosixTimerWrapper)
     EXPECT_NEAR(t1, alps::detail::posix_wall_clock::now_time(), 1) << "Timer wrapper counts time differently";
     EXPECT_EQ(delta, alps::detail::posix_wall_clock::time_diff(t1, t0)) << "Timer wrapper computes intervals differently";
 }
+
+/// Test that our steady clock wrapper has sub-second resolution
+TEST(CheckSheduleTest, SteadyClockWrapper)
+{
+    typedef alps::detail::steady_clock clock_type;
+    const clock_type::time_point_type t0=clock_type::now_time();
+    clock_type::time_point_type t1=t0;
+    while (std::chrono::steady_clock::now()-t0 < std::chrono::milliseconds(20)) {
+        t1=clock_type::now_time();
+    }
+    const clock_type::time_duration_type delta=clock_type::time_diff(t1, t0);
+    EXPECT_LT(0.01, delta) << "Steady clock wrapper is too coarse";
+    EXPECT_GT(1., delta) << "Steady clock wrapper counts time differently";
+    EXPECT_LE(0., clock_type::time_diff(clock_type::now_time(), t1)) << "Steady clock wrapper is not monotonic";
+}
@@ -47,7 +47,12 @@ TEST(CustomScheduler,Run) {
     sim_type sim(p, comm, my_schecker_type());
     sim.run(stop_callback);
 
-    EXPECT_EQ(sim_type::MAXCOUNT+0, sim.count());
+    if (comm.size()==1) {
+        EXPECT_EQ(sim_type::MAXCOUNT+0, sim.count());
+    } else {
+        // the ranks go on updating until the completion is known on all of them
+        EXPECT_LE(sim_type::MAXCOUNT+0, sim.count());
+    }
 }
 
 TEST(CustomScheduler,Params) {
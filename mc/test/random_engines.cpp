@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file random_engines.cpp
+    Test the random number engines and their checkpoints
+*/
+
+#include <sstream>
+#include <vector>
+
+#include <alps/mc/mcbase.hpp>
+#include <alps/mc/random01.hpp>
+#include <alps/mc/random_engines.hpp>
+
+#include <alps/testing/unique_file.hpp>
+
+#include <gtest/gtest.h>
+
+/// Known answers of Random123
+TEST(RandomEngines, philoxKnownAnswers) {
+    boost::uint32_t out[4];
+
+    const boost::uint32_t zero_ctr[4]={ 0, 0, 0, 0 }, zero_key[2]={ 0, 0 };
+    alps::philox4x32::block(zero_ctr, zero_key, out);
+    EXPECT_EQ(0x6627e8d5U, out[0]);
+    EXPECT_EQ(0xe169c58dU, out[1]);
+    EXPECT_EQ(0xbc57ac4cU, out[2]);
+    EXPECT_EQ(0x9b00dbd8U, out[3]);
+
+    const boost::uint32_t ones_ctr[4]={ ~0U, ~0U, ~0U, ~0U }, ones_key[2]={ ~0U, ~0U };
+    alps::philox4x32::block(ones_ctr, ones_key, out);
+    EXPECT_EQ(0x408f276dU, out[0]);
+    EXPECT_EQ(0x41c83b0eU, out[1]);
+    EXPECT_EQ(0xa20bc7c6U, out[2]);
+    EXPECT_EQ(0x6d5451fdU, out[3]);
+}
+
+/// Known answers of the reference implementation
+TEST(RandomEngines, xoshiroKnownAnswers) {
+    alps::xoshiro256pp eng;
+    eng.set_state(alps::xoshiro256pp::state_type{ 1, 2, 3, 4 });
+    EXPECT_EQ(41943041U, eng());
+    EXPECT_EQ(58720359U, eng());
+}
+
+/// Google Test Fixture: E is an engine type
+template <typename E>
+class RandomEngineTest : public ::testing::Test {
+  public:
+    typedef alps::basic_random01<E> random_type;
+};
+
+typedef ::testing::Types<boost::mt19937, alps::xoshiro256pp, alps::philox4x32> engine_types;
+
+TYPED_TEST_CASE(RandomEngineTest, engine_types);
+
+TYPED_TEST(RandomEngineTest, discard) {
+    for (std::size_t n=0; n<11; ++n) {
+        TypeParam eng1(7), eng2(7);
+        eng1();
+        eng2();
+        for (std::size_t i=0; i<n; ++i) eng1();
+        eng2.discard(n);
+        EXPECT_EQ(eng1(), eng2()) << "n=" << n;
+        EXPECT_TRUE(eng1==eng2) << "n=" << n;
+    }
+}
+
+TYPED_TEST(RandomEngineTest, fill) {
+    typename TestFixture::random_type rng1(5), rng2(5);
+    std::vector<double> buf(1001);
+    rng1.fill(&buf.front(), buf.size());
+    double sum=0;
+    for (std::size_t i=0; i<buf.size(); ++i) {
+        EXPECT_EQ(rng2(), buf[i]);
+        EXPECT_LE(0., buf[i]);
+        EXPECT_GT(1., buf[i]);
+        sum+=buf[i];
+    }
+    EXPECT_NEAR(0.5, sum/buf.size(), 0.05);
+}
+
+TYPED_TEST(RandomEngineTest, differentSeeds) {
+    typename TestFixture::random_type rng1(1), rng2(2);
+    EXPECT_NE(rng1(), rng2());
+}
+
+TYPED_TEST(RandomEngineTest, checkpoint) {
+    alps::testing::unique_file ufile("random_engines.h5.", alps::testing::unique_file::REMOVE_AFTER);
+    typename TestFixture::random_type rng(11);
+    for (int i=0; i<7; ++i) rng();
+    {
+        alps::hdf5::archive ar(ufile.name(), "w");
+        ar["/rng"] << rng;
+    }
+    const double expected=rng();
+
+    typename TestFixture::random_type restored(3);
+    {
+        alps::hdf5::archive ar(ufile.name(), "r");
+        ar["/rng"] >> restored;
+        EXPECT_TRUE(ar.is_data("/rng/state")) << "The state is saved as binary data";
+    }
+    EXPECT_EQ(expected, restored());
+    EXPECT_TRUE(rng.engine()==restored.engine());
+}
+
+/// Checkpoints of older versions store the Mersenne twister state as text
+TEST(RandomEngines, loadTextCheckpoint) {
+    alps::testing::unique_file ufile("random_engines.h5.", alps::testing::unique_file::REMOVE_AFTER);
+    alps::random01 rng(11);
+    for (int i=0; i<7; ++i) rng();
+    {
+        alps::hdf5::archive ar(ufile.name(), "w");
+        std::ostringstream os;
+        os << rng.engine();
+        ar["/rng/engine"] << os.str();
+    }
+    alps::random01 restored(3);
+    {
+        alps::hdf5::archive ar(ufile.name(), "r");
+        ar["/rng"] >> restored;
+    }
+    EXPECT_EQ(rng(), restored());
+}
+
+class philox_sim : public alps::basic_mcbase<alps::philox4x32> {
+  public:
+    philox_sim(parameters_type const & params, std::size_t seed_offset) : alps::basic_mcbase<alps::philox4x32>(params, seed_offset) {}
+    void update() {}
+    void measure() {}
+    double fraction_completed() const { return 1; }
+    double draw() { return random(); }
+};
+
+TEST(RandomEngines, mcbaseCheckpoint) {
+    alps::testing::unique_file ufile("random_engines.h5.", alps::testing::unique_file::REMOVE_AFTER);
+    alps::params p;
+    philox_sim::define_parameters(p);
+
+    philox_sim sim(p, 0), other_rank(p, 1);
+    EXPECT_NE(sim.draw(), other_rank.draw());
+    sim.save(ufile.name());
+    const double expected=sim.draw();
+
+    philox_sim restored(p, 1);
+    restored.load(ufile.name());
+    EXPECT_EQ(expected, restored.draw());
+}
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <alps/hdf5/archive.hpp>
 #include <alps/accumulators.hpp>
+#include <alps/accumulators/lazy_result_set.hpp>
 #include <alps/params.hpp>
 
 /**
@@ -40,15 +41,14 @@ int main(int argc, char** argv)
             // open the archive:
             alps::hdf5::archive ar(fnames[ip],"r");
 
-            // read the simulation result set:
-            aa::result_set results;
-            ar["/simulation/results"] >> results;
+            // open the simulation result set; the results are read only when accessed:
+            aa::lazy_result_set results(ar, "/simulation/results");
         
             // read the simulation parameters:
             alps::params p;
             ar["/parameters"] >> p;
 
-            // Extract the named results from the result set:
+            // Extract (and read) the named results from the result set:
             const aa::result_wrapper& mag4=results["Magnetization^4"];
             const aa::result_wrapper& mag2=results["Magnetization^2"];
 
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file inplace_functions.hpp
+    @brief In-place arithmetic on scalars and sequences that does not create temporaries
+*/
+
+#ifndef ALPS_NUMERIC_INPLACE_FUNCTIONS_HPP
+#define ALPS_NUMERIC_INPLACE_FUNCTIONS_HPP
+
+#include <alps/type_traits/is_sequence.hpp>
+#include <alps/utilities/stacktrace.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace alps {
+    namespace numeric {
+
+        /// Set a scalar to zero
+        template <typename T>
+        inline typename std::enable_if<!is_sequence<T>::value, void>::type
+        set_zero(T& x)
+        {
+            x=T();
+        }
+
+        /// Set all elements of a sequence to zero, keeping its size (and storage)
+        template <typename T>
+        inline typename std::enable_if<is_sequence<T>::value, void>::type
+        set_zero(T& a)
+        {
+            for (std::size_t i=0; i!=a.size(); ++i)
+                set_zero(a[i]);
+        }
+
+        /// Divide a scalar by `d`, in place
+        template <typename T, typename S>
+        inline typename std::enable_if<!is_sequence<T>::value, void>::type
+        divide_by(T& x, const S& d)
+        {
+            x/=d;
+        }
+
+        /// Divide all elements of a sequence by `d`, in place, without the temporary of `x / d`
+        template <typename T, typename S>
+        inline typename std::enable_if<is_sequence<T>::value, void>::type
+        divide_by(T& a, const S& d)
+        {
+            for (std::size_t i=0; i!=a.size(); ++i)
+                divide_by(a[i], d);
+        }
+
+        /// Add the square of a scalar: `sum += x*x`
+        template <typename T>
+        inline typename std::enable_if<!is_sequence<T>::value, void>::type
+        add_square(T& sum, const T& x)
+        {
+            sum+=x*x;
+        }
+
+        /// Element-wise `sum += x*x` for sequences, without the temporary of `sum += x*x`
+        /** @note Throws if the sizes of the sequences differ */
+        template <typename T>
+        inline typename std::enable_if<is_sequence<T>::value, void>::type
+        add_square(T& sum, const T& x)
+        {
+            if (sum.size()!=x.size())
+                throw std::runtime_error("Sequences have different sizes: left="+std::to_string(sum.size())
+                                         + " right="+std::to_string(x.size()) + ALPS_STACKTRACE);
+            for (std::size_t i=0; i!=sum.size(); ++i)
+                add_square(sum[i], x[i]);
+        }
+
+        namespace detail {
+            /// Blocks of at most this many terms are summed directly by `pairwise_sum()`
+            const std::size_t pairwise_block_size=32;
+
+            struct identity_term {
+                template <typename T> T operator()(const T& x) const { return x; }
+            };
+
+            struct square_term {
+                template <typename T> T operator()(const T& x) const { return x*x; }
+            };
+
+            /// Sum of `f(x[i])` by recursive pairwise summation: the rounding error grows as O(log n) rather than O(n)
+            template <typename T, typename F>
+            T pairwise_sum(const T* x, std::size_t n, F f)
+            {
+                if (n<=pairwise_block_size) {
+                    T s=T();
+                    for (std::size_t i=0; i!=n; ++i)
+                        s+=f(x[i]);
+                    return s;
+                }
+                const std::size_t half=n/2;
+                return pairwise_sum(x, half, f)+pairwise_sum(x+half, n-half, f);
+            }
+
+            /// Throw unless all `n` sequences in `x` have the size of `sum`
+            template <typename T>
+            void check_block_sizes(const T& sum, const T* x, std::size_t n)
+            {
+                for (std::size_t i=0; i!=n; ++i) {
+                    if (sum.size()!=x[i].size())
+                        throw std::runtime_error("Sequences have different sizes: left="+std::to_string(sum.size())
+                                                 + " right="+std::to_string(x[i].size()) + ALPS_STACKTRACE);
+                }
+            }
+        }
+
+        /// Add a block of `n` scalars: `sum += x[0]+...+x[n-1]`, summed pairwise
+        template <typename T>
+        inline typename std::enable_if<!is_sequence<T>::value, void>::type
+        add_sum(T& sum, const T* x, std::size_t n)
+        {
+            sum+=detail::pairwise_sum(x, n, detail::identity_term());
+        }
+
+        /// Element-wise `sum += x[0]+...+x[n-1]` for a block of `n` sequences, in place
+        /** @note Throws (leaving `sum` unchanged) if the sizes of the sequences differ */
+        template <typename T>
+        inline typename std::enable_if<is_sequence<T>::value, void>::type
+        add_sum(T& sum, const T* x, std::size_t n)
+        {
+            detail::check_block_sizes(sum, x, n);
+            for (std::size_t i=0; i!=n; ++i)
+                for (std::size_t j=0; j!=sum.size(); ++j)
+                    sum[j]+=x[i][j];
+        }
+
+        /// Add the squares of a block of `n` scalars: `sum += x[0]*x[0]+...+x[n-1]*x[n-1]`, summed pairwise
+        template <typename T>
+        inline typename std::enable_if<!is_sequence<T>::value, void>::type
+        add_sum_of_squares(T& sum, const T* x, std::size_t n)
+        {
+            sum+=detail::pairwise_sum(x, n, detail::square_term());
+        }
+
+        /// Element-wise `sum += x[0]*x[0]+...+x[n-1]*x[n-1]` for a block of `n` sequences, in place
+        /** @note Throws (leaving `sum` unchanged) if the sizes of the sequences differ */
+        template <typename T>
+        inline typename std::enable_if<is_sequence<T>::value, void>::type
+        add_sum_of_squares(T& sum, const T* x, std::size_t n)
+        {
+            detail::check_block_sizes(sum, x, n);
+            for (std::size_t i=0; i!=n; ++i)
+                for (std::size_t j=0; j!=sum.size(); ++j)
+                    sum[j]+=x[i][j]*x[i][j];
+        }
+
+        /// Replace `x[i]`, `i < n/factor`, by the average of the block `x[factor*i], ..., x[factor*i+factor-1]`, in place
+        /** The elements `x[n/factor]` and beyond are left unchanged. */
+        template <typename T>
+        inline typename std::enable_if<!is_sequence<T>::value, void>::type
+        average_blocks(T* x, std::size_t n, std::size_t factor)
+        {
+            const T factor_vt=factor;
+            for (std::size_t i=0; i!=n/factor; ++i) {
+                T s=x[factor*i];
+                for (std::size_t j=1; j!=factor; ++j)
+                    s+=x[factor*i+j];
+                // the block of x[i] has been averaged already
+                x[i]=s/factor_vt;
+            }
+        }
+
+        /// Element-wise block averages of sequences, in place: the storage of the sequences is reused
+        /** @note Throws (leaving `x` unchanged) if the sizes of the sequences in the blocks differ */
+        template <typename T>
+        inline typename std::enable_if<is_sequence<T>::value, void>::type
+        average_blocks(T* x, std::size_t n, std::size_t factor)
+        {
+            typedef typename T::value_type value_type;
+            const std::size_t nblocks=n/factor;
+            if (nblocks==0) return;
+            detail::check_block_sizes(x[0], x, nblocks*factor);
+            const value_type factor_vt=factor;
+            for (std::size_t i=0; i!=nblocks; ++i) {
+                for (std::size_t k=0; k!=x[i].size(); ++k) {
+                    value_type s=x[factor*i][k];
+                    for (std::size_t j=1; j!=factor; ++j)
+                        s+=x[factor*i+j][k];
+                    x[i][k]=s/factor_vt;
+                }
+            }
+        }
+
+    }
+}
+
+#endif // ALPS_NUMERIC_INPLACE_FUNCTIONS_HPP
@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPSCORE_GF_TENSOR_ALLOCATORS_H
+#define ALPSCORE_GF_TENSOR_ALLOCATORS_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace alps {
+  namespace numerics {
+    namespace detail {
+
+      /**
+       * Allocate `bytes` bytes aligned to `alignment` bytes (a power of two, at least sizeof(void*))
+       */
+      inline void *aligned_malloc(size_t bytes, size_t alignment) {
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, alignment, bytes == 0 ? alignment : bytes) != 0) {
+          throw std::bad_alloc();
+        }
+        return ptr;
+      }
+
+      /**
+       * @brief Thread-local cache of memory blocks
+       *
+       * Freed blocks are kept by size and reused for the next allocation of the same size on the
+       * same thread, so that short-lived temporaries of the same shape, e.g. in a loop over frequencies,
+       * do not go through the heap. At most `max_bytes` are kept in the cache.
+       */
+      class block_pool {
+      public:
+        /// alignment of all blocks
+        static constexpr size_t alignment = 64;
+        /// maximal total size of cached blocks
+        static constexpr size_t max_bytes = size_t(64) << 20;
+
+        block_pool() : bytes_(0) {}
+
+        ~block_pool() {
+          for (auto &blocks : blocks_) {
+            for (void *ptr : blocks.second) {
+              std::free(ptr);
+            }
+          }
+          destroyed() = true;
+        }
+
+        /// get a block of given size, from the cache if possible
+        void *get(size_t bytes) {
+          auto it = blocks_.find(bytes);
+          if (it == blocks_.end() || it->second.empty()) {
+            return aligned_malloc(bytes, alignment);
+          }
+          void *ptr = it->second.back();
+          it->second.pop_back();
+          bytes_ -= bytes;
+          return ptr;
+        }
+
+        /// return a block to the cache, or free it if the cache is full
+        void put(void *ptr, size_t bytes) {
+          if (bytes_ + bytes > max_bytes) {
+            std::free(ptr);
+            return;
+          }
+          blocks_[bytes].push_back(ptr);
+          bytes_ += bytes;
+        }
+
+        /// pool of the current thread, or nullptr if it has been destroyed already on thread exit
+        static block_pool *local() {
+          if (destroyed()) {
+            return nullptr;
+          }
+          static thread_local block_pool pool;
+          return &pool;
+        }
+
+      private:
+        /// set when the pool of the current thread is destroyed
+        static bool &destroyed() {
+          static thread_local bool flag = false;
+          return flag;
+        }
+
+        std::map<size_t, std::vector<void *> > blocks_;
+        size_t bytes_;
+      };
+
+      /// Alignment (in bytes) guaranteed by an allocator, 0 if unknown
+      template<typename A>
+      struct allocator_alignment {
+        static constexpr size_t value = 0;
+      };
+    }
+
+    /**
+     * @brief Allocator of memory aligned to `Alignment` bytes
+     *
+     * With the default alignment of 64 bytes (a cache line), the data are suitably aligned for
+     * any SIMD instruction set, and Eigen maps of whole tensors use aligned loads.
+     */
+    template<typename T, size_t Alignment = 64>
+    class aligned_allocator {
+    public:
+      typedef T value_type;
+      static constexpr size_t alignment = Alignment;
+
+      template<typename U>
+      struct rebind {
+        typedef aligned_allocator<U, Alignment> other;
+      };
+
+      aligned_allocator() = default;
+      template<typename U>
+      aligned_allocator(const aligned_allocator<U, Alignment> &) {}
+
+      T *allocate(size_t n) {
+        return static_cast<T *>(detail::aligned_malloc(n * sizeof(T), Alignment));
+      }
+
+      void deallocate(T *ptr, size_t) {
+        std::free(ptr);
+      }
+
+      template<typename U>
+      bool operator==(const aligned_allocator<U, Alignment> &) const { return true; }
+      template<typename U>
+      bool operator!=(const aligned_allocator<U, Alignment> &) const { return false; }
+    };
+
+    /**
+     * @brief Allocator for large arrays, e.g. Green's functions on large meshes
+     *
+     * Arrays of at least `huge_page_size` bytes are aligned to huge pages, and the kernel is advised
+     * to back them with (transparent) huge pages, which reduces TLB misses on strided access.
+     * Smaller arrays are aligned to 64 bytes.
+     */
+    template<typename T>
+    class huge_page_allocator {
+    public:
+      typedef T value_type;
+      static constexpr size_t alignment = 64;
+      /// size of a huge page (2 MiB on x86-64)
+      static constexpr size_t huge_page_size = size_t(2) << 20;
+
+      template<typename U>
+      struct rebind {
+        typedef huge_page_allocator<U> other;
+      };
+
+      huge_page_allocator() = default;
+      template<typename U>
+      huge_page_allocator(const huge_page_allocator<U> &) {}
+
+      T *allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (bytes < huge_page_size) {
+          return static_cast<T *>(detail::aligned_malloc(bytes, alignment));
+        }
+        bytes = (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+        void *ptr = detail::aligned_malloc(bytes, huge_page_size);
+#ifdef MADV_HUGEPAGE
+        // only a hint: the data are valid even if there are no huge pages available
+        madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+        return static_cast<T *>(ptr);
+      }
+
+      void deallocate(T *ptr, size_t) {
+        std::free(ptr);
+      }
+
+      template<typename U>
+      bool operator==(const huge_page_allocator<U> &) const { return true; }
+      template<typename U>
+      bool operator!=(const huge_page_allocator<U> &) const { return false; }
+    };
+
+    /**
+     * @brief Allocator of 64-byte aligned memory from a thread-local pool
+     *
+     * Memory is recycled by `detail::block_pool`, which makes allocation of temporaries of recurring
+     * sizes cheap. Memory may be freed by a thread other than the allocating one, in which case it
+     * goes to the pool of the freeing thread.
+     */
+    template<typename T>
+    class pool_allocator {
+    public:
+      typedef T value_type;
+      static constexpr size_t alignment = detail::block_pool::alignment;
+
+      template<typename U>
+      struct rebind {
+        typedef pool_allocator<U> other;
+      };
+
+      pool_allocator() = default;
+      template<typename U>
+      pool_allocator(const pool_allocator<U> &) {}
+
+      T *allocate(size_t n) {
+        detail::block_pool *pool = detail::block_pool::local();
+        if (pool == nullptr) {
+          return static_cast<T *>(detail::aligned_malloc(n * sizeof(T), alignment));
+        }
+        return static_cast<T *>(pool->get(n * sizeof(T)));
+      }
+
+      void deallocate(T *ptr, size_t n) {
+        detail::block_pool *pool = detail::block_pool::local();
+        if (pool == nullptr) {
+          std::free(ptr);
+          return;
+        }
+        pool->put(ptr, n * sizeof(T));
+      }
+
+      template<typename U>
+      bool operator==(const pool_allocator<U> &) const { return true; }
+      template<typename U>
+      bool operator!=(const pool_allocator<U> &) const { return false; }
+    };
+
+    namespace detail {
+      template<typename T, size_t Alignment>
+      struct allocator_alignment<aligned_allocator<T, Alignment> > {
+        static constexpr size_t value = Alignment;
+      };
+
+      template<typename T>
+      struct allocator_alignment<huge_page_allocator<T> > {
+        static constexpr size_t value = huge_page_allocator<T>::alignment;
+      };
+
+      template<typename T>
+      struct allocator_alignment<pool_allocator<T> > {
+        static constexpr size_t value = pool_allocator<T>::alignment;
+      };
+    }
+  }
+}
+
+#endif //ALPSCORE_GF_TENSOR_ALLOCATORS_H
@@ -7,8 +7,11 @@
 #ifndef ALPSCORE_GF_TENSORBASE_H
 #define ALPSCORE_GF_TENSORBASE_H
 
+#include <type_traits>
 #include <vector>
 
+#include <alps/numeric/tensors/allocators.hpp>
+
 namespace alps {
   namespace numerics {
     namespace detail {
@@ -21,7 +24,8 @@ namespace alps {
        * @brief Internal data storage class for tensors
        *
        * @tparam T  the scalar type
-       * @tparam Cont  abstraction of the data storage (default vector)
+       * @tparam Cont  abstraction of the data storage (default vector), e.g. a vector with
+       *               one of the allocators of allocators.hpp
        */
       template<typename T, typename Cont = std::vector<typename std::remove_const<T>::type> >
       class data_storage {
@@ -133,6 +137,24 @@ namespace alps {
           return r == *this;
         }
       };
+
+      /// Check if the type is a data storage (of any container)
+      template<typename St>
+      struct is_data_storage : std::false_type {};
+
+      template<typename T, typename Cont>
+      struct is_data_storage<data_storage<T, Cont> > : std::true_type {};
+
+      /// Alignment of the data of a storage in bytes, 0 if unknown
+      template<typename St>
+      struct storage_alignment {
+        static constexpr size_t value = 0;
+      };
+
+      template<typename T, typename V, typename A>
+      struct storage_alignment<data_storage<T, std::vector<V, A> > > {
+        static constexpr size_t value = allocator_alignment<A>::value;
+      };
     }
     template<typename T>
     using simple_storage = detail::data_storage<T, std::vector<T> >;
@@ -32,12 +32,15 @@ namespace alps {
         size_t size_;
       public:
         /// Construct view of the whole DataStorage
-        data_view(data_storage<T> & storage) : data_slice_(storage), size_(storage.size()) {}
-        data_view(const data_storage<T> & storage) : data_slice_(storage.data(), storage.size()), size_(storage.size()) {}
-        template<typename S>
-        data_view(const data_storage<S> & storage, size_t size, size_t offset = 0) : data_slice_(storage.data() + offset, size), size_(size) {}
+        template<typename C>
+        data_view(data_storage<T, C> & storage) : data_slice_(storage), size_(storage.size()) {}
+        template<typename C>
+        data_view(const data_storage<T, C> & storage) : data_slice_(storage.data(), storage.size()), size_(storage.size()) {}
+        template<typename S, typename C>
+        data_view(const data_storage<S, C> & storage, size_t size, size_t offset = 0) : data_slice_(storage.data() + offset, size), size_(size) {}
         /// Construct subview of specified size for DataStorage starting from offset point
-        data_view(data_storage<T> & storage, size_t size, size_t offset = 0) : data_slice_(storage.data() + offset, size), size_(size) {}
+        template<typename C>
+        data_view(data_storage<T, C> & storage, size_t size, size_t offset = 0) : data_slice_(storage.data() + offset, size), size_(size) {}
         /// Move-construction of subview of specified size for another View starting from offset point
         data_view(data_view<T> && storage, size_t size, size_t offset) : data_slice_(storage.data_slice_.data() + offset, size), size_(size) {}
         /// Copy-construction of subview of specified size for another View starting from offset point
@@ -83,8 +86,8 @@ namespace alps {
         }
 
         /// Comparison against DataStorage
-        template<typename T2>
-        bool operator==(const data_storage<T2>& r) const {
+        template<typename T2, typename C2>
+        bool operator==(const data_storage<T2, C2>& r) const {
           return size() == r.size() && std::equal(r.data(), r.data() + r.size(), data());
         }
       };
@@ -20,6 +20,7 @@
 #include <alps/type_traits/index_sequence.hpp>
 #include <alps/type_traits/are_all_integrals.hpp>
 #include <alps/numeric/tensors/data_view.hpp>
+#include <alps/numeric/tensors/tensor_expression.hpp>
 
 
 namespace alps {
@@ -32,7 +33,7 @@ namespace alps {
        */
       template<typename T, typename St>
       struct is_storage {
-        static constexpr bool value = std::is_same < St, simple_storage < T > > ::value ||
+        static constexpr bool value = is_data_storage < St > ::value ||
             std::is_same < St, data_view < T > > ::value;
       };
 
@@ -57,9 +58,16 @@ namespace alps {
     }
       /**
        * Definition of Tensor with storage
+       *
+       * @tparam Alloc - allocator of the data, e.g. aligned_allocator, huge_page_allocator or pool_allocator
+       */
+      template<typename T, size_t D, typename Alloc = std::allocator<typename std::remove_const<T>::type> >
+      using tensor = detail::tensor_base < T, D, detail::data_storage < T, std::vector<typename std::remove_const<T>::type, Alloc> > >;
+      /**
+       * Definition of Tensor with storage aligned to 64 bytes
        */
       template<typename T, size_t D>
-      using tensor = detail::tensor_base < T, D, detail::data_storage < T > >;
+      using aligned_tensor = tensor < T, D, aligned_allocator<typename std::remove_const<T>::type> >;
 #ifdef ALPS_HAVE_SHARED_ALLOCATOR
       /**
        * Definition of Tensor with mpi3 shared storage
@@ -74,10 +82,33 @@ namespace alps {
       using tensor_view = detail::tensor_base < T, D, detail::data_view < T > >;
 
     namespace detail {
-      template<typename X, int Rows = Eigen::Dynamic, int Cols = Eigen::Dynamic>
-      using MatrixMap =  Eigen::Map < Eigen::Matrix < X, Rows, Cols, Eigen::RowMajor > >;
-      template<typename X, int Rows = Eigen::Dynamic, int Cols = Eigen::Dynamic>
-      using ConstMatrixMap =  Eigen::Map <const Eigen::Matrix < X, Rows, Cols, Eigen::RowMajor > >;
+      template<typename X, int Rows = Eigen::Dynamic, int Cols = Eigen::Dynamic, int Options = Eigen::Unaligned>
+      using MatrixMap =  Eigen::Map < Eigen::Matrix < X, Rows, Cols, Eigen::RowMajor >, Options >;
+      template<typename X, int Rows = Eigen::Dynamic, int Cols = Eigen::Dynamic, int Options = Eigen::Unaligned>
+      using ConstMatrixMap =  Eigen::Map <const Eigen::Matrix < X, Rows, Cols, Eigen::RowMajor >, Options >;
+
+      /**
+       * Tensor type which owns its data, for the given tensor type: the tensor itself if it has a storage,
+       * or the tensor with default storage for a view
+       */
+      template<typename Tensor>
+      struct storage_tensor;
+
+      template<typename T, size_t D, typename C>
+      struct storage_tensor<tensor_base<T, D, C> > {
+        typedef typename std::conditional<is_data_storage<C>::value, tensor_base<T, D, C>,
+                                          tensor<typename std::remove_const<T>::type, D> >::type type;
+      };
+
+      /**
+       * Option of Eigen maps for data aligned to the given number of bytes
+       */
+      template<size_t Alignment>
+      struct eigen_alignment {
+        static constexpr int value = Alignment >= 64 ? int(Eigen::Aligned64) :
+                                     Alignment >= 32 ? int(Eigen::Aligned32) :
+                                     Alignment >= 16 ? int(Eigen::Aligned16) : int(Eigen::Unaligned);
+      };
 
       /**
        * @brief Tensor class for raw data storage and performing the basic arithmetic operations
@@ -89,6 +120,8 @@ namespace alps {
       public:
         // types definitions
         typedef T prec;
+        /// alignment of Eigen maps of the whole data, which is known for aligned storages only
+        static constexpr int map_alignment = eigen_alignment < storage_alignment < Container >::value >::value;
       private:
         typedef data_view < T > viewType;
         typedef data_view < const typename std::remove_const<T>::type > constViewType;
@@ -179,21 +212,21 @@ namespace alps {
          * @param sizes - array of data dimensions
          */
         template<typename X = Container>
-        tensor_base(typename std::enable_if < std::is_same < X, data_storage < T > >::value,
+        tensor_base(typename std::enable_if < is_data_storage < X >::value,
                         const std::array < size_t, Dim > & >::type sizes) : storage_(size(sizes)), shape_(sizes) {
           fill_acc_sizes();
         }
 
         template<typename X = Container, typename...Indices>
-        tensor_base(typename std::enable_if < std::is_same < X, data_storage < T > >::value,
+        tensor_base(typename std::enable_if < is_data_storage < X >::value,
           size_t>::type size1, Indices...sizes) : storage_(size({{size1, size_t(sizes)...}})), shape_({{size1, size_t(sizes)...}}) {
           static_assert(sizeof...(Indices) + 1 == Dim, "Wrong dimension");
           fill_acc_sizes();
         }
 
         // this constructor create a view of other tensor. that is why rhs is not const
-        template<typename St = Container>
-        tensor_base(typename std::enable_if<std::is_same<St, viewType>::value, tensorType>::type& rhs) :
+        template<typename C, typename St = Container, typename = typename std::enable_if<std::is_same<St, viewType>::value>::type>
+        tensor_base(tensor_base < T, Dim, data_storage < T, C > > & rhs) :
           storage_(rhs.storage()), shape_(rhs.shape()), acc_sizes_(rhs.acc_sizes()) {}
 
         /// copy constructor
@@ -207,6 +240,19 @@ namespace alps {
         template<typename T2, typename St, typename = std::enable_if<std::is_same<Container, storageType>::value, void >>
         tensor_base(tensor_base<T2, Dim, St> &&rhs) noexcept: storage_(rhs.storage()), shape_(rhs.shape()), acc_sizes_(rhs.acc_sizes()) {}
 
+        /**
+         * Create tensor from the expression, which is evaluated in a single pass
+         *
+         * @tparam E - type of the expression
+         * @param expr - tensor expression
+         */
+        template<typename E, typename X = Container, typename = typename std::enable_if<is_data_storage<X>::value>::type>
+        tensor_base(const tensor_expression<E> &expr) : storage_(expr.derived().size()), shape_(expr.derived().shape()) {
+          static_assert(E::dim == Dim, "Expression should have the same dimension.");
+          fill_acc_sizes();
+          evaluate(expr.derived());
+        }
+
         template<typename St=Container>
         void set_ref(typename std::enable_if<std::is_same<St, data_view<T>>::value, T >::type * const&new_ref) {
           storage_.set_ref(new_ref);
@@ -256,6 +302,18 @@ namespace alps {
           return *this;
         }
 
+        /**
+         * Assign the expression. The tensor view should have the same size as the expression.
+         * The expression is evaluated element-wise, so the tensor itself may appear in the expression.
+         */
+        template<typename E>
+        tType &operator=(const tensor_expression<E> &expr) {
+          static_assert(E::dim == Dim, "Expression should have the same dimension.");
+          reshape(expr.derived().shape());
+          evaluate(expr.derived());
+          return *this;
+        }
+
         /// compare tensors
         template<typename T2, typename St>
         bool operator==(const tensor_base<T2, Dim, St>& rhs) const {
@@ -311,44 +369,16 @@ namespace alps {
         }
 
         /*
-         * Basic arithmetic operations
-         */
-        /**
-         * Multiplication by scalar. This method checks the resulting type of Tensor based on the scalar type and tensor type.
-         *
-         * @tparam S     - type of scalar multiplier
-         * @param scalar - scalar factor
-         * @return New tensor equal to the current tensor multiplied by scalar
-         */
-        template<typename S>
-        typename std::enable_if < !std::is_same < S, tensorType >::value, tensor_base< decltype(S{} * T{}), Dim,
-            data_storage< decltype(S{} * T{}) > > >::type operator*(S scalar) const {
-          tensor_base< decltype(S{} * T{}), Dim, data_storage< decltype(S{} * T{}) > > x(*this);
-          return (x *= static_cast<decltype(S{} * T{})>(scalar));
-        }
-
-        /**
-         * Two tensors multiplication. We need to decide whether it should be element-wise or more sofisticated tensor contraction.
-         *
-         * @tparam S     - type of the right hand side tensor
-         * @param rhs - right hand side tensor
-         * @return result of two tensor multiplication
+         * Basic arithmetic operations. Out-of-place operations return tensor expressions,
+         * see tensor_expression.hpp.
          */
-        template<typename S, typename Ct>
-        typename std::enable_if<
-          std::is_convertible<S, T>::value || std::is_convertible<T, S>::value,
-          tensor < typename std::conditional< std::is_convertible<T, S>::value, S, T>::type, Dim > >::type operator*(const tensor_base < S, Dim, Ct > &rhs) const {
-          tensor < typename std::conditional< std::is_convertible<T, S>::value, S, T>::type, Dim > x(*this);
-          return (x *= rhs);
-        }
-
         /**
          * Inplace tensor scaling
          */
         template<typename S>
         typename std::enable_if < !std::is_same < S, tensorType >::value, tType & >::type operator*=(S scalar) {
           static_assert(std::is_convertible<S, T>::value, "Can't perform inplace multiplication: S can be casted into T");
-          Eigen::Map < Eigen::Matrix < T, 1, Eigen::Dynamic > > M(&storage_.data(0), storage_.size());
+          Eigen::Map < Eigen::Matrix < T, 1, Eigen::Dynamic >, map_alignment > M(&storage_.data(0), storage_.size());
           M *= T(scalar);
           return *this;
         }
@@ -358,40 +388,24 @@ namespace alps {
          */
         template<typename S, typename Ct>
         typename std::enable_if < std::is_convertible < S, T >::value, tType & >::type operator*=(const tensor_base < S, Dim, Ct > &rhs) {
-          Eigen::Map < Eigen::Array < T, 1, Eigen::Dynamic > > M1(&storage_.data(0), storage_.size());
-          Eigen::Map < const Eigen::Array < S, 1, Eigen::Dynamic > > M2(&rhs.storage().data(0), rhs.storage().size());
+          Eigen::Map < Eigen::Array < T, 1, Eigen::Dynamic >, map_alignment > M1(&storage_.data(0), storage_.size());
+          Eigen::Map < const Eigen::Array < S, 1, Eigen::Dynamic >, tensor_base < S, Dim, Ct >::map_alignment >
+              M2(&rhs.storage().data(0), rhs.storage().size());
           M1*=M2;
           return *this;
         }
 
-        /**
-         * Tensor inversed scaling
-         */
-        template<typename S>
-        typename std::enable_if < !std::is_same < S, tensorType >::value, tensor_base< decltype(S{} + T{}), Dim,
-            data_storage< decltype(S{} * T{}) > > >::type operator/(S scalar) const {
-          tensor_base< decltype(S{} + T{}), Dim, data_storage< decltype(S{} * T{}) > >  x(*this);
-          return (x /= scalar);
-        }
-
         /**
          * Inplace division
          */
         template<typename S>
         typename std::enable_if < !std::is_same < S, tensorType >::value, tType & >::type operator/=(S scalar) {
           static_assert(std::is_convertible<S, T>::value, "Can not perform inplace division: S can be casted into T");
-          Eigen::Map < Eigen::Matrix < T, 1, Eigen::Dynamic > > M(&storage_.data(0), storage_.size());
+          Eigen::Map < Eigen::Matrix < T, 1, Eigen::Dynamic >, map_alignment > M(&storage_.data(0), storage_.size());
           M *= T(1.0)/T(scalar);
           return *this;
         }
 
-        /**
-         * Negate tensor
-         */
-        tensor_base < T, Dim, Container > operator-() const {
-          return tensor_base < T, Dim, Container >(*this) *= T(-1.0);
-        }
-
         /**
          * Set data to 0
          */
@@ -441,29 +455,6 @@ namespace alps {
           return x;
         }
 
-        /**
-         * Compute sum of two tensors
-         *
-         * @tparam S  - data type of rhs tensor
-         * @tparam Ct - storage type of rhs tensor
-         * @param  rhs  - rhs tensor
-         * @return new tensor object that equals to sum of current tensor and rhs tensor
-         */
-        template<typename S, typename Ct>
-        tensor < decltype(S{} + T{}), Dim > operator+(const tensor_base < S, Dim, Ct > &rhs) const {
-          tensor < decltype(S{} + T{}), Dim > x(*this);
-          return (x += rhs);
-        }
-
-        /**
-         * Compute difference of two tensors of a same type
-         */
-        template<typename S, typename Ct>
-        tensor < decltype(S{} - T{}), Dim > operator-(const tensor_base < S, Dim, Ct > &rhs) const {
-          tensor < decltype(S{} - T{}), Dim > x(*this);
-          return (x -= rhs);
-        }
-
         /**
          * Inplace addition
          */
@@ -471,8 +462,8 @@ namespace alps {
         typename std::enable_if <
           std::is_same < S, T >::value || std::is_same < T, std::complex < double>>::value
           || std::is_same < T, std::complex < float>>::value, tType & >::type operator+=(const tensor_base < S, Dim, Ct > &y) {
-          MatrixMap < T, 1, Eigen::Dynamic > M1(&storage_.data(0), storage_.size());
-          ConstMatrixMap < S, 1, Eigen::Dynamic > M2(&y.storage().data(0), y.storage().size());
+          MatrixMap < T, 1, Eigen::Dynamic, map_alignment > M1(&storage_.data(0), storage_.size());
+          ConstMatrixMap < S, 1, Eigen::Dynamic, tensor_base < S, Dim, Ct >::map_alignment > M2(&y.storage().data(0), y.storage().size());
           M1.noalias() += M2;
           return (*this);
         }
@@ -480,15 +471,40 @@ namespace alps {
         /**
          * Inplace subtraction
          */
-        template<typename S>
-        typename std::enable_if < std::is_same < S, tensorType >::value ||
-            std::is_same < S, tensorViewType >::value, tType & >::type operator-=(const S &y) {
-          MatrixMap < T, 1, Eigen::Dynamic > M1(&storage_.data(0), storage_.size());
-          ConstMatrixMap < T, 1, Eigen::Dynamic> M2(&y.storage().data(0), y.storage().size());
+        template<typename Ct>
+        tType & operator-=(const tensor_base < T, Dim, Ct > &y) {
+          MatrixMap < T, 1, Eigen::Dynamic, map_alignment > M1(&storage_.data(0), storage_.size());
+          ConstMatrixMap < T, 1, Eigen::Dynamic, tensor_base < T, Dim, Ct >::map_alignment > M2(&y.storage().data(0), y.storage().size());
           M1.noalias() -= M2;
           return (*this);
         }
 
+        /**
+         * Inplace addition of the expression
+         */
+        template<typename E>
+        tType &operator+=(const tensor_expression<E> &expr) {
+          check_shape(expr.derived().shape());
+          T *d = data();
+          for (size_t i = 0; i < size(); ++i) {
+            d[i] += expr.derived()[i];
+          }
+          return *this;
+        }
+
+        /**
+         * Inplace subtraction of the expression
+         */
+        template<typename E>
+        tType &operator-=(const tensor_expression<E> &expr) {
+          check_shape(expr.derived().shape());
+          T *d = data();
+          for (size_t i = 0; i < size(); ++i) {
+            d[i] -= expr.derived()[i];
+          }
+          return *this;
+        }
+
         /**
          * Compute a dot product of two 2D tensors
          */
@@ -498,7 +514,7 @@ namespace alps {
             throw std::invalid_argument("Can not do multiplication. Dimensions missmatches.");
           }
           tensorType x({{shape_[0], y.shape_[1]}});
-          ConstMatrixMap < T, Eigen::Dynamic, Eigen::Dynamic > M1(&storage().data(0), shape_[0], shape_[1]);
+          ConstMatrixMap < T, Eigen::Dynamic, Eigen::Dynamic, map_alignment > M1(&storage().data(0), shape_[0], shape_[1]);
           ConstMatrixMap < T, Eigen::Dynamic, Eigen::Dynamic > M2(&y.storage().data(0), y.shape()[0], y.shape()[1]);
           MatrixMap < T > M3(&x.storage().data(0), x.shape()[0], x.shape()[1]);
           M3 = M1*M2;
@@ -508,60 +524,60 @@ namespace alps {
         /**
          * @return Eigen matrix representation for 2D Tensor
          */
-        MatrixMap < T > matrix() {
+        MatrixMap < T, Eigen::Dynamic, Eigen::Dynamic, map_alignment > matrix() {
           static_assert(Dim == 2, "Can not return Eigen matrix view for not 2D tensor.");
-          return MatrixMap < T >(&storage().data(0), shape_[0], shape_[1]);
+          return MatrixMap < T, Eigen::Dynamic, Eigen::Dynamic, map_alignment >(&storage().data(0), shape_[0], shape_[1]);
         }
 
-        ConstMatrixMap < T > matrix() const {
+        ConstMatrixMap < T, Eigen::Dynamic, Eigen::Dynamic, map_alignment > matrix() const {
           static_assert(Dim == 2, "Can not return Eigen matrix view for not 2D tensor.");
-          return ConstMatrixMap < T >(&storage().data(0), shape_[0], shape_[1]);
+          return ConstMatrixMap < T, Eigen::Dynamic, Eigen::Dynamic, map_alignment >(&storage().data(0), shape_[0], shape_[1]);
         }
 
         /**
          * @return Eigen vector representation for 1D Tensor
          */
-        MatrixMap < T, 1, Eigen::Dynamic > vector() {
+        MatrixMap < T, 1, Eigen::Dynamic, map_alignment > vector() {
           static_assert(Dim == 1, "Can not return Eigen vector view for not 1D tensor.");
-          return MatrixMap < T, 1, Eigen::Dynamic >(&storage().data(0), size());
+          return MatrixMap < T, 1, Eigen::Dynamic, map_alignment >(&storage().data(0), size());
         }
 
-        ConstMatrixMap < T, 1, Eigen::Dynamic > vector() const {
+        ConstMatrixMap < T, 1, Eigen::Dynamic, map_alignment > vector() const {
           static_assert(Dim == 1, "Can not return Eigen vector view for not 1D tensor.");
-          return ConstMatrixMap < T, 1, Eigen::Dynamic >(&storage().data(0), size());
+          return ConstMatrixMap < T, 1, Eigen::Dynamic, map_alignment >(&storage().data(0), size());
         }
 
-        Eigen::Map <Eigen::Matrix < T, Eigen::Dynamic, 1, Eigen::ColMajor > > cvector() {
+        Eigen::Map <Eigen::Matrix < T, Eigen::Dynamic, 1, Eigen::ColMajor >, map_alignment > cvector() {
           static_assert(Dim == 1, "Can not return Eigen vector view for not 1D tensor.");
-          return Eigen::Map <Eigen::Matrix < T, Eigen::Dynamic, 1, Eigen::ColMajor > >(&storage().data(0), size());
+          return Eigen::Map <Eigen::Matrix < T, Eigen::Dynamic, 1, Eigen::ColMajor >, map_alignment >(&storage().data(0), size());
         }
 
-        Eigen::Map <const Eigen::Matrix < T, Eigen::Dynamic, 1, Eigen::ColMajor > > cvector() const {
+        Eigen::Map <const Eigen::Matrix < T, Eigen::Dynamic, 1, Eigen::ColMajor >, map_alignment > cvector() const {
           static_assert(Dim == 1, "Can not return Eigen vector view for not 1D tensor.");
-          return Eigen::Map <const Eigen::Matrix < T, Eigen::Dynamic, 1, Eigen::ColMajor > >(&storage().data(0), size());
+          return Eigen::Map <const Eigen::Matrix < T, Eigen::Dynamic, 1, Eigen::ColMajor >, map_alignment >(&storage().data(0), size());
         }
 
         /**
          * @return Eigen array representation for 1D and 2D Tensor
          */
         template<size_t M = Dim>
-        typename std::enable_if< M == 1, Eigen::Map < Eigen::Array < T, 1, Eigen::Dynamic > > >::type array() {
-           return Eigen::Map < Eigen::Array < T, 1, Eigen::Dynamic > >(&storage().data(0), size());
+        typename std::enable_if< M == 1, Eigen::Map < Eigen::Array < T, 1, Eigen::Dynamic >, map_alignment > >::type array() {
+           return Eigen::Map < Eigen::Array < T, 1, Eigen::Dynamic >, map_alignment >(&storage().data(0), size());
         }
 
         template<size_t M = Dim>
-        typename std::enable_if< M == 1, Eigen::Map < const Eigen::Array < T, 1, Eigen::Dynamic > > >::type array() const {
-          return Eigen::Map < const Eigen::Array < T, 1, Eigen::Dynamic > >(&storage().data(0), size());
+        typename std::enable_if< M == 1, Eigen::Map < const Eigen::Array < T, 1, Eigen::Dynamic >, map_alignment > >::type array() const {
+          return Eigen::Map < const Eigen::Array < T, 1, Eigen::Dynamic >, map_alignment >(&storage().data(0), size());
         }
 
         template<size_t M = Dim>
-        typename std::enable_if< M == 2, Eigen::Map < Eigen::Array < T, Eigen::Dynamic, Eigen::Dynamic > > >::type array() {
-          return Eigen::Map < Eigen::Array < T, Eigen::Dynamic, Eigen::Dynamic > >(&storage().data(0), shape_[0], shape_[1]);
+        typename std::enable_if< M == 2, Eigen::Map < Eigen::Array < T, Eigen::Dynamic, Eigen::Dynamic >, map_alignment > >::type array() {
+          return Eigen::Map < Eigen::Array < T, Eigen::Dynamic, Eigen::Dynamic >, map_alignment >(&storage().data(0), shape_[0], shape_[1]);
         }
 
         template<size_t M = Dim>
-        typename std::enable_if< M == 2, Eigen::Map < const Eigen::Array < T, Eigen::Dynamic, Eigen::Dynamic > > >::type array() const {
-          return Eigen::Map < const Eigen::Array < T, Eigen::Dynamic, Eigen::Dynamic > >(&storage().data(0), shape_[0], shape_[1]);
+        typename std::enable_if< M == 2, Eigen::Map < const Eigen::Array < T, Eigen::Dynamic, Eigen::Dynamic >, map_alignment > >::type array() const {
+          return Eigen::Map < const Eigen::Array < T, Eigen::Dynamic, Eigen::Dynamic >, map_alignment >(&storage().data(0), shape_[0], shape_[1]);
         }
 
         /// sizes for each dimension
@@ -577,7 +593,7 @@ namespace alps {
 
         /// reshape tensor object
         template<typename X = Container>
-        typename std::enable_if<std::is_same < X, data_storage < T > >::value, void>::type reshape(const std::array<size_t, Dim>& shape) {
+        typename std::enable_if<is_data_storage < X >::value, void>::type reshape(const std::array<size_t, Dim>& shape) {
           size_t new_size = size(shape);
           storage_.resize(new_size);
           shape_ = shape;
@@ -620,6 +636,20 @@ namespace alps {
         }
 
       private:
+        /// evaluate the expression into the data buffer of the same size
+        template<typename E>
+        void evaluate(const E &expr) {
+          T *d = data();
+          for (size_t i = 0; i < size(); ++i) {
+            d[i] = expr[i];
+          }
+        }
+        /// check that the shape of the rhs matches
+        void check_shape(const std::array < size_t, Dim > &shape) const {
+          if (shape != shape_) {
+            throw std::invalid_argument("Can not combine tensors. Shapes missmatch.");
+          }
+        }
         /**
          * Internal implementation of indexing
          */
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPSCORE_GF_TENSOR_EXPRESSION_H
+#define ALPSCORE_GF_TENSOR_EXPRESSION_H
+
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+#include <alps/type_traits/is_complex.hpp>
+
+namespace alps {
+  namespace numerics {
+    namespace detail {
+
+      template<typename T, size_t D, typename C>
+      class tensor_base;
+
+      /**
+       * @brief Base class for lazily evaluated element-wise tensor expressions
+       *
+       * Arithmetic operations on tensors do not compute anything, but return expressions which
+       * refer to the tensors involved. An expression is evaluated in a single loop, without
+       * temporary tensors, when it is assigned to a tensor (or tensor view), added to one, or
+       * used to construct one:
+       *
+       *     tensor<std::complex<double>, 2> f = c1/iwn + c2/iwnsq + c3/(iwn*iwnsq);
+       *
+       * As for Eigen expressions, an expression must not outlive the tensors it refers to,
+       * so `auto` should not be used to keep it.
+       *
+       * @tparam E - type of the derived expression
+       */
+      template<typename E>
+      struct tensor_expression {
+        const E &derived() const { return static_cast<const E &>(*this); }
+      };
+
+      /**
+       * Value type of an expression combining values of type A and B.
+       * Arithmetic types are promoted as usual, otherwise the type the other one converts into is used.
+       */
+      template<typename A, typename B, typename = void>
+      struct tensor_promote {
+        typedef typename std::conditional<std::is_convertible<A, B>::value, B, A>::type type;
+      };
+
+      template<typename A, typename B>
+      struct tensor_promote<A, B, typename std::enable_if<std::is_arithmetic<A>::value && std::is_arithmetic<B>::value>::type> {
+        typedef decltype(A() + B()) type;
+      };
+
+      /**
+       * Reference to the data of a tensor in an expression
+       */
+      template<typename T, size_t Dim>
+      class tensor_ref_expression : public tensor_expression<tensor_ref_expression<T, Dim> > {
+      public:
+        typedef typename std::remove_const<T>::type value_type;
+        static constexpr size_t dim = Dim;
+
+        template<typename C>
+        explicit tensor_ref_expression(const tensor_base<T, Dim, C> &t) : data_(t.data()), shape_(t.shape()), size_(t.size()) {}
+
+        const std::array<size_t, Dim> &shape() const { return shape_; }
+        size_t size() const { return size_; }
+        value_type operator[](size_t i) const { return data_[i]; }
+
+      private:
+        const value_type *data_;
+        std::array<size_t, Dim> shape_;
+        size_t size_;
+      };
+
+      /**
+       * Element-wise operation on two expressions of the same shape
+       *
+       * @tparam Op - operation, e.g. std::plus
+       */
+      template<template<typename> class Op, typename L, typename R>
+      class tensor_binary_expression : public tensor_expression<tensor_binary_expression<Op, L, R> > {
+      public:
+        typedef typename tensor_promote<typename L::value_type, typename R::value_type>::type value_type;
+        static constexpr size_t dim = L::dim;
+
+        tensor_binary_expression(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+          static_assert(L::dim == R::dim, "Tensors should have the same dimension.");
+          if (lhs.shape() != rhs.shape()) {
+            throw std::invalid_argument("Can not combine tensors. Shapes missmatch.");
+          }
+        }
+
+        const std::array<size_t, L::dim> &shape() const { return lhs_.shape(); }
+        size_t size() const { return lhs_.size(); }
+        value_type operator[](size_t i) const { return Op<value_type>()(value_type(lhs_[i]), value_type(rhs_[i])); }
+
+      private:
+        L lhs_;
+        R rhs_;
+      };
+
+      /**
+       * Element-wise operation on an expression and a scalar
+       */
+      template<template<typename> class Op, typename E, typename S>
+      class tensor_scalar_expression : public tensor_expression<tensor_scalar_expression<Op, E, S> > {
+      public:
+        typedef typename tensor_promote<typename E::value_type, S>::type value_type;
+        static constexpr size_t dim = E::dim;
+
+        tensor_scalar_expression(const E &expr, value_type scalar) : expr_(expr), scalar_(scalar) {}
+
+        const std::array<size_t, E::dim> &shape() const { return expr_.shape(); }
+        size_t size() const { return expr_.size(); }
+        value_type operator[](size_t i) const { return Op<value_type>()(value_type(expr_[i]), scalar_); }
+
+      private:
+        E expr_;
+        value_type scalar_;
+      };
+
+      /**
+       * Operand of tensor arithmetics: tensors enter expressions by reference, expressions by value
+       */
+      template<typename X, typename = void>
+      struct tensor_operand {
+        static constexpr bool value = false;
+      };
+
+      template<typename T, size_t Dim, typename C>
+      struct tensor_operand<tensor_base<T, Dim, C>, void> {
+        static constexpr bool value = true;
+        typedef tensor_ref_expression<T, Dim> type;
+        static type get(const tensor_base<T, Dim, C> &t) { return type(t); }
+      };
+
+      template<typename E>
+      struct tensor_operand<E, typename std::enable_if<std::is_base_of<tensor_expression<E>, E>::value>::type> {
+        static constexpr bool value = true;
+        typedef E type;
+        static const E &get(const E &e) { return e; }
+      };
+
+      /// Scalars which tensors can be scaled by
+      template<typename S>
+      struct is_tensor_scalar : std::integral_constant<bool, std::is_arithmetic<S>::value || alps::is_complex<S>::value> {};
+
+      /// Sum of two tensors or expressions
+      template<typename L, typename R>
+      typename std::enable_if<tensor_operand<L>::value && tensor_operand<R>::value,
+        tensor_binary_expression<std::plus, typename tensor_operand<L>::type, typename tensor_operand<R>::type> >::type
+      operator+(const L &lhs, const R &rhs) {
+        return tensor_binary_expression<std::plus, typename tensor_operand<L>::type, typename tensor_operand<R>::type>(
+          tensor_operand<L>::get(lhs), tensor_operand<R>::get(rhs));
+      }
+
+      /// Difference of two tensors or expressions
+      template<typename L, typename R>
+      typename std::enable_if<tensor_operand<L>::value && tensor_operand<R>::value,
+        tensor_binary_expression<std::minus, typename tensor_operand<L>::type, typename tensor_operand<R>::type> >::type
+      operator-(const L &lhs, const R &rhs) {
+        return tensor_binary_expression<std::minus, typename tensor_operand<L>::type, typename tensor_operand<R>::type>(
+          tensor_operand<L>::get(lhs), tensor_operand<R>::get(rhs));
+      }
+
+      /// Element-wise product of two tensors or expressions
+      template<typename L, typename R>
+      typename std::enable_if<tensor_operand<L>::value && tensor_operand<R>::value,
+        tensor_binary_expression<std::multiplies, typename tensor_operand<L>::type, typename tensor_operand<R>::type> >::type
+      operator*(const L &lhs, const R &rhs) {
+        return tensor_binary_expression<std::multiplies, typename tensor_operand<L>::type, typename tensor_operand<R>::type>(
+          tensor_operand<L>::get(lhs), tensor_operand<R>::get(rhs));
+      }
+
+      /// Multiplication of a tensor or expression by scalar
+      template<typename E, typename S>
+      typename std::enable_if<tensor_operand<E>::value && is_tensor_scalar<S>::value,
+        tensor_scalar_expression<std::multiplies, typename tensor_operand<E>::type, S> >::type
+      operator*(const E &expr, S scalar) {
+        typedef tensor_scalar_expression<std::multiplies, typename tensor_operand<E>::type, S> result_type;
+        return result_type(tensor_operand<E>::get(expr), typename result_type::value_type(scalar));
+      }
+
+      /// Division of a tensor or expression by scalar, performed as multiplication by the inverse
+      template<typename E, typename S>
+      typename std::enable_if<tensor_operand<E>::value && is_tensor_scalar<S>::value,
+        tensor_scalar_expression<std::multiplies, typename tensor_operand<E>::type, S> >::type
+      operator/(const E &expr, S scalar) {
+        typedef tensor_scalar_expression<std::multiplies, typename tensor_operand<E>::type, S> result_type;
+        typedef typename result_type::value_type value_type;
+        return result_type(tensor_operand<E>::get(expr), value_type(1.0) / value_type(scalar));
+      }
+
+      /// Negation of a tensor or expression
+      template<typename E>
+      typename std::enable_if<tensor_operand<E>::value,
+        tensor_scalar_expression<std::multiplies, typename tensor_operand<E>::type, typename tensor_operand<E>::type::value_type> >::type
+      operator-(const E &expr) {
+        typedef typename tensor_operand<E>::type::value_type value_type;
+        return tensor_scalar_expression<std::multiplies, typename tensor_operand<E>::type, value_type>(
+          tensor_operand<E>::get(expr), value_type(-1.0));
+      }
+    }
+  }
+}
+
+#endif //ALPSCORE_GF_TENSOR_EXPRESSION_H
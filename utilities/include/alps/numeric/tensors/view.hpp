@@ -36,7 +36,8 @@ namespace alps {
         /**
          * Construct view on DataStorage object
          */
-        view(data_storage<T>&storage) : data_(storage.data()), size_(storage.size())  {}
+        template<typename C>
+        view(data_storage<T, C>&storage) : data_(storage.data()), size_(storage.size())  {}
         /// Copy constructor
         view(const view & view) : data_(view.data_), size_(view.size_) {}
         /// Move constructor
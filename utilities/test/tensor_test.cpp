@@ -275,7 +275,7 @@ TEST(TensorTest, TestMultByScalar) {
       ASSERT_DOUBLE_EQ(value*10, XX(i, j));
     }
   }
-  auto Z = XX * X;
+  tensor<double, 2> Z = XX * X;
   for (size_t i = 0; i < XX.shape()[0]; ++i) {
     for (size_t j = 0; j < XX.shape()[1]; ++j) {
       ASSERT_DOUBLE_EQ(Z(i, j), X(i, j) * XX(i, j));
@@ -375,7 +375,7 @@ TEST(TensorTest, BasicArithmetics) {
     }
   }
   auto M3 = M1 + M2;
-  auto Y = X + Z;
+  tensor<double, 2> Y = X + Z;
   for(size_t i = 0; i< N; ++i){
     for (size_t j = 0; j < N; ++j) {
       ASSERT_DOUBLE_EQ(Y(i, j), M3(i, j));
@@ -433,7 +433,7 @@ TEST(TensorTest, DoubleScaleByComplex) {
     }
   }
   auto M2 = M1 * x;
-  auto Y = X * x;
+  tensor<std::complex<double>, 2> Y = X * x;
   for(size_t i = 0; i< N; ++i){
     for (size_t j = 0; j < N; ++j) {
       ASSERT_DOUBLE_EQ(Y(i, j).real(), M2(i, j).real());
@@ -464,7 +464,7 @@ TEST(TensorTest, DoubleScaleByComplexView) {
       }
     }
     auto M3 = M1 * x;
-    auto Y = X * x;
+    tensor<std::complex<double>, 2> Y = X * x;
     for (size_t i = 0; i < N; ++i) {
       for (size_t j = 0; j < N; ++j) {
         ASSERT_DOUBLE_EQ(Y(i, j).real(), M3(i, j).real());
@@ -487,7 +487,7 @@ TEST(TensorTest, DoublePlusComplex) {
     }
   }
   auto M3 = M1 + M2;
-  auto Y = Z + X;
+  tensor<std::complex<double>, 2> Y = Z + X;
   for(size_t i = 0; i< N; ++i){
     for (size_t j = 0; j < N; ++j) {
       ASSERT_NEAR(Y(i, j).real(), M3(i, j).real(), 1e-12);
@@ -697,3 +697,72 @@ TEST(TensorTest, TestTensorMult) {
     }
   }
 }
+
+TEST(TensorTest, TestExpressions) {
+  size_t N = 4;
+  tensor<double, 3> c1(N, N, N);
+  tensor<double, 3> c2(N, N, N);
+  tensor<std::complex<double>, 3> g(N, N, N);
+  for(size_t i = 0; i < c1.size(); ++i) {
+    c1.data()[i] = 0.5 * i;
+    c2.data()[i] = 1.0 - i;
+    g.data()[i] = std::complex<double>(i, -2.0 * i);
+  }
+  std::complex<double> iwn(0., 1.5);
+
+  // evaluate into a new tensor
+  tensor<std::complex<double>, 3> f = c1/iwn + c2/(iwn*iwn) - (-c1 * 2.0);
+  for(size_t i = 0; i < f.size(); ++i) {
+    std::complex<double> ref = c1.data()[i] * (1.0/iwn) + c2.data()[i] * (1.0/(iwn*iwn)) + c1.data()[i] * 2.0;
+    ASSERT_NEAR(std::abs(ref - f.data()[i]), 0.0, 1e-12);
+  }
+
+  // evaluate in place into a view, where the target appears in the expression
+  tensor_view<std::complex<double>, 2> v = g(1);
+  tensor<std::complex<double>, 2> v0 = v;
+  v = v * c1(1) - c2(2) / 2.0;
+  for(size_t i = 0; i < N; ++i) {
+    for(size_t j = 0; j < N; ++j) {
+      ASSERT_NEAR(std::abs(v0(i, j) * c1(1, i, j) - c2(2, i, j) * 0.5 - g(1, i, j)), 0.0, 1e-12);
+    }
+  }
+  g(2) -= c1(2) * iwn;
+  ASSERT_NEAR(std::abs(g(2, 1, 1) - std::complex<double>(c1.index(2, 1, 1), -2.0 * c1.index(2, 1, 1)) + c1(2, 1, 1) * iwn), 0.0, 1e-12);
+
+  tensor<double, 2> w(N, N + 1);
+  ASSERT_THROW(c1(0) + w, std::invalid_argument);
+  ASSERT_THROW(v = w * 2.0, std::invalid_argument);
+}
+
+TEST(TensorTest, TestAllocators) {
+  size_t N = 10;
+  aligned_tensor<double, 2> a(N, N);
+  tensor<double, 2, alps::numerics::pool_allocator<double> > b(N, N);
+  tensor<double, 2> c(N, N);
+  ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.data()) % 64);
+  ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(b.data()) % 64);
+  ASSERT_EQ(int(Eigen::Aligned64), int(aligned_tensor<double, 2>::map_alignment));
+
+  Eigen::MatrixXd ref = Eigen::MatrixXd::Random(N, N);
+  a.matrix() = ref;
+  c = a;
+  b = a + c;
+  a += c;
+  a -= b;
+  a *= 2.0;
+  ASSERT_NEAR((b.matrix() - 2 * ref).norm(), 0.0, 1e-12);
+  ASSERT_NEAR(a.matrix().norm(), 0.0, 1e-12);
+
+  // views of tensors with different allocators
+  tensor_view<double, 1> v = b(1);
+  ASSERT_DOUBLE_EQ(v(2), 2 * ref(1, 2));
+
+  // blocks of the pool are reused
+  const double *data = b.data();
+  {
+    tensor<double, 2, alps::numerics::pool_allocator<double> > tmp(N, N + 1);
+  }
+  b = tensor<double, 2, alps::numerics::pool_allocator<double> >(N, N + 1);
+  tensor<double, 2, alps::numerics::pool_allocator<double> > d(N, N);
+  ASSERT_EQ(data, d.data());
+}